@@ -147,6 +147,23 @@ bool AssignFilter::processOne(PointRef& point)
 }
 
 
+// Apply one assignment at a time to the whole batch.
+void AssignFilter::processBatch(StreamPointTable& table, point_count_t count,
+    SkipMask& skips)
+{
+    PointRef point(table, 0);
+    for (AssignRange& r : m_assignments)
+        for (PointId idx = 0; idx < count; idx++)
+        {
+            if (skips.skipped(idx))
+                continue;
+            point.setPointId(idx);
+            if (r.valuePasses(point.getFieldAs<double>(r.m_id)))
+                point.setField(r.m_id, r.m_value);
+        }
+}
+
+
 void AssignFilter::filter(PointView& view)
 {
     PointRef point(view, 0);
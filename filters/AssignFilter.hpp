@@ -59,6 +59,8 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, point_count_t count,
+        SkipMask& skips);
     virtual void filter(PointView& view);
 
     AssignFilter& operator=(const AssignFilter&) = delete;
@@ -60,9 +60,15 @@ This procedure is then recursively applied to the created blocks until
 they contains only one or two partitions.  In the case of one or two
 partitions we are done, and we simply store away the contents of the
 blocks.
+
+The arrays are sorted with a stable radix sort.  Blocks below the top few
+levels of the recursion touch disjoint parts of the arrays, so they are
+split on separate threads.  Once all blocks are done, the output views are
+created in the order the blocks appear in the partitions.
 **/
 
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/RadixSort.hpp>
 
 namespace pdal
 {
@@ -80,6 +86,7 @@ void ChipperFilter::addArgs(ProgramArgs& args)
 {
     args.add("capacity", "Maximum number of points per cell", m_threshold,
         (PointId) 5000u);
+    addThreadsArg(args, "Number of threads used to sort and split points");
 }
 
 
@@ -88,10 +95,51 @@ PointViewSet ChipperFilter::run(PointViewPtr view)
     if (view->size() == 0)
         return m_outViews;
 
+    const size_t threadCount = numThreads();
+
     m_inView = view;
     load(*view.get(), m_xvec, m_yvec, m_spare);
     partition(m_xvec.size());
+    m_chips.resize(m_partitions.size() - 1);
+
+    // Blocks of at most m_taskSize partitions are split by a task of
+    // their own.
+    if (threadCount > 1)
+    {
+        m_pool.reset(new ThreadPool(threadCount));
+        m_taskSize = (std::max)((size_t)2,
+            m_chips.size() / (threadCount * 8));
+    }
     decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1);
+    if (m_pool)
+        m_pool->await();
+
+    std::vector<PointViewPtr> views;
+    for (size_t i = 0; i < m_chips.size(); ++i)
+    {
+        PointViewPtr v = m_inView->makeNew();
+        views.push_back(v);
+        m_outViews.insert(v);
+    }
+
+    auto fill = [this, &views](size_t i)
+    {
+        const Chip& c = m_chips[i];
+        PointView& v = *views[i];
+        for (PointId idx = c.m_begin; idx <= c.m_end; ++idx)
+            v.appendPoint(*m_inView, (*c.m_list)[idx].m_ptindex);
+    };
+    for (size_t i = 0; i < m_chips.size(); ++i)
+    {
+        if (m_pool)
+            m_pool->add([&fill, i](){ fill(i); });
+        else
+            fill(i);
+    }
+    if (m_pool)
+        m_pool->join();
+    m_pool.reset();
+
     return m_outViews;
 }
 
@@ -121,8 +169,12 @@ void ChipperFilter::load(PointView& view, ChipRefList& xvec, ChipRefList& yvec,
         yvec.push_back(yref);
     }
 
+    const size_t threadCount = numThreads();
+    auto posKey = [](const ChipPtRef& ref)
+        { return Utils::radixKey(ref.m_pos); };
+
     // Sort xvec and assign other index in yvec to sorted indices in xvec.
-    std::stable_sort(xvec.begin(), xvec.end());
+    Utils::radixSort(xvec.m_vec, posKey, threadCount);
     for (size_t i = 0; i < xvec.size(); ++i)
     {
         idx = xvec[i].m_ptindex;
@@ -130,7 +182,7 @@ void ChipperFilter::load(PointView& view, ChipRefList& xvec, ChipRefList& yvec,
     }
 
     // Sort yvec.
-    std::stable_sort(yvec.begin(), yvec.end());
+    Utils::radixSort(yvec.m_vec, posKey, threadCount);
 
     // Iterate through the yvector, setting the xvector appropriately.
     for (size_t i = 0; i < yvec.size(); ++i)
@@ -215,13 +267,15 @@ void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow, ChipRefList& s
     // 2) We have a distance of three between left and right.
 
     if (pright - pleft == 1)
-        emit(wide, left, right);
+        emit(wide, pleft, left, right);
     else if (pright - pleft == 2) {
         center = m_partitions[pright - 1];
         emit(wide,
+             pleft,
              left,
              center - 1);
         emit(wide,
+             pleft + 1,
              center,
              right);
     } else {
@@ -250,18 +304,33 @@ void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow, ChipRefList& s
             }
         }
 
-        decideSplit(wide, spare, narrow, pleft, pcenter);
-        decideSplit(wide, spare, narrow, pcenter, pright);
+        // The two halves don't share any part of the arrays.  Once a half
+        // is small enough, it's finished by a task of its own.
+        ChipRefList *w = &wide;
+        ChipRefList *s = &spare;
+        ChipRefList *n = &narrow;
+        auto splitHalf = [this, w, s, n, pleft, pright](PointId l, PointId r)
+        {
+            if (m_pool && pright - pleft > m_taskSize && r - l <= m_taskSize)
+                m_pool->add([this, w, s, n, l, r]()
+                    { decideSplit(*w, *s, *n, l, r); });
+            else
+                decideSplit(*w, *s, *n, l, r);
+        };
+        splitHalf(pleft, pcenter);
+        splitHalf(pcenter, pright);
     }
 }
 
-void ChipperFilter::emit(ChipRefList& wide, PointId widemin, PointId widemax)
+// Record the points of the chip for a partition.  The views are created
+// once all chips are known.
+void ChipperFilter::emit(ChipRefList& wide, PointId partition,
+    PointId widemin, PointId widemax)
 {
-    PointViewPtr view = m_inView->makeNew();
-    for (size_t idx = widemin; idx <= widemax; ++idx)
-        view->appendPoint(*m_inView.get(), wide[idx].m_ptindex);
-
-    m_outViews.insert(view);
+    Chip& c = m_chips[partition];
+    c.m_list = &wide;
+    c.m_begin = widemin;
+    c.m_end = widemax;
 }
 
 } // namespace pdal
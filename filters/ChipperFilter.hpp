@@ -43,6 +43,9 @@
 
 #include <pdal/Filter.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <memory>
 #include <vector>
 
 extern "C" int32_t ChipperFilter_ExitFunc();
@@ -115,7 +118,8 @@ private:
 class PDAL_DLL ChipperFilter : public pdal::Filter
 {
 public:
-    ChipperFilter() {}
+    ChipperFilter() : m_taskSize(0)
+    {}
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
@@ -131,15 +135,27 @@ private:
         ChipRefList& spare, PointId left, PointId right);
     void split(ChipRefList& wide, ChipRefList& narrow,
         ChipRefList& spare, PointId left, PointId right);
-    void emit(ChipRefList& wide, PointId widemin, PointId widemax);
+    void emit(ChipRefList& wide, PointId partition, PointId widemin,
+        PointId widemax);
+
+    // Points of a chip: a range of a reference list.
+    struct Chip
+    {
+        ChipRefList *m_list;
+        PointId m_begin;
+        PointId m_end;
+    };
 
     PointId m_threshold;
     PointViewPtr m_inView;
     PointViewSet m_outViews;
     std::vector<PointId> m_partitions;
+    std::vector<Chip> m_chips;
     ChipRefList m_xvec;
     ChipRefList m_yvec;
     ChipRefList m_spare;
+    std::unique_ptr<ThreadPool> m_pool;
+    PointId m_taskSize;
 
     ChipperFilter& operator=(const ChipperFilter&); // not implemented
     ChipperFilter(const ChipperFilter&); // not implemented
@@ -59,6 +59,7 @@ void ClusterFilter::addArgs(ProgramArgs& args)
     args.add("max_points", "Max points per cluster", m_maxPoints,
         std::numeric_limits<uint64_t>::max());
     args.add("tolerance", "Radius", m_tolerance, 1.0);
+    addThreadsArg(args, "Number of threads used to find clusters");
 }
 
 void ClusterFilter::addDimensions(PointLayoutPtr layout)
@@ -70,7 +71,7 @@ void ClusterFilter::addDimensions(PointLayoutPtr layout)
 void ClusterFilter::filter(PointView& view)
 {
     auto clusters = Segmentation::extractClusters(view, m_minPoints,
-        m_maxPoints, m_tolerance);
+        m_maxPoints, m_tolerance, numThreads());
 
     uint64_t id = 1;
     for (auto const& c : clusters)
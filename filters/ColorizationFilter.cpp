@@ -181,38 +181,70 @@ void ColorizationFilter::ready(PointTableRef table)
             throwError(m_raster->errorMsg());
         }
     }
+
+    for (auto& b : m_bands)
+        if (b.m_band == 0 || b.m_band > (uint32_t)m_raster->bandCount())
+        {
+            std::ostringstream oss;
+            oss << "Band " << b.m_band << " requested for dimension '" <<
+                b.m_name << "' doesn't exist in raster '" <<
+                m_rasterFilename << "'.";
+            throwError(oss.str());
+        }
 }
 
 
 bool ColorizationFilter::processOne(PointRef& point)
 {
-    static std::vector<double> data;
-
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
 
-    if (m_raster->read(x, y, data) == gdal::GDALError::None)
-    {
-        int i(0);
-        for (auto bi = m_bands.begin(); bi != m_bands.end(); ++bi)
-        {
-            BandInfo& b = *bi;
-            point.setField(b.m_dim, data[i] * b.m_scale);
-            ++i;
-        }
-        return true;
-    }
-    return false;
+    // Points outside the raster are filtered out.  Other errors, such as
+    // a block that can't be read, are thrown as they are by filter().
+    gdal::GDALError error = m_raster->read(x, y, m_data);
+    if (error == gdal::GDALError::NoData)
+        return false;
+    if (error != gdal::GDALError::None)
+        throwError(m_raster->errorMsg());
+
+    for (auto& b : m_bands)
+        point.setField(b.m_dim, m_data[b.m_band - 1] * b.m_scale);
+    return true;
 }
 
 
+// Read raster values for batches of points to avoid the per-point
+// overhead of the single-point read.
 void ColorizationFilter::filter(PointView& view)
 {
-    PointRef point = view.point(0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    const PointId BatchSize = 4096;
+    const size_t numBands = m_raster->bandCount();
+
+    for (PointId begin = 0; begin < view.size(); begin += BatchSize)
     {
-        point.setPointId(idx);
-        processOne(point);
+        PointId end = (std::min)(begin + BatchSize, view.size());
+
+        m_xs.clear();
+        m_ys.clear();
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            m_xs.push_back(view.getFieldAs<double>(Dimension::Id::X, idx));
+            m_ys.push_back(view.getFieldAs<double>(Dimension::Id::Y, idx));
+        }
+
+        if (m_raster->read(m_xs, m_ys, m_data, m_valid) !=
+            gdal::GDALError::None)
+            throwError(m_raster->errorMsg());
+
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            size_t i = idx - begin;
+            if (!m_valid[i])
+                continue;
+            const double *data = m_data.data() + i * numBands;
+            for (auto& b : m_bands)
+                view.setField(b.m_dim, idx, data[b.m_band - 1] * b.m_scale);
+        }
     }
 }
 
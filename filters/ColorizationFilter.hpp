@@ -94,6 +94,10 @@ private:
     std::vector<BandInfo> m_bands;
 
     std::unique_ptr<gdal::Raster> m_raster;
+    std::vector<double> m_xs;
+    std::vector<double> m_ys;
+    std::vector<double> m_data;
+    std::vector<bool> m_valid;
 };
 
 } // namespace pdal
@@ -39,10 +39,12 @@
 #include <pdal/StageFactory.hpp>
 #include <pdal/Polygon.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "private/Point.hpp"
 #include "private/pnp/GridPnp.hpp"
 
+#include <algorithm>
 #include <sstream>
 #include <cstdarg>
 
@@ -60,9 +62,27 @@ CropFilter::ViewGeom::ViewGeom(const Polygon& poly) : m_poly(poly)
 {}
 
 CropFilter::ViewGeom::ViewGeom(ViewGeom&& vg) :
-    m_poly(std::move(vg.m_poly)), m_gridPnps(std::move(vg.m_gridPnps))
+    m_poly(std::move(vg.m_poly))
 {}
 
+CropFilter::GeomPart::GeomPart(size_t geom, const GridPnp::Ring& outer,
+        const std::vector<GridPnp::Ring>& inners) :
+    m_geom(geom), m_outer(outer), m_inners(inners)
+{}
+
+GridPnp& CropFilter::GeomPart::gridPnp()
+{
+    // Compute all the grid cells before the engine is shared, since
+    // computing a cell isn't thread-safe.
+    std::call_once(m_once, [this]()
+    {
+        std::unique_ptr<GridPnp> gridPnp(new GridPnp(m_outer, m_inners));
+        gridPnp->prepare();
+        m_gridPnp = std::move(gridPnp);
+    });
+    return *m_gridPnp;
+}
+
 std::string CropFilter::getName() const { return s_info.name; }
 
 CropFilter::CropFilter() : m_cropOutside(false)
@@ -86,6 +106,7 @@ void CropFilter::addArgs(ProgramArgs& args)
     args.add("polygon", "Bounding polying for cropped points", m_polys).
         setErrorText("Invalid polygon specification.  "
             "Must be valid GeoJSON/WKT");
+    addThreadsArg(args, "Number of threads used to crop by polygons");
 }
 
 
@@ -129,10 +150,8 @@ void CropFilter::ready(PointTableRef table)
 
 bool CropFilter::processOne(PointRef& point)
 {
-    for (auto& g : m_geoms)
-        for (auto& gridPnp : g.m_gridPnps)
-            if (!crop(point, *gridPnp))
-                return false;
+    if (m_geoms.size() && !crop(point, m_hits))
+        return false;
 
     for (auto& box : m_boxes)
         if (!crop(point, box))
@@ -146,6 +165,45 @@ bool CropFilter::processOne(PointRef& point)
 }
 
 
+// Test the batch against one kind of geometry at a time.  Points cropped
+// by one geometry aren't tested against the rest.
+void CropFilter::processBatch(StreamPointTable& table, point_count_t count,
+    SkipMask& skips)
+{
+    PointRef point(table, 0);
+
+    if (m_geoms.size())
+        for (PointId idx = 0; idx < count; idx++)
+        {
+            if (skips.skipped(idx))
+                continue;
+            point.setPointId(idx);
+            if (!crop(point, m_hits))
+                skips.skip(idx);
+        }
+
+    for (auto& box : m_boxes)
+        for (PointId idx = 0; idx < count; idx++)
+        {
+            if (skips.skipped(idx))
+                continue;
+            point.setPointId(idx);
+            if (!crop(point, box))
+                skips.skip(idx);
+        }
+
+    for (auto& center: m_centers)
+        for (PointId idx = 0; idx < count; idx++)
+        {
+            if (skips.skipped(idx))
+                continue;
+            point.setPointId(idx);
+            if (!crop(point, center))
+                skips.skip(idx);
+        }
+}
+
+
 void CropFilter::spatialReferenceChanged(const SpatialReference& srs)
 {
     transform(srs);
@@ -154,8 +212,11 @@ void CropFilter::spatialReferenceChanged(const SpatialReference& srs)
 
 void CropFilter::transform(const SpatialReference& srs)
 {
-    for (auto& geom : m_geoms)
+    m_parts.clear();
+    std::vector<EnvelopeTree::Box> envelopes;
+    for (size_t i = 0; i < m_geoms.size(); ++i)
     {
+        ViewGeom& geom = m_geoms[i];
         try
         {
             geom.m_poly = geom.m_poly.transform(srs);
@@ -164,15 +225,19 @@ void CropFilter::transform(const SpatialReference& srs)
         {
             throwError(err.what());
         }
-        geom.m_gridPnps.clear();
         std::vector<Polygon> polys = geom.m_poly.polygons();
         for (auto& p : polys)
         {
-            std::unique_ptr<GridPnp> gridPnp(new GridPnp(
+            std::unique_ptr<GeomPart> part(new GeomPart(i,
                 p.exteriorRing(), p.interiorRings()));
-            geom.m_gridPnps.push_back(std::move(gridPnp));
+            EnvelopeTree::Box envelope;
+            for (auto& pt : part->m_outer)
+                envelope.grow(pt.first, pt.second);
+            envelopes.push_back(envelope);
+            m_parts.push_back(std::move(part));
         }
     }
+    m_partTree.build(envelopes);
 
     // If we don't have any SRS, do nothing.
     if (srs.empty() && m_assignedSrs.empty())
@@ -203,12 +268,15 @@ PointViewSet CropFilter::run(PointViewPtr view)
     PointViewSet viewSet;
 
     transform(view->spatialReference());
-    for (auto& geom : m_geoms)
+    std::vector<PointViewPtr> geomViews;
+    for (size_t i = 0; i < m_geoms.size(); ++i)
     {
         PointViewPtr outView = view->makeNew();
-        crop(geom, *view, *outView);
+        geomViews.push_back(outView);
         viewSet.insert(outView);
     }
+    if (geomViews.size())
+        crop(*view, geomViews);
 
     for (auto& box : m_boxes)
     {
@@ -250,25 +318,106 @@ void CropFilter::crop(const BOX2D& box, PointView& input, PointView& output)
 }
 
 
-bool CropFilter::crop(const PointRef& point, GridPnp& g)
+// Find the geometries that contain a point, in order.  A point is inside
+// a geometry if it's inside any of its polygons.
+void CropFilter::geomsContaining(double x, double y,
+    std::vector<size_t>& geoms)
+{
+    geoms.clear();
+    m_partTree.query(x, y, [this, x, y, &geoms](size_t id)
+    {
+        GeomPart& part = *m_parts[id];
+        if (part.gridPnp().inside(x, y))
+            geoms.push_back(part.m_geom);
+    });
+    if (geoms.size() > 1)
+    {
+        std::sort(geoms.begin(), geoms.end());
+        geoms.erase(std::unique(geoms.begin(), geoms.end()), geoms.end());
+    }
+}
+
+
+bool CropFilter::crop(const PointRef& point, std::vector<size_t>& geoms)
 {
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
-    return (m_cropOutside != g.inside(x, y));
+    geomsContaining(x, y, geoms);
+
+    // Return true if every geometry keeps the point.
+    if (m_cropOutside)
+        return geoms.empty();
+    return geoms.size() == m_geoms.size();
 }
 
 
-void CropFilter::crop(const ViewGeom& g, PointView& input, PointView& output)
+// Crop by all of the geometries at once, appending the points kept by each
+// geometry to its output view.  Each point is only tested against the
+// polygons whose bounds contain it.  Blocks of points are tested
+// concurrently.
+void CropFilter::crop(PointView& input, std::vector<PointViewPtr>& outputs)
 {
-    PointRef point = input.point(0);
-    for (auto& gridPnp : g.m_gridPnps)
+    const point_count_t BlockSize = 4096;
+    const size_t numBlocks = (input.size() + BlockSize - 1) / BlockSize;
+
+    // The geometries containing each point of a block, as point/geometry
+    // pairs in point order.
+    using Hits = std::vector<std::pair<PointId, size_t>>;
+    std::vector<Hits> blockHits(numBlocks);
+
+    auto findHits = [this, &input, &blockHits](size_t block)
     {
-        for (PointId idx = 0; idx < input.size(); ++idx)
+        PointId begin = block * BlockSize;
+        PointId end = (std::min)(begin + BlockSize, input.size());
+        Hits& hits = blockHits[block];
+        std::vector<size_t> geoms;
+        for (PointId idx = begin; idx < end; ++idx)
         {
-            point.setPointId(idx);
-            if (crop(point, const_cast<GridPnp&>(*gridPnp)))
-                output.appendPoint(input, idx);
+            double x = input.getFieldAs<double>(Dimension::Id::X, idx);
+            double y = input.getFieldAs<double>(Dimension::Id::Y, idx);
+            geomsContaining(x, y, geoms);
+            for (size_t g : geoms)
+                hits.emplace_back(idx, g);
+        }
+    };
+
+    size_t threadCount = numThreads();
+    if (threadCount == 1 || numBlocks <= 1)
+    {
+        for (size_t block = 0; block < numBlocks; ++block)
+            findHits(block);
+    }
+    else
+    {
+        ThreadPool pool(threadCount);
+        for (size_t block = 0; block < numBlocks; ++block)
+            pool.add([&findHits, block](){ findHits(block); });
+        pool.join();
+    }
+
+    // Append the points in order so that the result doesn't depend on the
+    // number of threads.
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        const Hits& hits = blockHits[block];
+        if (!m_cropOutside)
+        {
+            for (auto& hit : hits)
+                outputs[hit.second]->appendPoint(input, hit.first);
+            continue;
         }
+
+        PointId begin = block * BlockSize;
+        PointId end = (std::min)(begin + BlockSize, input.size());
+        auto hi = hits.begin();
+        for (PointId idx = begin; idx < end; ++idx)
+            for (size_t g = 0; g < outputs.size(); ++g)
+            {
+                if (hi != hits.end() && hi->first == idx && hi->second == g)
+                    ++hi;
+                else
+                    outputs[g]->appendPoint(input, idx);
+            }
     }
 }
 
@@ -35,12 +35,16 @@
 #pragma once
 
 #include <list>
+#include <memory>
+#include <mutex>
 
 #include <pdal/Filter.hpp>
 #include <pdal/Polygon.hpp>
 #include <pdal/Streamable.hpp>
 
 #include "private/Point.hpp"
+#include "private/pnp/EnvelopeTree.hpp"
+#include "private/pnp/GridPnp.hpp"
 
 extern "C" int32_t CropFilter_ExitFunc();
 extern "C" PF_ExitFunc CropFilter_InitPlugin();
@@ -49,7 +53,6 @@ namespace pdal
 {
 
 class ProgramArgs;
-class GridPnp;
 
 // removes any points outside of the given range
 // updates the header accordingly
@@ -63,16 +66,34 @@ public:
     std::string getName() const;
 
 private:
-    // This is just a way to marry a (multi)polygon with a list of its
-    // GridPnp's that do the actual point-in-polygon operation.
+    // A (multi)polygon crop geometry.  Points are tested against its
+    // polygons, which are stored as GeomParts.
     struct ViewGeom
     {
         ViewGeom(const Polygon& poly);
         ViewGeom(ViewGeom&& vg);
 
         Polygon m_poly;
-        std::vector<std::unique_ptr<GridPnp>> m_gridPnps;
     };
+
+    // A single polygon of a crop geometry.  The point-in-polygon engine is
+    // created the first time a point falls within the polygon's bounds.
+    struct GeomPart
+    {
+        GeomPart(size_t geom, const GridPnp::Ring& outer,
+            const std::vector<GridPnp::Ring>& inners);
+
+        // Get the point-in-polygon engine.  Safe to call from multiple
+        // threads.
+        GridPnp& gridPnp();
+
+        size_t m_geom;
+        GridPnp::Ring m_outer;
+        std::vector<GridPnp::Ring> m_inners;
+        std::unique_ptr<GridPnp> m_gridPnp;
+        std::once_flag m_once;
+    };
+
     std::vector<Bounds> m_bounds;
     bool m_cropOutside;
     std::vector<Polygon> m_polys;
@@ -81,6 +102,9 @@ private:
     double m_distance2;
     std::vector<filter::Point> m_centers;
     std::vector<ViewGeom> m_geoms;
+    std::vector<std::unique_ptr<GeomPart>> m_parts;
+    EnvelopeTree m_partTree;
+    std::vector<size_t> m_hits;
     std::vector<BOX2D> m_boxes;
 
     void addArgs(ProgramArgs& args);
@@ -89,11 +113,14 @@ private:
     virtual void ready(PointTableRef table);
     virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, point_count_t count,
+        SkipMask& skips);
     virtual PointViewSet run(PointViewPtr view);
     bool crop(const PointRef& point, const BOX2D& box);
     void crop(const BOX2D& box, PointView& input, PointView& output);
-    bool crop(const PointRef& point, GridPnp& g);
-    void crop(const ViewGeom& g, PointView& input, PointView& output);
+    void geomsContaining(double x, double y, std::vector<size_t>& geoms);
+    bool crop(const PointRef& point, std::vector<size_t>& geoms);
+    void crop(PointView& input, std::vector<PointViewPtr>& outputs);
     bool crop(const PointRef& point, const filter::Point& center);
     void crop(const filter::Point& center, PointView& input,
         PointView& output);
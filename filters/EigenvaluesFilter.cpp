@@ -75,13 +75,11 @@ void EigenvaluesFilter::filter(PointView& view)
 {
     using namespace Eigen;
 
-    KD3Index kdi(view);
-    kdi.build();
-
+    // find the k-nearest neighbors
+    NeighborTablePtr neighbors = view.knnTable(m_knn, numThreads());
     for (PointId i = 0; i < view.size(); ++i)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_knn);
+        auto ids = neighbors->neighbors(i);
 
         // compute covariance of the neighborhood
         auto B = eigen::computeCovariance(view, ids);
@@ -69,6 +69,8 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
     virtual void filter(PointView& view);
+    virtual bool parallelRunnable() const
+        { return true; }
 };
 
 } // namespace pdal
@@ -70,13 +70,11 @@ void EstimateRankFilter::addDimensions(PointLayoutPtr layout)
 
 void EstimateRankFilter::filter(PointView& view)
 {
-    KD3Index kdi(view);
-    kdi.build();
-
+    // find the k-nearest neighbors
+    NeighborTablePtr neighbors = view.knnTable(m_knn, numThreads());
     for (PointId i = 0; i < view.size(); ++i)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_knn);
+        auto ids = neighbors->neighbors(i);
 
         view.setField(m_rank, i, eigen::computeRank(view, ids, m_thresh));
     }
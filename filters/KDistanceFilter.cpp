@@ -68,11 +68,6 @@ void KDistanceFilter::filter(PointView& view)
 {
     using namespace Dimension;
 
-    // Build the 3D KD-tree.
-    log()->get(LogLevel::Debug) << "Building 3D KD-tree...\n";
-    KD3Index index(view);
-    index.build();
-
     // Increment the minimum number of points, as knnSearch will be returning
     // the neighbors along with the query point.
     m_k++;
@@ -80,12 +75,12 @@ void KDistanceFilter::filter(PointView& view)
     // Compute the k-distance for each point. The k-distance is the Euclidean
     // distance to k-th nearest neighbor.
     log()->get(LogLevel::Debug) << "Computing k-distances...\n";
+    NeighborTablePtr neighbors = view.knnTable(m_k, numThreads());
     for (PointId i = 0; i < view.size(); ++i)
     {
-        std::vector<PointId> indices(m_k);
-        std::vector<double> sqr_dists(m_k);
-        index.knnSearch(i, m_k, &indices, &sqr_dists);
-        view.setField(m_kdist, i, std::sqrt(sqr_dists[m_k-1]));
+        const double *sqr_dists = neighbors->sqrDists(i);
+        view.setField(m_kdist, i,
+            std::sqrt(sqr_dists[neighbors->count(i) - 1]));
     }
 }
 
@@ -70,24 +70,22 @@ void LOFFilter::filter(PointView& view)
 {
     using namespace Dimension;
 
-    // Build the 3D KD-tree.
-    KD3Index index(view);
-    log()->get(LogLevel::Debug) << "Building 3D KD-tree...\n";
-    index.build();
-
     // Increment the minimum number of points, as knnSearch will be returning
     // the neighbors along with the query point.
     m_minpts++;
 
+    // The neighbors are used by all three passes, so find them once.
+    log()->get(LogLevel::Debug) << "Finding neighbors...\n";
+    NeighborTablePtr neighbors = view.knnTable(m_minpts, numThreads());
+
     // First pass: Compute the k-distance for each point.
     // The k-distance is the Euclidean distance to k-th nearest neighbor.
     log()->get(LogLevel::Debug) << "Computing k-distances...\n";
     for (PointId i = 0; i < view.size(); ++i)
     {
-        std::vector<PointId> indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
-        view.setField(m_kdist, i, std::sqrt(sqr_dists[m_minpts-1]));
+        const double *sqr_dists = neighbors->sqrDists(i);
+        view.setField(m_kdist, i,
+            std::sqrt(sqr_dists[neighbors->count(i) - 1]));
     }
 
     // Second pass: Compute the local reachability distance for each point.
@@ -98,12 +96,11 @@ void LOFFilter::filter(PointView& view)
     log()->get(LogLevel::Debug) << "Computing lrd...\n";
     for (PointId i = 0; i < view.size(); ++i)
     {
-        std::vector<PointId> indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
+        const PointId *indices = neighbors->ids(i);
+        const double *sqr_dists = neighbors->sqrDists(i);
         double M1 = 0.0;
         point_count_t n = 0;
-        for (PointId j = 0; j < indices.size(); ++j)
+        for (PointId j = 0; j < neighbors->count(i); ++j)
         {
             double k = view.getFieldAs<double>(m_kdist, indices[j]);
             double reachdist = std::max(k, std::sqrt(sqr_dists[j]));
@@ -118,14 +115,13 @@ void LOFFilter::filter(PointView& view)
     for (PointId i = 0; i < view.size(); ++i)
     {
         double lrdp = view.getFieldAs<double>(m_lrd, i);
-        std::vector<PointId> indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
+        const PointId *indices = neighbors->ids(i);
         double M1 = 0.0;
         point_count_t n = 0;
-        for (auto const& j : indices)
+        for (PointId j = 0; j < neighbors->count(i); ++j)
         {
-            M1 += (view.getFieldAs<double>(m_lrd, j) / lrdp - M1) / ++n;
+            M1 += (view.getFieldAs<double>(m_lrd, indices[j]) / lrdp - M1) /
+                ++n;
         }
         view.setField(m_lof, i, M1);
     }
@@ -64,6 +64,29 @@ void MongusFilter::addArgs(ProgramArgs& args)
     args.add("l", "Max level", m_l, 8);
     args.add("classify", "Apply classification labels?", m_classify, true);
     args.add("extract", "Extract ground returns?", m_extract);
+    args.add("spline", "Surface interpolation (tps or compact)", m_spline,
+        "tps");
+    args.add("support", "Support radius of the compact spline, in control "
+        "cells", m_support, 6.0);
+}
+
+void MongusFilter::initialize()
+{
+    if (m_spline != "tps" && m_spline != "compact")
+        throwError("Invalid spline '" + m_spline + "'.  Must be 'tps' or "
+            "'compact'.");
+    if (m_support <= 0.0)
+        throwError("Option 'support' must be positive.");
+}
+
+Eigen::MatrixXd MongusFilter::interpolate(Eigen::MatrixXd x,
+    Eigen::MatrixXd y, Eigen::MatrixXd z, Eigen::MatrixXd xx,
+    Eigen::MatrixXd yy, double spacing)
+{
+    if (m_spline == "compact")
+        return eigen::computeCompactSpline(x, y, z, xx, yy,
+            m_support * spacing, numThreads());
+    return eigen::computeSpline(x, y, z, xx, yy, numThreads());
 }
 
 void MongusFilter::addDimensions(PointLayoutPtr layout)
@@ -166,9 +189,9 @@ std::vector<PointId> MongusFilter::processGround(PointViewPtr view)
     // In our case, 2D structural elements of circular shape are employed and
     // sufficient accuracy is achieved by using a larger window size for opening
     // (W11) than for closing (W9).
-    MatrixXd mo = eigen::matrixOpen(cz, 11);
+    MatrixXd mo = eigen::matrixOpen(cz, 11, numThreads());
     writeControl(cx, cy, mo, "grid_open.laz");
-    MatrixXd mc = eigen::matrixClose(mo, 9);
+    MatrixXd mc = eigen::matrixClose(mo, 9, numThreads());
     writeControl(cx, cy, mc, "grid_close.laz");
 
     // ...in order to minimize the distortions caused by such filtering, the
@@ -217,8 +240,8 @@ std::vector<PointId> MongusFilter::processGround(PointViewPtr view)
         downsampleMin(&cx, &cy, &cz, &x_samp, &y_samp, &z_samp, cur_cell_size);
         // 4x4, 8x8, 16x16, 32x32, 64x64, 128x128, 256x256
 
-        MatrixXd surface = eigen::computeSpline(x_prev, y_prev, z_prev,
-            x_samp, y_samp);
+        MatrixXd surface = interpolate(x_prev, y_prev, z_prev,
+            x_samp, y_samp, 2 * cur_cell_size);
 
         // if (l == 3)
         // {
@@ -403,7 +426,8 @@ std::vector<PointId> MongusFilter::processGround(PointViewPtr view)
         z_prev = z_samp;
     }
 
-    MatrixXd surface = eigen::computeSpline(x_prev, y_prev, z_prev, cx, cy);
+    MatrixXd surface = interpolate(x_prev, y_prev, z_prev, cx, cy,
+        cur_cell_size);
 
     if (log()->getLevel() > LogLevel::Debug5)
     {
@@ -39,6 +39,7 @@
 #include <Eigen/Dense>
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 
 extern "C" int32_t MongusFilter_ExitFunc();
@@ -71,10 +72,16 @@ private:
     double m_cellSize;
     double m_k;
     int m_l;
+    std::string m_spline;
+    double m_support;
     BOX2D m_bounds;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    Eigen::MatrixXd interpolate(Eigen::MatrixXd x, Eigen::MatrixXd y,
+                                Eigen::MatrixXd z, Eigen::MatrixXd xx,
+                                Eigen::MatrixXd yy, double spacing);
     int getColIndex(double x, double cell_size);
     int getRowIndex(double y, double cell_size);
     void writeControl(Eigen::MatrixXd cx, Eigen::MatrixXd cy, Eigen::MatrixXd cz, std::string filename);
@@ -32,12 +32,19 @@
  * OF SUCH DAMAGE.
  ****************************************************************************/
 
+
 #include "MortonOrderFilter.hpp"
 
-#include <climits>
-#include <iostream>
-#include <limits>
-#include <map>
+#include <pdal/util/RadixSort.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
 namespace pdal
 {
@@ -55,170 +62,215 @@ std::string MortonOrderFilter::getName() const { return s_info.name; }
 void MortonOrderFilter::addArgs(ProgramArgs& args)
 {
     args.add("reverse", "Reverse Morton", m_reverse, false);
+    args.add("curve", "Space-filling curve used to order points: "
+        "'morton' or 'hilbert'", m_curve, "morton");
+    args.add("use_z", "Order points in three dimensions instead of in XY",
+        m_useZ, false);
+    addThreadsArg(args, "Number of threads used to compute codes and sort");
 }
 
-//This used to be a lambda, but the VS compiler exploded, I guess.
-typedef std::pair<double, double> Coord;
-namespace
-{
-bool less_msb(const int& x, const int& y)
+
+void MortonOrderFilter::initialize()
 {
-    return x < y && x < (x ^ y);
+    m_curve = Utils::tolower(m_curve);
+    if (m_curve != "morton" && m_curve != "hilbert")
+        throwError("Invalid 'curve' option '" + m_curve + "'.  Must be "
+            "'morton' or 'hilbert'.");
 }
 
-class CmpZOrder
+namespace
 {
-public:
-    bool operator()(const Coord& c1, const Coord& c2) const
-    {
-        int a[2] = {(int)(c1.first * INT_MAX), (int)(c1.second * INT_MAX)};
-        int b[2] = {(int)(c2.first * INT_MAX), (int)(c2.second * INT_MAX)};
 
-        int j = 0;
-        int x = 0;
+// Spread the bits of a value so that there is one zero bit between
+// each bit.
+inline uint64_t spread2(uint32_t v)
+{
+#if defined(__BMI2__)
+    return _pdep_u64(v, 0x5555555555555555ULL);
+#else
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffULL;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return x;
+#endif
+}
 
-        for (int k = 0; k < 2; k++)
-        {
-            int y = a[k] ^ b[k];
-            if (less_msb(x, y))
-            {
-                j = k;
-                x = y;
-            }
-        }
-        return (a[j] - b[j]) < 0;
-    };
-};
+// Spread the low 21 bits of a value so that there are two zero bits
+// between each bit.
+inline uint64_t spread3(uint32_t v)
+{
+#if defined(__BMI2__)
+    return _pdep_u64(v, 0x1249249249249249ULL);
+#else
+    uint64_t x = v & 0x1fffff;
+    x = (x | (x << 32)) & 0x001f00000000ffffULL;
+    x = (x | (x << 16)) & 0x001f0000ff0000ffULL;
+    x = (x | (x << 8)) & 0x100f00f00f00f00fULL;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ULL;
+    x = (x | (x << 2)) & 0x1249249249249249ULL;
+    return x;
+#endif
 }
 
-class ReverseZOrder
+// Interleave the bits of the coordinates of a cell into a Morton code.
+// Bits of the first coordinate are the most significant at each level.
+inline uint64_t mortonCode(const uint32_t *pos, int numDims)
 {
-public:
-    static uint32_t encode_morton(uint32_t x, uint32_t y)
-    {
-        return (part1_by1(y) << 1) + part1_by1(x);
-    }
+    if (numDims == 2)
+        return (spread2(pos[0]) << 1) | spread2(pos[1]);
+    return (spread3(pos[0]) << 2) | (spread3(pos[1]) << 1) | spread3(pos[2]);
+}
 
-    static uint32_t reverse_morton(uint32_t index)
-    {
-        index = ((index >> 1) & 0x55555555u) | ((index & 0x55555555u) << 1);
-        index = ((index >> 2) & 0x33333333u) | ((index & 0x33333333u) << 2);
-        index = ((index >> 4) & 0x0f0f0f0fu) | ((index & 0x0f0f0f0fu) << 4);
-        index = ((index >> 8) & 0x00ff00ffu) | ((index & 0x00ff00ffu) << 8);
-        index = ((index >> 16) & 0xffffu) | ((index & 0xffffu) << 16);
-        return index;
-    }
+// Convert the coordinates of a cell in place to the "transposed" Hilbert
+// index, whose bits, interleaved as for a Morton code, form the distance
+// of the cell along the Hilbert curve.  See John Skilling, "Programming
+// the Hilbert curve", AIP Conference Proceedings 707, 2004.
+void hilbertTranspose(uint32_t *pos, int numDims, int bits)
+{
+    const uint32_t m = 1U << (bits - 1);
 
-private:
-    static uint32_t part1_by1(uint32_t x)
+    // Inverse undo.
+    for (uint32_t q = m; q > 1; q >>= 1)
     {
-        x &= 0x0000ffff;
-        x = (x ^ (x <<  8)) & 0x00ff00ff;
-        x = (x ^ (x <<  4)) & 0x0f0f0f0f;
-        x = (x ^ (x <<  2)) & 0x33333333;
-        x = (x ^ (x <<  1)) & 0x55555555;
-        return x;
+        uint32_t p = q - 1;
+        for (int i = 0; i < numDims; ++i)
+        {
+            if (pos[i] & q)
+                pos[0] ^= p;
+            else
+            {
+                uint32_t t = (pos[0] ^ pos[i]) & p;
+                pos[0] ^= t;
+                pos[i] ^= t;
+            }
+        }
     }
 
-    static uint32_t part1_by2(uint32_t x)
-    {
-        x &= 0x000003ff;
-        x = (x ^ (x << 16)) & 0xff0000ff;
-        x = (x ^ (x <<  8)) & 0x0300f00f;
-        x = (x ^ (x <<  4)) & 0x030c30c3;
-        x = (x ^ (x <<  2)) & 0x09249249;
-        return x;
-    }
-};
+    // Gray encode.
+    for (int i = 1; i < numDims; ++i)
+        pos[i] ^= pos[i - 1];
+    uint32_t t = 0;
+    for (uint32_t q = m; q > 1; q >>= 1)
+        if (pos[numDims - 1] & q)
+            t ^= q - 1;
+    for (int i = 0; i < numDims; ++i)
+        pos[i] ^= t;
+}
 
-PointViewSet MortonOrderFilter::reverseMorton(PointViewPtr inView)
+// Reverse the bits of a code.
+inline uint64_t reverseBits(uint64_t v)
 {
-    const int32_t cell = sqrt(inView->size());
-
-    // compute range
-    BOX2D buffer_bounds;
-    inView->calculateBounds(buffer_bounds);
-    const double xrange = buffer_bounds.maxx - buffer_bounds.minx;
-    const double yrange = buffer_bounds.maxy - buffer_bounds.miny;
-
-    const double cell_width = xrange / cell;
-    const double cell_height = yrange / cell;
-
-    // compute reverse morton code for each point
-    std::multimap<uint32_t, PointId> codes;
-    for (PointId idx = 0; idx < inView->size(); idx++)
-    {
-        const double x = inView->getFieldAs<double>(Dimension::Id::X, idx);
-        const int32_t xpos = floor((x - buffer_bounds.minx) / cell_width);
-
-        const double y = inView->getFieldAs<double>(Dimension::Id::Y, idx);
-        const int32_t ypos = floor((y - buffer_bounds.miny) / cell_height);
-
-        const uint32_t code = ReverseZOrder::encode_morton(xpos, ypos);
-        const uint32_t reverse = ReverseZOrder::reverse_morton( code );
-
-        codes.insert( std::pair<uint32_t, PointId>(reverse, idx) );
-    }
+    const uint64_t masks[] = { 0x5555555555555555ULL, 0x3333333333333333ULL,
+        0x0f0f0f0f0f0f0f0fULL, 0x00ff00ff00ff00ffULL, 0x0000ffff0000ffffULL };
 
-    // a map is yet order by key so its naturally ordered by lod
-    std::multimap<uint32_t, PointId>::iterator it;
-    PointViewPtr outView = inView->makeNew();
-    for (it = codes.begin(); it != codes.end(); ++it)
+    int shift = 1;
+    for (uint64_t mask : masks)
     {
-        outView->appendPoint(*inView, it->second);
+        v = ((v >> shift) & mask) | ((v & mask) << shift);
+        shift *= 2;
     }
+    return (v >> 32) | (v << 32);
+}
 
-    // build output view
-    PointViewSet viewSet;
-    viewSet.insert(outView);
+} // unnamed namespace
 
-    return viewSet;
-}
 
-PointViewSet MortonOrderFilter::morton(PointViewPtr inView)
+PointViewSet MortonOrderFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
-    if (!inView->size())
-        return viewSet;
-    CmpZOrder compare;
-    std::multimap<Coord, PointId, CmpZOrder> sorted(compare);
+    viewSet.insert(inView);
 
-    BOX2D buffer_bounds;
-    inView->calculateBounds(buffer_bounds);
-    double xrange = buffer_bounds.maxx - buffer_bounds.minx;
-    double yrange = buffer_bounds.maxy - buffer_bounds.miny;
+    const point_count_t count = inView->size();
+    if (count < 2)
+        return viewSet;
 
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    using namespace Dimension;
+
+    const int numDims = m_useZ ? 3 : 2;
+    const int bits = m_useZ ? 21 : 32;
+    const Id dims[] = { Id::X, Id::Y, Id::Z };
+
+    BOX3D bounds;
+    inView->calculateBounds(bounds);
+    const double mins[] = { bounds.minx, bounds.miny, bounds.minz };
+    const double ranges[] = { bounds.maxx - bounds.minx,
+        bounds.maxy - bounds.miny, bounds.maxz - bounds.minz };
+    const uint32_t maxPos = (uint32_t)((1ULL << bits) - 1);
+    const bool hilbert = (m_curve == "hilbert");
+
+    // Points are normally placed in cells as fine as the code allows.  The
+    // reverse order uses a grid with about one point per cell, so that
+    // reading the code from its least significant bit spreads points
+    // evenly over the bounds.
+    double cellSize[3];
+    for (int d = 0; d < numDims; ++d)
     {
-        double xpos = (inView->getFieldAs<double>(Dimension::Id::X, idx) -
-            buffer_bounds.minx) / xrange;
-        double ypos = (inView->getFieldAs<double>(Dimension::Id::Y, idx) -
-            buffer_bounds.miny) / yrange;
-        Coord loc(xpos, ypos);
-        sorted.insert(std::make_pair(loc, idx));
+        if (m_reverse)
+        {
+            double cells = std::floor(m_useZ ?
+                std::cbrt((double)count) : std::sqrt((double)count));
+            cellSize[d] = ranges[d] / cells;
+        }
+        else
+            cellSize[d] = ranges[d] / maxPos;
     }
 
-    PointViewPtr outView = inView->makeNew();
-    std::multimap<Coord, PointId, CmpZOrder>::iterator pos;
-    for (pos = sorted.begin(); pos != sorted.end(); ++pos)
+    size_t threadCount = numThreads();
+
+    std::vector<uint64_t> codes(count);
+    auto encode = [&](PointId begin, PointId end)
     {
-        outView->appendPoint(*inView, pos->second);
-    }
-    viewSet.insert(outView);
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            uint32_t pos[3];
+            for (int d = 0; d < numDims; ++d)
+            {
+                double v = inView->getFieldAs<double>(dims[d], idx);
+                double p = cellSize[d] > 0 ?
+                    std::floor((v - mins[d]) / cellSize[d]) : 0;
+                // A NaN coordinate is placed in the first cell.
+                pos[d] = (p > 0) ?
+                    (uint32_t)(std::min)(p, (double)maxPos) : 0;
+            }
 
-    return viewSet;
-}
+            if (hilbert)
+                hilbertTranspose(pos, numDims, bits);
+            // The reverse order has always put Y bits before X bits.
+            else if (m_reverse && numDims == 2)
+                std::swap(pos[0], pos[1]);
+            uint64_t code = mortonCode(pos, numDims);
+            codes[idx] = m_reverse ? reverseBits(code) : code;
+        }
+    };
 
-PointViewSet MortonOrderFilter::run(PointViewPtr inView)
-{
-    if ( m_reverse )
-    {
-        return reverseMorton( inView );
-    }
+    const point_count_t MinChunk = 65536;
+    size_t numChunks = (std::min)((point_count_t)threadCount,
+        count / MinChunk);
+    if (numChunks <= 1)
+        encode(0, count);
     else
     {
-        return morton( inView );
+        ThreadPool pool(numChunks);
+        for (size_t c = 0; c < numChunks; ++c)
+        {
+            PointId begin = count * c / numChunks;
+            PointId end = count * (c + 1) / numChunks;
+            pool.add([&encode, begin, end](){ encode(begin, end); });
+        }
+        pool.join();
     }
+
+    std::vector<PointId> order(count);
+    for (PointId idx = 0; idx < count; ++idx)
+        order[idx] = idx;
+    Utils::radixSort(order, [&codes](PointId p){ return codes[p]; },
+        threadCount);
+    inView->reorder(order);
+
+    return viewSet;
 }
 
 } // pdal
@@ -97,12 +97,11 @@ void NormalFilter::prepared(PointTableRef table)
 
 void NormalFilter::filter(PointView& view)
 {
-    KD3Index& kdi = view.build3dIndex();
-
+    // find the k-nearest neighbors
+    NeighborTablePtr neighbors = view.knnTable(m_knn, numThreads());
     for (PointId i = 0; i < view.size(); ++i)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_knn);
+        auto ids = neighbors->neighbors(i);
 
         // compute covariance of the neighborhood
         auto B = eigen::computeCovariance(view, ids);
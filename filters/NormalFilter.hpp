@@ -77,6 +77,8 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void prepared(PointTableRef table);
     virtual void filter(PointView& view);
+    virtual bool parallelRunnable() const
+        { return true; }
 };
 
 } // namespace pdal
@@ -73,17 +73,15 @@ void OutlierFilter::addDimensions(PointLayoutPtr layout)
 
 Indices OutlierFilter::processRadius(PointViewPtr inView)
 {
-    KD3Index index(*inView);
-    index.build();
-
     point_count_t np = inView->size();
 
     std::vector<PointId> inliers, outliers;
 
+    NeighborTablePtr neighbors =
+        inView->radiusTable(m_radius, numThreads());
     for (PointId i = 0; i < np; ++i)
     {
-        auto ids = index.radius(i, m_radius);
-        if (ids.size() > size_t(m_minK))
+        if (neighbors->count(i) > size_t(m_minK))
             inliers.push_back(i);
         else
             outliers.push_back(i);
@@ -94,9 +92,6 @@ Indices OutlierFilter::processRadius(PointViewPtr inView)
 
 Indices OutlierFilter::processStatistical(PointViewPtr inView)
 {
-    KD3Index index(*inView);
-    index.build();
-
     point_count_t np = inView->size();
 
     std::vector<PointId> inliers, outliers;
@@ -106,20 +101,16 @@ Indices OutlierFilter::processStatistical(PointViewPtr inView)
     // we increase the count by one because the query point itself will
     // be included with a distance of 0
     point_count_t count = m_meanK + 1;
-    std::vector<PointId> indices(count);
-    std::vector<double> sqr_dists(count);
+    NeighborTablePtr neighbors =
+        inView->knnTable(count, numThreads());
     for (PointId i = 0; i < np; ++i)
     {
-
-        index.knnSearch(i, count, &indices, &sqr_dists);
-
-        for (size_t j = 1; j < count; ++j)
+        const double *sqr_dists = neighbors->sqrDists(i);
+        for (size_t j = 1; j < neighbors->count(i); ++j)
         {
             double delta = std::sqrt(sqr_dists[j]) - distances[i];
             distances[i] += (delta / j);
         }
-        indices.clear(); indices.resize(count);
-        sqr_dists.clear(); sqr_dists.resize(count);
     }
 
     size_t n(0);
@@ -78,6 +78,8 @@ private:
     Indices processRadius(PointViewPtr inView);
     Indices processStatistical(PointViewPtr inView);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool parallelRunnable() const
+        { return true; }
 
     OutlierFilter& operator=(const OutlierFilter&); // not implemented
     OutlierFilter(const OutlierFilter&);            // not implemented
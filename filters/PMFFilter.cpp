@@ -41,10 +41,16 @@
 
 #include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
+#include <pdal/Morphology.hpp>
 #include <pdal/Segmentation.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "private/DimRange.hpp"
+#include "private/GroundTiles.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
 
 namespace pdal
 {
@@ -71,6 +77,8 @@ void PMFFilter::addArgs(ProgramArgs& args)
     args.add("max_distance", "Maximum distance", m_maxDistance, 2.5);
     args.add("max_window_size", "Maximum window size", m_maxWindowSize, 33.0);
     args.add("slope", "Slope", m_slope, 1.0);
+    args.add("tile_size", "Size of tiles classified concurrently "
+        "(0 for no tiling)", m_tileSize, 0.0);
 }
 
 void PMFFilter::addDimensions(PointLayoutPtr layout)
@@ -96,6 +104,10 @@ void PMFFilter::prepared(PointTableRef table)
             m_lastOnly = false;
         }
     }
+
+    // The windows are shared by views run in parallel, so compute them
+    // once here rather than in run().
+    computeWindows();
 }
 
 PointViewSet PMFFilter::run(PointViewPtr input)
@@ -125,8 +137,17 @@ PointViewSet PMFFilter::run(PointViewPtr input)
     else
         lastView->append(*keptView);
 
-    // Run the actual PMF algorithm.
-    processGround(lastView);
+    // Run the actual PMF algorithm.  Each opening builds on the previous
+    // one, so a cell is affected by cells as far away as the sum of the
+    // opening reaches.
+    int buffer = 1;
+    for (float ws : m_wsvec)
+        buffer += 2 * (int)(0.5 * (ws - 1));
+    int tileSize = (int)std::ceil(m_tileSize / m_cellSize);
+
+    classifyTiles(lastView, m_cellSize, tileSize, buffer, numThreads(),
+        [this](PointViewPtr v, const GroundGrid& grid)
+        { processGround(v, grid); });
 
     // Prepare the output PointView.
     PointViewPtr outView = input->makeNew();
@@ -138,13 +159,46 @@ PointViewSet PMFFilter::run(PointViewPtr input)
     return viewSet;
 }
 
-void PMFFilter::processGround(PointViewPtr view)
+void PMFFilter::computeWindows()
 {
-    // initialize bounds, rows, columns, and surface
-    BOX2D bounds;
-    view->calculateBounds(bounds);
-    size_t cols = ((bounds.maxx - bounds.minx) / m_cellSize) + 1;
-    size_t rows = ((bounds.maxy - bounds.miny) / m_cellSize) + 1;
+    // Compute the series of window sizes and height thresholds
+    m_wsvec.clear();
+    m_htvec.clear();
+    int iter = 0;
+    float ws = 0.0f;
+    float ht = 0.0f;
+
+    // pre-compute window sizes and height thresholds
+    while (ws < m_maxWindowSize)
+    {
+        // Determine the initial window size.
+        if (m_exponential)
+            ws = m_cellSize * (2.0f * std::pow(2, iter) + 1.0f);
+        else
+            ws = m_cellSize * (2.0f * (iter + 1) * 2 + 1.0f);
+
+        // Calculate the height threshold to be used in the next iteration.
+        if (iter == 0)
+            ht = m_initialDistance;
+        else
+            ht = m_slope * (ws - m_wsvec[iter - 1]) * m_cellSize +
+                 m_initialDistance;
+
+        // Enforce max distance on height threshold
+        if (ht > m_maxDistance)
+            ht = m_maxDistance;
+
+        m_wsvec.push_back(ws);
+        m_htvec.push_back(ht);
+
+        iter++;
+    }
+}
+
+void PMFFilter::processGround(PointViewPtr view, const GroundGrid& grid)
+{
+    const size_t rows(grid.m_rows);
+    const size_t cols(grid.m_cols);
 
     // initialize surface to NaN
     std::vector<double> ZImin(rows * cols,
@@ -157,8 +211,8 @@ void PMFFilter::processGround(PointViewPtr view)
         double x = view->getFieldAs<double>(Dimension::Id::X, i);
         double y = view->getFieldAs<double>(Dimension::Id::Y, i);
         double z = view->getFieldAs<double>(Dimension::Id::Z, i);
-        int c = static_cast<int>(floor(x - bounds.minx) / m_cellSize);
-        int r = static_cast<int>(floor(y - bounds.miny) / m_cellSize);
+        int c = grid.col(x);
+        int r = grid.row(y);
         size_t idx = c * rows + r;
         if (z < ZImin[idx] || std::isnan(ZImin[idx]))
             ZImin[idx] = z;
@@ -174,10 +228,8 @@ void PMFFilter::processGround(PointViewPtr view)
             size_t idx = c * rows + r;
             if (std::isnan(ZImin[idx]))
                 continue;
-            double x = bounds.minx + (c + 0.5) * m_cellSize;
-            double y = bounds.miny + (r + 0.5) * m_cellSize;
-            temp->setField(Dimension::Id::X, i, x);
-            temp->setField(Dimension::Id::Y, i, y);
+            temp->setField(Dimension::Id::X, i, grid.x(c));
+            temp->setField(Dimension::Id::Y, i, grid.y(r));
             temp->setField(Dimension::Id::Z, i, ZImin[idx]);
             i++;
         }
@@ -197,12 +249,10 @@ void PMFFilter::processGround(PointViewPtr view)
             size_t idx = c * rows + r;
             if (!std::isnan(out[idx]))
                 continue;
-            double x = bounds.minx + (c + 0.5) * m_cellSize;
-            double y = bounds.miny + (r + 0.5) * m_cellSize;
             int k = 1;
             std::vector<PointId> neighbors(k);
             std::vector<double> sqr_dists(k);
-            kdi.knnSearch(x, y, k, &neighbors, &sqr_dists);
+            kdi.knnSearch(grid.x(c), grid.y(r), k, &neighbors, &sqr_dists);
             out[idx] = temp->getFieldAs<double>(Dimension::Id::Z, neighbors[0]);
         }
     }
@@ -214,50 +264,22 @@ void PMFFilter::processGround(PointViewPtr view)
     for (PointId i = 0; i < view->size(); ++i)
         groundIdx.push_back(i);
 
-    // Compute the series of window sizes and height thresholds
-    std::vector<float> htvec;
-    std::vector<float> wsvec;
-    int iter = 0;
-    float ws = 0.0f;
-    float ht = 0.0f;
-
-    // pre-compute window sizes and height thresholds
-    while (ws < m_maxWindowSize)
-    {
-        // Determine the initial window size.
-        if (m_exponential)
-            ws = m_cellSize * (2.0f * std::pow(2, iter) + 1.0f);
-        else
-            ws = m_cellSize * (2.0f * (iter + 1) * 2 + 1.0f);
-
-        // Calculate the height threshold to be used in the next iteration.
-        if (iter == 0)
-            ht = m_initialDistance;
-        else
-            ht = m_slope * (ws - wsvec[iter - 1]) * m_cellSize +
-                 m_initialDistance;
-
-        // Enforce max distance on height threshold
-        if (ht > m_maxDistance)
-            ht = m_maxDistance;
-
-        wsvec.push_back(ws);
-        htvec.push_back(ht);
-
-        iter++;
-    }
+    // Tiles are classified concurrently, so only report progress for a
+    // single raster.
+    const bool verbose(!grid.m_tile);
 
     // Progressively filter ground returns using morphological open
-    for (size_t j = 0; j < wsvec.size(); ++j)
+    for (size_t j = 0; j < m_wsvec.size(); ++j)
     {
-        log()->get(LogLevel::Debug)
-            << "Iteration " << j << " (height threshold = " << htvec[j]
-            << ", window size = " << wsvec[j] << ")...\n";
+        if (verbose)
+            log()->get(LogLevel::Debug)
+                << "Iteration " << j << " (height threshold = " << m_htvec[j]
+                << ", window size = " << m_wsvec[j] << ")...\n";
 
-        int iters = 0.5 * (wsvec[j] - 1);
-        using namespace eigen;
-        std::vector<double> me = erodeDiamond(ZImin, rows, cols, iters);
-        std::vector<double> mo = dilateDiamond(me, rows, cols, iters);
+        int iters = 0.5 * (m_wsvec[j] - 1);
+        std::vector<double> mo(ZImin);
+        Morphology::open(mo, rows, cols, Morphology::Shape::Diamond, iters,
+            grid.m_threads);
 
         std::vector<PointId> groundNewIdx;
         for (auto p_idx : groundIdx)
@@ -266,22 +288,23 @@ void PMFFilter::processGround(PointViewPtr view)
             double y = view->getFieldAs<double>(Dimension::Id::Y, p_idx);
             double z = view->getFieldAs<double>(Dimension::Id::Z, p_idx);
 
-            int c = static_cast<int>(floor((x - bounds.minx) / m_cellSize));
-            int r = static_cast<int>(floor((y - bounds.miny) / m_cellSize));
-
-            if ((z - mo[c * rows + r]) < htvec[j])
+            int c = grid.col(x);
+            int r = grid.row(y);
+            if ((z - mo[c * rows + r]) < m_htvec[j])
                 groundNewIdx.push_back(p_idx);
         }
 
         ZImin.swap(mo);
         groundIdx.swap(groundNewIdx);
 
-        log()->get(LogLevel::Debug)
-            << "Ground now has " << groundIdx.size() << " points.\n";
+        if (verbose)
+            log()->get(LogLevel::Debug)
+                << "Ground now has " << groundIdx.size() << " points.\n";
     }
 
-    log()->get(LogLevel::Debug2)
-        << "Labeled " << groundIdx.size() << " ground returns!\n";
+    if (verbose)
+        log()->get(LogLevel::Debug2)
+            << "Labeled " << groundIdx.size() << " ground returns!\n";
 
     // set the classification label of ground returns as 2
     // (corresponding to ASPRS LAS specification)
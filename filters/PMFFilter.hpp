@@ -38,12 +38,16 @@
 
 #include "private/DimRange.hpp"
 
+#include <vector>
+
 extern "C" int32_t PMFFilter_ExitFunc();
 extern "C" PF_ExitFunc PMFFilter_InitPlugin();
 
 namespace pdal
 {
 
+struct GroundGrid;
+
 class PDAL_DLL PMFFilter : public Filter
 {
 public:
@@ -64,13 +68,19 @@ private:
     double m_maxDistance;
     double m_maxWindowSize;
     double m_slope;
+    double m_tileSize;
+    std::vector<float> m_wsvec;
+    std::vector<float> m_htvec;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool parallelRunnable() const
+        { return true; }
 
-    void processGround(PointViewPtr view);
+    void computeWindows();
+    void processGround(PointViewPtr view, const GroundGrid& grid);
 
     PMFFilter& operator=(const PMFFilter&); // not implemented
     PMFFilter(const PMFFilter&);            // not implemented
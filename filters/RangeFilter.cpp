@@ -138,6 +138,37 @@ bool RangeFilter::processOne(PointRef& point)
 }
 
 
+// Check the ranges of one dimension at a time against the whole batch, so
+// that each dimension value is read once per point.
+void RangeFilter::processBatch(StreamPointTable& table, point_count_t count,
+    SkipMask& skips)
+{
+    PointRef point(table, 0);
+    auto begin = m_range_list.begin();
+    while (begin != m_range_list.end())
+    {
+        const Dimension::Id id = begin->m_id;
+        auto end = begin;
+        while (end != m_range_list.end() && end->m_id == id)
+            end++;
+
+        for (PointId idx = 0; idx < count; idx++)
+        {
+            if (skips.skipped(idx))
+                continue;
+            point.setPointId(idx);
+            double d = point.getFieldAs<double>(id);
+            bool passes = false;
+            for (auto ri = begin; ri != end && !passes; ++ri)
+                passes = ri->valuePasses(d);
+            if (!passes)
+                skips.skip(idx);
+        }
+        begin = end;
+    }
+}
+
+
 PointViewSet RangeFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
@@ -67,6 +67,8 @@ private:
     virtual void initialize();
     virtual void prepared(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, point_count_t count,
+        SkipMask& skips);
     virtual PointViewSet run(PointViewPtr view);
 
     RangeFilter& operator=(const RangeFilter&) = delete;
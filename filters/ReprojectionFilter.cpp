@@ -37,6 +37,7 @@
 #include <pdal/PointView.hpp>
 #include <pdal/GDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <gdal.h>
 #include <ogr_spatialref.h>
@@ -46,6 +47,14 @@
 namespace pdal
 {
 
+namespace
+{
+
+// Number of points transformed with each call to GDAL.
+const point_count_t BatchSize = 4096;
+
+} // unnamed namespace
+
 static PluginInfo const s_info = PluginInfo(
     "filters.reprojection",
     "Reproject data using GDAL from one coordinate system to another.",
@@ -79,6 +88,7 @@ void ReprojectionFilter::addArgs(ProgramArgs& args)
 {
     args.add("out_srs", "Output spatial reference", m_outSRS).setPositional();
     args.add("in_srs", "Input spatial reference", m_inSRS);
+    addThreadsArg(args, "Number of threads used to transform points");
 }
 
 
@@ -131,16 +141,71 @@ void ReprojectionFilter::createTransform(const SpatialReference& srsSRS)
 PointViewSet ReprojectionFilter::run(PointViewPtr view)
 {
     PointViewSet viewSet;
-    PointViewPtr outView = view->makeNew();
 
     createTransform(view->spatialReference());
 
-    PointRef point(*view, 0);
-    for (PointId id = 0; id < view->size(); ++id)
+    // Split the view into contiguous ranges, one for each thread.  Each
+    // thread gets its own transform, since transforms aren't thread-safe.
+    // Points are moved without touching the view's neighbor cache, so
+    // the cache is discarded here, before any thread starts.
+    view->invalidateNeighbors();
+    const point_count_t size = view->size();
+    std::vector<char> failed(size);
+    size_t threadCount = (std::min)((point_count_t)numThreads(),
+        (size + BatchSize - 1) / BatchSize);
+    if (threadCount <= 1)
+        transformRange(m_transform_ptr, *view, 0, size, failed);
+    else
+    {
+        std::vector<TransformPtr> transforms(threadCount - 1);
+        auto destroy = [&transforms]()
+        {
+            for (TransformPtr t : transforms)
+                if (t)
+                    OCTDestroyCoordinateTransformation(t);
+        };
+        for (TransformPtr& t : transforms)
+        {
+            t = OCTNewCoordinateTransformation(m_in_ref_ptr, m_out_ref_ptr);
+            if (!t)
+            {
+                destroy();
+                throwError("Could not construct coordinate transformation "
+                    "object for thread.");
+            }
+        }
+
+        point_count_t per = (size + threadCount - 1) / threadCount;
+        try
+        {
+            ThreadPool pool(threadCount);
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                TransformPtr t = i ? transforms[i - 1] : m_transform_ptr;
+                PointId begin = i * per;
+                PointId end = (std::min)(begin + per, size);
+                pool.add([this, t, &view, begin, end, &failed]()
+                    { transformRange(t, *view, begin, end, failed); });
+            }
+            pool.join();
+        }
+        catch (...)
+        {
+            destroy();
+            throw;
+        }
+        destroy();
+    }
+
+    // Points that couldn't be transformed are dropped.  Usually there are
+    // none and the input view is passed through.
+    PointViewPtr outView = view;
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end())
     {
-        point.setPointId(id);
-        if (processOne(point))
-            outView->appendPoint(*view, id);
+        outView = view->makeNew();
+        for (PointId id = 0; id < size; ++id)
+            if (!failed[id])
+                outView->appendPoint(*view, id);
     }
 
     viewSet.insert(outView);
@@ -151,6 +216,58 @@ PointViewSet ReprojectionFilter::run(PointViewPtr view)
 }
 
 
+// Transform the points [begin, end) of a view in batches, noting points
+// that fail.
+void ReprojectionFilter::transformRange(TransformPtr transform,
+    PointView& view, PointId begin, PointId end, std::vector<char>& failed)
+{
+    Batch batch;
+    PointRef point(view, 0);
+    for (PointId first = begin; first < end; first += BatchSize)
+    {
+        PointId last = (std::min)(first + BatchSize, end);
+        batch.m_ids.clear();
+        for (PointId id = first; id < last; ++id)
+            batch.m_ids.push_back(id);
+        transformBatch(transform, point, batch);
+        for (size_t i = 0; i < batch.m_ids.size(); ++i)
+        {
+            if (batch.m_ok[i])
+                view.setPosition(batch.m_ids[i], batch.m_x[i], batch.m_y[i],
+                    batch.m_z[i]);
+            else
+                failed[batch.m_ids[i]] = 1;
+        }
+    }
+}
+
+
+// Transform the points of a batch with a single call to GDAL.  The
+// transformed coordinates are left in the batch for the caller to store.
+void ReprojectionFilter::transformBatch(TransformPtr transform,
+    PointRef& point, Batch& batch)
+{
+    const size_t count = batch.m_ids.size();
+    batch.m_x.resize(count);
+    batch.m_y.resize(count);
+    batch.m_z.resize(count);
+    batch.m_ok.assign(count, 0);
+    if (count == 0)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        point.setPointId(batch.m_ids[i]);
+        batch.m_x[i] = point.getFieldAs<double>(Dimension::Id::X);
+        batch.m_y[i] = point.getFieldAs<double>(Dimension::Id::Y);
+        batch.m_z[i] = point.getFieldAs<double>(Dimension::Id::Z);
+    }
+
+    OCTTransformEx(transform, (int)count, batch.m_x.data(),
+        batch.m_y.data(), batch.m_z.data(), batch.m_ok.data());
+}
+
+
 bool ReprojectionFilter::processOne(PointRef& point)
 {
     double x(point.getFieldAs<double>(Dimension::Id::X));
@@ -171,4 +288,31 @@ bool ReprojectionFilter::processOne(PointRef& point)
     }
 }
 
+
+// Transform the points of a batch with a single call to GDAL.
+void ReprojectionFilter::processBatch(StreamPointTable& table,
+    point_count_t count, SkipMask& skips)
+{
+    m_batch.m_ids.clear();
+    for (PointId idx = 0; idx < count; idx++)
+        if (!skips.skipped(idx))
+            m_batch.m_ids.push_back(idx);
+
+    PointRef point(table, 0);
+    transformBatch(m_transform_ptr, point, m_batch);
+
+    for (size_t i = 0; i < m_batch.m_ids.size(); ++i)
+    {
+        if (!m_batch.m_ok[i])
+        {
+            skips.skip(m_batch.m_ids[i]);
+            continue;
+        }
+        point.setPointId(m_batch.m_ids[i]);
+        point.setField(Dimension::Id::X, m_batch.m_x[i]);
+        point.setField(Dimension::Id::Y, m_batch.m_y[i]);
+        point.setField(Dimension::Id::Z, m_batch.m_z[i]);
+    }
+}
+
 } // namespace pdal
@@ -38,6 +38,7 @@
 #include <pdal/Streamable.hpp>
 
 #include <memory>
+#include <vector>
 
 extern "C" int32_t ReprojectionFilter_ExitFunc();
 extern "C" PF_ExitFunc ReprojectionFilter_InitPlugin();
@@ -66,20 +67,38 @@ private:
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, point_count_t count,
+        SkipMask& skips);
+
+    // Coordinates of a batch of points being transformed.
+    struct Batch
+    {
+        std::vector<PointId> m_ids;
+        std::vector<double> m_x;
+        std::vector<double> m_y;
+        std::vector<double> m_z;
+        std::vector<int> m_ok;
+    };
+
+    typedef void* ReferencePtr;
+    typedef void* TransformPtr;
 
     void updateBounds();
     void createTransform(const SpatialReference& srs);
+    void transformBatch(TransformPtr transform, PointRef& point,
+        Batch& batch);
+    void transformRange(TransformPtr transform, PointView& view,
+        PointId begin, PointId end, std::vector<char>& failed);
 
     SpatialReference m_inSRS;
     SpatialReference m_outSRS;
     bool m_inferInputSRS;
 
-    typedef void* ReferencePtr;
-    typedef void* TransformPtr;
     ReferencePtr m_in_ref_ptr;
     ReferencePtr m_out_ref_ptr;
     TransformPtr m_transform_ptr;
     gdal::ErrorHandler* m_errorHandler;
+    Batch m_batch;
 
     ReprojectionFilter& operator=(const ReprojectionFilter&); // not implemented
     ReprojectionFilter(const ReprojectionFilter&); // not implemented
@@ -41,11 +41,13 @@
 
 #include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
+#include <pdal/Morphology.hpp>
 #include <pdal/Segmentation.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "private/DimRange.hpp"
+#include "private/GroundTiles.hpp"
 
 #include <Eigen/Dense>
 
@@ -86,6 +88,8 @@ void SMRFilter::addArgs(ProgramArgs& args)
     args.add("dir", "Optional output directory for debugging", m_dir);
     args.add("ignore", "Ignore values", m_ignored);
     args.add("last", "Consider last returns only?", m_lastOnly, true);
+    args.add("tile_size", "Size of tiles classified concurrently "
+        "(0 for no tiling)", m_tileSize, 0.0);
 }
 
 void SMRFilter::addDimensions(PointLayoutPtr layout)
@@ -149,48 +153,62 @@ PointViewSet SMRFilter::run(PointViewPtr view)
 
     m_srs = lastView->spatialReference();
 
-    lastView->calculateBounds(m_bounds);
-    m_cols = ((m_bounds.maxx - m_bounds.minx) / m_cell) + 1;
-    m_rows = ((m_bounds.maxy - m_bounds.miny) / m_cell) + 1;
+    // The rasters of a tile are affected by points as far away as the
+    // morphological operations reach, plus a cell for the slope.
+    int buffer = 2 * (int)std::ceil(m_window / m_cell) + 2;
+    if (m_cut > 0.0)
+        buffer += 4 * (int)std::ceil(m_cut / m_cell);
+    int tileSize = (int)std::ceil(m_tileSize / m_cell);
+
+    classifyTiles(lastView, m_cell, tileSize, buffer, numThreads(),
+        [this](PointViewPtr v, const GroundGrid& grid)
+        { classify(v, grid); });
+
+    PointViewPtr outView = view->makeNew();
+    outView->append(*ignoredView);
+    outView->append(*nonlastView);
+    outView->append(*lastView);
+    viewSet.insert(outView);
 
+    return viewSet;
+}
+
+void SMRFilter::classify(PointViewPtr view, const GroundGrid& grid)
+{
     // Create raster of minimum Z values per element.
-    std::vector<double> ZImin = createZImin(lastView);
+    std::vector<double> ZImin = createZImin(view, grid);
 
     // Create raster mask of pixels containing low outlier points.
-    std::vector<int> Low = createLowMask(ZImin);
+    std::vector<int> Low = createLowMask(grid, ZImin);
 
     // Create raster mask of net cuts. Net cutting is used to when a scene
     // contains large buildings in highly differentiated terrain.
-    std::vector<int> isNetCell = createNetMask();
+    std::vector<int> isNetCell = createNetMask(grid);
 
     // Apply net cutting to minimum Z raster.
-    std::vector<double> ZInet = createZInet(ZImin, isNetCell);
+    std::vector<double> ZInet = createZInet(grid, ZImin, isNetCell);
 
     // Create raster mask of pixels containing object points. Note that we use
     // ZInet, the result of net cutting, to identify object pixels.
-    std::vector<int> Obj = createObjMask(ZInet);
+    std::vector<int> Obj = createObjMask(grid, ZInet);
 
     // Create raster representing the provisional DEM. Note that we use the
     // original ZImin (not ZInet), however the net cut mask will still force
     // interpolation at these pixels.
     std::vector<double> ZIpro =
-        createZIpro(lastView, ZImin, Low, isNetCell, Obj);
+        createZIpro(view, grid, ZImin, Low, isNetCell, Obj);
 
     // Classify ground returns by comparing elevation values to the provisional
     // DEM.
-    classifyGround(lastView, ZIpro);
-
-    PointViewPtr outView = view->makeNew();
-    outView->append(*ignoredView);
-    outView->append(*nonlastView);
-    outView->append(*lastView);
-    viewSet.insert(outView);
-
-    return viewSet;
+    classifyGround(view, grid, ZIpro);
 }
 
-void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
+void SMRFilter::classifyGround(PointViewPtr view, const GroundGrid& grid,
+    std::vector<double>& ZIpro)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     // "While many authors use a single value for the elevation threshold, we
     // suggest that a second parameter be used to increase the threshold on
     // steep slopes, transforming the threshold to a slope-dependent value. The
@@ -200,10 +218,10 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
     // vertical displacements yield larger errors on steep slopes, and as a
     // result the BE/OBJ threshold distance should be more permissive at these
     // points."
-    MatrixXd gsurfs(m_rows, m_cols);
-    MatrixXd thresh(m_rows, m_cols);
+    MatrixXd gsurfs(rows, cols);
+    MatrixXd thresh(rows, cols);
     {
-        MatrixXd ZIproM = Map<MatrixXd>(ZIpro.data(), m_rows, m_cols);
+        MatrixXd ZIproM = Map<MatrixXd>(ZIpro.data(), rows, cols);
         MatrixXd scaled = ZIproM / m_cell;
 
         MatrixXd gx = gradX(scaled);
@@ -211,28 +229,33 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
         gsurfs = (gx.cwiseProduct(gx) + gy.cwiseProduct(gy)).cwiseSqrt();
         std::vector<double> gsurfsV(gsurfs.data(),
                                     gsurfs.data() + gsurfs.size());
-        std::vector<double> gsurfs_fillV = knnfill(view, gsurfsV);
-        gsurfs = Map<MatrixXd>(gsurfs_fillV.data(), m_rows, m_cols);
+        std::vector<double> gsurfs_fillV = knnfill(view, grid, gsurfsV);
+        gsurfs = Map<MatrixXd>(gsurfs_fillV.data(), rows, cols);
         thresh = (m_threshold + m_scalar * gsurfs.array()).matrix();
 
         if (!m_dir.empty())
         {
-            std::string fname = FileUtils::toAbsolutePath("gx.tif", m_dir);
-            writeMatrix(gx, fname, "GTiff", m_cell, m_bounds, m_srs);
+            std::string fname = FileUtils::toAbsolutePath(grid.m_prefix +
+                "gx.tif", m_dir);
+            writeMatrix(gx, fname, "GTiff", m_cell, grid.bounds(), m_srs);
 
-            fname = FileUtils::toAbsolutePath("gy.tif", m_dir);
-            writeMatrix(gy, fname, "GTiff", m_cell, m_bounds, m_srs);
+            fname = FileUtils::toAbsolutePath(grid.m_prefix + "gy.tif", m_dir);
+            writeMatrix(gy, fname, "GTiff", m_cell, grid.bounds(), m_srs);
 
-            fname = FileUtils::toAbsolutePath("gsurfs.tif", m_dir);
-            writeMatrix(gsurfs, fname, "GTiff", m_cell, m_bounds, m_srs);
+            fname = FileUtils::toAbsolutePath(grid.m_prefix +
+                "gsurfs.tif", m_dir);
+            writeMatrix(gsurfs, fname, "GTiff", m_cell, grid.bounds(), m_srs);
 
-            fname = FileUtils::toAbsolutePath("gsurfs_fill.tif", m_dir);
+            fname = FileUtils::toAbsolutePath(grid.m_prefix +
+                "gsurfs_fill.tif", m_dir);
             MatrixXd gsurfs_fill =
-                Map<MatrixXd>(gsurfs_fillV.data(), m_rows, m_cols);
-            writeMatrix(gsurfs_fill, fname, "GTiff", m_cell, m_bounds, m_srs);
+                Map<MatrixXd>(gsurfs_fillV.data(), rows, cols);
+            writeMatrix(gsurfs_fill, fname, "GTiff", m_cell, grid.bounds(),
+                m_srs);
 
-            fname = FileUtils::toAbsolutePath("thresh.tif", m_dir);
-            writeMatrix(thresh, fname, "GTiff", m_cell, m_bounds, m_srs);
+            fname = FileUtils::toAbsolutePath(grid.m_prefix +
+                "thresh.tif", m_dir);
+            writeMatrix(thresh, fname, "GTiff", m_cell, grid.bounds(), m_srs);
         }
     }
 
@@ -242,8 +265,8 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
         double y = view->getFieldAs<double>(Id::Y, i);
         double z = view->getFieldAs<double>(Id::Z, i);
 
-        size_t c = static_cast<size_t>(std::floor(x - m_bounds.minx) / m_cell);
-        size_t r = static_cast<size_t>(std::floor(y - m_bounds.miny) / m_cell);
+        size_t c = static_cast<size_t>(grid.col(x));
+        size_t r = static_cast<size_t>(grid.row(y));
 
         // TODO(chambbj): We don't quite do this by the book and yet it seems to
         // work reasonably well:
@@ -254,7 +277,7 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
         // DEM nearly corresponds to the resolution of the LIDAR data. Based on
         // these results, we find that a splined cubic interpolation provides
         // the best results."
-        if (std::isnan(ZIpro[c * m_rows + r]))
+        if (std::isnan(ZIpro[c * rows + r]))
             continue;
 
         if (std::isnan(gsurfs(r, c)))
@@ -264,15 +287,19 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
         // ground/object LIDAR points. This is accomplished by measuring the
         // vertical distance between each LIDAR point and the provisional
         // DEM, and applying a threshold calculation."
-        if (std::fabs(ZIpro[c * m_rows + r] - z) > thresh(r, c))
+        if (std::fabs(ZIpro[c * rows + r] - z) > thresh(r, c))
             view->setField(Id::Classification, i, 1);
         else
             view->setField(Id::Classification, i, 2);
     }
 }
 
-std::vector<int> SMRFilter::createLowMask(std::vector<double> const& ZImin)
+std::vector<int> SMRFilter::createLowMask(const GroundGrid& grid,
+    std::vector<double> const& ZImin)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     // "[The] minimum surface is checked for low outliers by inverting the point
     // cloud in the z-axis and applying the filter with parameters (slope =
     // 500%, maxWindowSize = 1). The resulting mask is used to flag low outlier
@@ -282,21 +309,25 @@ std::vector<int> SMRFilter::createLowMask(std::vector<double> const& ZImin)
     std::vector<double> negZImin;
     std::transform(ZImin.begin(), ZImin.end(), std::back_inserter(negZImin),
                    [](double v) { return -v; });
-    std::vector<int> LowV = progressiveFilter(negZImin, 5.0, 1.0);
+    std::vector<int> LowV = progressiveFilter(grid, negZImin, 5.0, 1.0);
 
     if (!m_dir.empty())
     {
-        std::string fname = FileUtils::toAbsolutePath("zilow.tif", m_dir);
-        MatrixXi Low = Map<MatrixXi>(LowV.data(), m_rows, m_cols);
-        writeMatrix(Low.cast<double>(), fname, "GTiff", m_cell, m_bounds,
+        std::string fname = FileUtils::toAbsolutePath(grid.m_prefix +
+            "zilow.tif", m_dir);
+        MatrixXi Low = Map<MatrixXi>(LowV.data(), rows, cols);
+        writeMatrix(Low.cast<double>(), fname, "GTiff", m_cell, grid.bounds(),
                     m_srs);
     }
 
     return LowV;
 }
 
-std::vector<int> SMRFilter::createNetMask()
+std::vector<int> SMRFilter::createNetMask(const GroundGrid& grid)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     // "To accommodate the removal of [very large buildings on highly
     // differentiated terrain], we implemented a feature in the published SMRF
     // algorithm which is helpful in removing such features. We accomplish this
@@ -304,23 +335,23 @@ std::vector<int> SMRFilter::createNetMask()
     // at a spacing equal to the maximum window diameter, where these minimum
     // values are found by applying a morphological open operation with a disk
     // shaped structuring element of radius (2*wkmax)."
-    std::vector<int> isNetCell(m_rows * m_cols, 0);
+    std::vector<int> isNetCell(rows * cols, 0);
     if (m_cut > 0.0)
     {
         int v = std::ceil(m_cut / m_cell);
 
-        for (auto c = 0; c < m_cols; c += v)
+        for (auto c = 0; c < cols; c += v)
         {
-            for (auto r = 0; r < m_rows; ++r)
+            for (auto r = 0; r < rows; ++r)
             {
-                isNetCell[c * m_rows + r] = 1;
+                isNetCell[c * rows + r] = 1;
             }
         }
-        for (auto c = 0; c < m_cols; ++c)
+        for (auto c = 0; c < cols; ++c)
         {
-            for (auto r = 0; r < m_rows; r += v)
+            for (auto r = 0; r < rows; r += v)
             {
-                isNetCell[c * m_rows + r] = 1;
+                isNetCell[c * rows + r] = 1;
             }
         }
     }
@@ -328,32 +359,41 @@ std::vector<int> SMRFilter::createNetMask()
     return isNetCell;
 }
 
-std::vector<int> SMRFilter::createObjMask(std::vector<double> const& ZImin)
+std::vector<int> SMRFilter::createObjMask(const GroundGrid& grid,
+    std::vector<double> const& ZImin)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     // "The second stage of the ground identification algorithm involves the
     // application of a progressive morphological filter to the minimum surface
     // grid (ZImin)."
-    std::vector<int> ObjV = progressiveFilter(ZImin, m_slope, m_window);
+    std::vector<int> ObjV = progressiveFilter(grid, ZImin, m_slope, m_window);
 
     if (!m_dir.empty())
     {
-        std::string fname = FileUtils::toAbsolutePath("ziobj.tif", m_dir);
-        MatrixXi Obj = Map<MatrixXi>(ObjV.data(), m_rows, m_cols);
-        writeMatrix(Obj.cast<double>(), fname, "GTiff", m_cell, m_bounds,
+        std::string fname = FileUtils::toAbsolutePath(grid.m_prefix +
+            "ziobj.tif", m_dir);
+        MatrixXi Obj = Map<MatrixXi>(ObjV.data(), rows, cols);
+        writeMatrix(Obj.cast<double>(), fname, "GTiff", m_cell, grid.bounds(),
                     m_srs);
     }
 
     return ObjV;
 }
 
-std::vector<double> SMRFilter::createZImin(PointViewPtr view)
+std::vector<double> SMRFilter::createZImin(PointViewPtr view,
+    const GroundGrid& grid)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     using namespace Dimension;
 
     // "As with many other ground filtering algorithms, the first step is
     // generation of ZImin from the cell size parameter and the extent of the
     // data."
-    std::vector<double> ZIminV(m_rows * m_cols,
+    std::vector<double> ZIminV(rows * cols,
                                std::numeric_limits<double>::quiet_NaN());
 
     for (PointId i = 0; i < view->size(); ++i)
@@ -362,36 +402,42 @@ std::vector<double> SMRFilter::createZImin(PointViewPtr view)
         double y = view->getFieldAs<double>(Id::Y, i);
         double z = view->getFieldAs<double>(Id::Z, i);
 
-        int c = static_cast<int>(floor(x - m_bounds.minx) / m_cell);
-        int r = static_cast<int>(floor(y - m_bounds.miny) / m_cell);
+        int c = grid.col(x);
+        int r = grid.row(y);
 
-        if (z < ZIminV[c * m_rows + r] || std::isnan(ZIminV[c * m_rows + r]))
-            ZIminV[c * m_rows + r] = z;
+        if (z < ZIminV[c * rows + r] || std::isnan(ZIminV[c * rows + r]))
+            ZIminV[c * rows + r] = z;
     }
 
     // "...some grid points of ZImin will go unfilled. To fill these values, we
     // rely on computationally inexpensive image inpainting techniques. Image
     // inpainting involves the replacement of the empty cells in an image (or
     // matrix) with values calculated from other nearby values."
-    std::vector<double> ZImin_fillV = knnfill(view, ZIminV);
+    std::vector<double> ZImin_fillV = knnfill(view, grid, ZIminV);
 
     if (!m_dir.empty())
     {
-        std::string fname = FileUtils::toAbsolutePath("zimin.tif", m_dir);
-        MatrixXd ZImin = Map<MatrixXd>(ZIminV.data(), m_rows, m_cols);
-        writeMatrix(ZImin, fname, "GTiff", m_cell, m_bounds, m_srs);
-
-        fname = FileUtils::toAbsolutePath("zimin_fill.tif", m_dir);
-        MatrixXd ZImin_fill = Map<MatrixXd>(ZImin_fillV.data(), m_rows, m_cols);
-        writeMatrix(ZImin_fill, fname, "GTiff", m_cell, m_bounds, m_srs);
+        std::string fname = FileUtils::toAbsolutePath(grid.m_prefix +
+            "zimin.tif", m_dir);
+        MatrixXd ZImin = Map<MatrixXd>(ZIminV.data(), rows, cols);
+        writeMatrix(ZImin, fname, "GTiff", m_cell, grid.bounds(), m_srs);
+
+        fname = FileUtils::toAbsolutePath(grid.m_prefix +
+            "zimin_fill.tif", m_dir);
+        MatrixXd ZImin_fill = Map<MatrixXd>(ZImin_fillV.data(), rows, cols);
+        writeMatrix(ZImin_fill, fname, "GTiff", m_cell, grid.bounds(), m_srs);
     }
 
     return ZImin_fillV;
 }
 
-std::vector<double> SMRFilter::createZInet(std::vector<double> const& ZImin,
+std::vector<double> SMRFilter::createZInet(const GroundGrid& grid,
+                                           std::vector<double> const& ZImin,
                                            std::vector<int> const& isNetCell)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     // "To accommodate the removal of [very large buildings on highly
     // differentiated terrain], we implemented a feature in the published SMRF
     // algorithm which is helpful in removing such features. We accomplish this
@@ -403,17 +449,16 @@ std::vector<double> SMRFilter::createZInet(std::vector<double> const& ZImin,
     if (m_cut > 0.0)
     {
         int v = std::ceil(m_cut / m_cell);
-        std::vector<double> bigErode =
-            erodeDiamond(ZImin, m_rows, m_cols, 2 * v);
-        std::vector<double> bigOpen =
-            dilateDiamond(bigErode, m_rows, m_cols, 2 * v);
-        for (auto c = 0; c < m_cols; ++c)
+        std::vector<double> bigOpen(ZImin);
+        Morphology::open(bigOpen, rows, cols, Morphology::Shape::Diamond,
+            2 * v, grid.m_threads);
+        for (auto c = 0; c < cols; ++c)
         {
-            for (auto r = 0; r < m_rows; ++r)
+            for (auto r = 0; r < rows; ++r)
             {
-                if (isNetCell[c * m_rows + r] == 1)
+                if (isNetCell[c * rows + r] == 1)
                 {
-                    ZInetV[c * m_rows + r] = bigOpen[c * m_rows + r];
+                    ZInetV[c * rows + r] = bigOpen[c * rows + r];
                 }
             }
         }
@@ -421,20 +466,25 @@ std::vector<double> SMRFilter::createZInet(std::vector<double> const& ZImin,
 
     if (!m_dir.empty())
     {
-        std::string fname = FileUtils::toAbsolutePath("zinet.tif", m_dir);
-        MatrixXd ZInet = Map<MatrixXd>(ZInetV.data(), m_rows, m_cols);
-        writeMatrix(ZInet, fname, "GTiff", m_cell, m_bounds, m_srs);
+        std::string fname = FileUtils::toAbsolutePath(grid.m_prefix +
+            "zinet.tif", m_dir);
+        MatrixXd ZInet = Map<MatrixXd>(ZInetV.data(), rows, cols);
+        writeMatrix(ZInet, fname, "GTiff", m_cell, grid.bounds(), m_srs);
     }
 
     return ZInetV;
 }
 
 std::vector<double> SMRFilter::createZIpro(PointViewPtr view,
+                                           const GroundGrid& grid,
                                            std::vector<double> const& ZImin,
                                            std::vector<int> const& Low,
                                            std::vector<int> const& isNetCell,
                                            std::vector<int> const& Obj)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     // "The end result of the iteration process described above is a binary grid
     // where each cell is classified as being either bare earth (BE) or object
     // (OBJ). The algorithm then applies this mask to the starting minimum
@@ -448,17 +498,19 @@ std::vector<double> SMRFilter::createZIpro(PointViewPtr view,
 
     // "These cells are then inpainted according to the same process described
     // previously, producing a provisional DEM (ZIpro)."
-    std::vector<double> ZIpro_fillV = knnfill(view, ZIproV);
+    std::vector<double> ZIpro_fillV = knnfill(view, grid, ZIproV);
 
     if (!m_dir.empty())
     {
-        std::string fname = FileUtils::toAbsolutePath("zipro.tif", m_dir);
-        MatrixXd ZIpro = Map<MatrixXd>(ZIproV.data(), m_rows, m_cols);
-        writeMatrix(ZIpro, fname, "GTiff", m_cell, m_bounds, m_srs);
-
-        fname = FileUtils::toAbsolutePath("zipro_fill.tif", m_dir);
-        MatrixXd ZIpro_fill = Map<MatrixXd>(ZIpro_fillV.data(), m_rows, m_cols);
-        writeMatrix(ZIpro_fill, fname, "GTiff", m_cell, m_bounds, m_srs);
+        std::string fname = FileUtils::toAbsolutePath(grid.m_prefix +
+            "zipro.tif", m_dir);
+        MatrixXd ZIpro = Map<MatrixXd>(ZIproV.data(), rows, cols);
+        writeMatrix(ZIpro, fname, "GTiff", m_cell, grid.bounds(), m_srs);
+
+        fname = FileUtils::toAbsolutePath(grid.m_prefix +
+            "zipro_fill.tif", m_dir);
+        MatrixXd ZIpro_fill = Map<MatrixXd>(ZIpro_fillV.data(), rows, cols);
+        writeMatrix(ZIpro_fill, fname, "GTiff", m_cell, grid.bounds(), m_srs);
     }
 
     return ZIpro_fillV;
@@ -466,25 +518,33 @@ std::vector<double> SMRFilter::createZIpro(PointViewPtr view,
 
 // Fill voids with the average of eight nearest neighbors.
 std::vector<double> SMRFilter::knnfill(PointViewPtr view,
+                                       const GroundGrid& grid,
                                        std::vector<double> const& cz)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     // Create a temporary PointView that encodes our raster values so that we
     // can construct a 2D KDIndex and perform nearest neighbor searches.
     PointViewPtr temp = view->makeNew();
+    std::vector<std::pair<int, int>> cells;
     PointId i(0);
-    for (int c = 0; c < m_cols; ++c)
+    for (int c = 0; c < cols; ++c)
     {
-        for (int r = 0; r < m_rows; ++r)
+        for (int r = 0; r < rows; ++r)
         {
-            if (std::isnan(cz[c * m_rows + r]))
+            if (std::isnan(cz[c * rows + r]))
                 continue;
 
-            temp->setField(Id::X, i, m_bounds.minx + (c + 0.5) * m_cell);
-            temp->setField(Id::Y, i, m_bounds.miny + (r + 0.5) * m_cell);
-            temp->setField(Id::Z, i, cz[c * m_rows + r]);
+            temp->setField(Id::X, i, grid.x(c));
+            temp->setField(Id::Y, i, grid.y(r));
+            temp->setField(Id::Z, i, cz[c * rows + r]);
+            cells.push_back(std::make_pair(c, r));
             i++;
         }
     }
+    if (temp->empty())
+        return cz;
 
     KD2Index kdi(*temp);
     kdi.build();
@@ -493,20 +553,46 @@ std::vector<double> SMRFilter::knnfill(PointViewPtr view,
     // nearest neighbors, and fill the void with the average value of the
     // neighbors.
     std::vector<double> out = cz;
-    for (int c = 0; c < m_cols; ++c)
+    for (int c = 0; c < cols; ++c)
     {
-        for (int r = 0; r < m_rows; ++r)
+        for (int r = 0; r < rows; ++r)
         {
-            if (!std::isnan(out[c * m_rows + r]))
+            if (!std::isnan(out[c * rows + r]))
                 continue;
 
-            double x = m_bounds.minx + (c + 0.5) * m_cell;
-            double y = m_bounds.miny + (r + 0.5) * m_cell;
-            int k = 8;
+            double x = grid.x(c);
+            double y = grid.y(r);
+            size_t k = (std::min)((point_count_t)8, temp->size());
             std::vector<PointId> neighbors(k);
             std::vector<double> sqr_dists(k);
             kdi.knnSearch(x, y, k, &neighbors, &sqr_dists);
 
+            // Cells at the same distance as the farthest neighbor are picked
+            // by the index in no particular order.  When tiling, gather all
+            // of them and order by distance and then position, so that the
+            // fill of a tile doesn't depend on the tile's extent.
+            if (m_tileSize > 0)
+            {
+                neighbors = kdi.radius(x, y,
+                    std::sqrt(sqr_dists.back()) + m_cell / 2);
+                auto cellDist = [&cells, c, r](PointId n)
+                {
+                    int dc = cells[n].first - c;
+                    int dr = cells[n].second - r;
+                    return dc * dc + dr * dr;
+                };
+                std::sort(neighbors.begin(), neighbors.end(),
+                    [&cells, &cellDist](PointId a, PointId b)
+                    {
+                        int da = cellDist(a);
+                        int db = cellDist(b);
+                        if (da != db)
+                            return da < db;
+                        return cells[a] < cells[b];
+                    });
+                neighbors.resize(k);
+            }
+
             double M1(0.0);
             size_t j(0);
             for (auto const& n : neighbors)
@@ -516,7 +602,7 @@ std::vector<double> SMRFilter::knnfill(PointViewPtr view,
                 M1 += (delta / j);
             }
 
-            out[c * m_rows + r] = M1;
+            out[c * rows + r] = M1;
         }
     }
 
@@ -526,9 +612,13 @@ std::vector<double> SMRFilter::knnfill(PointViewPtr view,
 // Iteratively open the estimated surface. progressiveFilter can be used to
 // identify both low points and object (i.e., non-ground) points, depending on
 // the inputs.
-std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
+std::vector<int> SMRFilter::progressiveFilter(const GroundGrid& grid,
+                                              std::vector<double> const& ZImin,
                                               double slope, double max_window)
 {
+    const int rows(grid.m_rows);
+    const int cols(grid.m_cols);
+
     // "The maximum window radius is supplied as a distance metric (e.g., 21 m),
     // but is internally converted to a pixel equivalent by dividing it by the
     // cell size and rounding the result toward positive infinity (i.e., taking
@@ -540,16 +630,18 @@ std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
     // "...the radius of the element at each step [is] increased by one pixel
     // from a starting value of one pixel to the pixel equivalent of the maximum
     // value."
-    std::vector<int> Obj(m_rows * m_cols, 0);
+    std::vector<int> Obj(rows * cols, 0);
     for (int radius = 1; radius <= max_radius; ++radius)
     {
         // "On the first iteration, the minimum surface (ZImin) is opened using
         // a disk-shaped structuring element with a radius of one pixel."
-        std::vector<double> curErosion =
-            erodeDiamond(prevErosion, m_rows, m_cols, 1);
-        std::vector<double> curOpening =
-            dilateDiamond(curErosion, m_rows, m_cols, radius);
-        prevErosion = curErosion;
+        // Each erosion builds on the last, so it only needs to grow by one
+        // pixel.
+        Morphology::erode(prevErosion, rows, cols,
+            Morphology::Shape::Diamond, 1, grid.m_threads);
+        std::vector<double> curOpening(prevErosion);
+        Morphology::dilate(curOpening, rows, cols,
+            Morphology::Shape::Diamond, radius, grid.m_threads);
 
         // "An elevation threshold is then calculated, where the value is equal
         // to the supplied slope tolerance parameter multiplied by the product
@@ -581,6 +673,11 @@ std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
         // as the minimum surface for the next difference calculation."
         prevSurface = curOpening;
 
+        // Tiles are classified concurrently, so only report progress for
+        // a single raster.
+        if (grid.m_tile)
+            continue;
+
         size_t ng = std::count(Obj.begin(), Obj.end(), 1);
         size_t g(Obj.size() - ng);
         double p(100.0 * double(ng) / double(Obj.size()));
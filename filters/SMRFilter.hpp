@@ -46,6 +46,8 @@ extern "C" PF_ExitFunc SMRFilter_InitPlugin();
 namespace pdal
 {
 
+struct GroundGrid;
+
 class PDAL_DLL SMRFilter : public Filter
 {
 public:
@@ -58,8 +60,6 @@ public:
     std::string getName() const;
 
 private:
-    int m_rows;
-    int m_cols;
     double m_cell;
     double m_cut;
     double m_slope;
@@ -69,7 +69,7 @@ private:
     std::string m_dir;
     DimRange m_ignored;
     bool m_lastOnly;
-    BOX2D m_bounds;
+    double m_tileSize;
     SpatialReference m_srs;
 
     virtual void addArgs(ProgramArgs& args);
@@ -78,19 +78,27 @@ private:
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
 
-    void classifyGround(PointViewPtr, std::vector<double>&);
-    std::vector<int> createLowMask(std::vector<double> const&);
-    std::vector<int> createNetMask();
-    std::vector<int> createObjMask(std::vector<double> const&);
-    std::vector<double> createZImin(PointViewPtr view);
-    std::vector<double> createZInet(std::vector<double> const&,
+    void classify(PointViewPtr, const GroundGrid&);
+    void classifyGround(PointViewPtr, const GroundGrid&,
+                        std::vector<double>&);
+    std::vector<int> createLowMask(const GroundGrid&,
+                                   std::vector<double> const&);
+    std::vector<int> createNetMask(const GroundGrid&);
+    std::vector<int> createObjMask(const GroundGrid&,
+                                   std::vector<double> const&);
+    std::vector<double> createZImin(PointViewPtr view, const GroundGrid&);
+    std::vector<double> createZInet(const GroundGrid&,
+                                    std::vector<double> const&,
                                     std::vector<int> const&);
-    std::vector<double> createZIpro(PointViewPtr, std::vector<double> const&,
+    std::vector<double> createZIpro(PointViewPtr, const GroundGrid&,
+                                    std::vector<double> const&,
                                     std::vector<int> const&,
                                     std::vector<int> const&,
                                     std::vector<int> const&);
-    std::vector<double> knnfill(PointViewPtr, std::vector<double> const&);
-    std::vector<int> progressiveFilter(std::vector<double> const&, double,
+    std::vector<double> knnfill(PointViewPtr, const GroundGrid&,
+                                std::vector<double> const&);
+    std::vector<int> progressiveFilter(const GroundGrid&,
+                                       std::vector<double> const&, double,
                                        double);
 
     SMRFilter& operator=(const SMRFilter&); // not implemented
@@ -48,27 +48,30 @@ std::string SortFilter::getName() const { return s_info.name; }
 
 void SortFilter::addArgs(ProgramArgs& args)
 {
-    args.add("dimension", "Dimension on which to sort", m_dimName).
-        setPositional();
+    args.add("dimension", "Dimensions on which to sort, most significant "
+        "first", m_dimNames).setPositional();
     args.add("order", "Sort order ASC(ending) or DESC(ending)", m_order, SortOrder::ASC);
+    addThreadsArg(args, "Number of threads used to sort");
 }
 
 void SortFilter::prepared(PointTableRef table)
 {
-    m_dim = table.layout()->findDim(m_dimName);
-    if (m_dim == Dimension::Id::Unknown)
-        throwError("Dimension '" + m_dimName + "' not found.");
+    if (m_dimNames.empty())
+        throwError("No dimension on which to sort.");
+
+    m_keys.clear();
+    for (auto& name : m_dimNames)
+    {
+        Dimension::Id dim = table.layout()->findDim(name);
+        if (dim == Dimension::Id::Unknown)
+            throwError("Dimension '" + name + "' not found.");
+        m_keys.emplace_back(dim, m_order == SortOrder::DESC);
+    }
 }
 
 void SortFilter::filter(PointView& view)
 {
-    auto cmp = [this](const PointIdxRef& p1, const PointIdxRef& p2)
-    {
-        bool result = p1.compare(m_dim, p2);
-        return (m_order == SortOrder::ASC) ? result : !result;
-    };
-
-    std::stable_sort(view.begin(), view.end(), cmp);
+    PointSort::sort(view, m_keys, numThreads());
 }
 
 std::istream& operator >> (std::istream& in, SortOrder& order)
@@ -35,9 +35,12 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
-#include <pdal/PointViewIter.hpp>
+#include <pdal/PointSort.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
+#include <string>
+#include <vector>
+
 extern "C" int32_t SortFilter_ExitFunc();
 extern "C" PF_ExitFunc SortFilter_InitPlugin();
 
@@ -65,10 +68,10 @@ public:
     std::string getName() const;
 
 private:
-    // Dimension on which to sort.
-    Dimension::Id m_dim;
-    // Dimension name.
-    std::string m_dimName;
+    // Dimensions on which to sort.
+    std::vector<PointSort::Key> m_keys;
+    // Dimension names.
+    std::vector<std::string> m_dimNames;
 
     // Sort order.
     SortOrder m_order;
@@ -112,6 +112,29 @@ bool TransformationFilter::processOne(PointRef& point)
 }
 
 
+void TransformationFilter::processBatch(StreamPointTable& table,
+    point_count_t count, SkipMask& skips)
+{
+    const TransformationMatrix& m(m_matrix);
+
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
+    {
+        if (skips.skipped(idx))
+            continue;
+        point.setPointId(idx);
+        double x = point.getFieldAs<double>(Dimension::Id::X);
+        double y = point.getFieldAs<double>(Dimension::Id::Y);
+        double z = point.getFieldAs<double>(Dimension::Id::Z);
+
+        point.setField(Dimension::Id::X, x * m[0] + y * m[1] + z * m[2] + m[3]);
+        point.setField(Dimension::Id::Y, x * m[4] + y * m[5] + z * m[6] + m[7]);
+        point.setField(Dimension::Id::Z,
+            x * m[8] + y * m[9] + z * m[10] + m[11]);
+    }
+}
+
+
 void TransformationFilter::filter(PointView& view)
 {
     PointRef point(view, 0);
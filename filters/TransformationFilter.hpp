@@ -72,6 +72,8 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, point_count_t count,
+        SkipMask& skips);
     virtual void filter(PointView& view);
 
     std::string m_matrixSpec;
@@ -0,0 +1,162 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "GroundTiles.hpp"
+
+#include <pdal/PointTable.hpp>
+#include <pdal/util/ThreadPool.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Integer division rounding toward negative infinity.
+int floorDiv(int a, int b)
+{
+    int q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+
+} // unnamed namespace
+
+void classifyTiles(PointViewPtr view, double cell, int tileSize, int buffer,
+    size_t numThreads, GroundClassifier classify)
+{
+    using namespace Dimension;
+
+    BOX2D bounds;
+    view->calculateBounds(bounds);
+
+    GroundGrid global;
+    global.m_originX = bounds.minx;
+    global.m_originY = bounds.miny;
+    global.m_cell = cell;
+    global.m_colOffset = 0;
+    global.m_rowOffset = 0;
+    global.m_cols = ((bounds.maxx - bounds.minx) / cell) + 1;
+    global.m_rows = ((bounds.maxy - bounds.miny) / cell) + 1;
+    global.m_threads = numThreads;
+    global.m_tile = false;
+
+    if (tileSize <= 0 ||
+        (global.m_cols <= tileSize && global.m_rows <= tileSize))
+    {
+        classify(view, global);
+        return;
+    }
+
+    // Find the points in each tile and its buffer.
+    const int tileCols = (global.m_cols + tileSize - 1) / tileSize;
+    const int tileRows = (global.m_rows + tileSize - 1) / tileSize;
+    std::vector<std::vector<PointId>> tiles(tileCols * tileRows);
+    for (PointId i = 0; i < view->size(); ++i)
+    {
+        int c = global.col(view->getFieldAs<double>(Id::X, i));
+        int r = global.row(view->getFieldAs<double>(Id::Y, i));
+        int c0 = (std::max)(0, floorDiv(c - buffer, tileSize));
+        int c1 = (std::min)(tileCols - 1, floorDiv(c + buffer, tileSize));
+        int r0 = (std::max)(0, floorDiv(r - buffer, tileSize));
+        int r1 = (std::min)(tileRows - 1, floorDiv(r + buffer, tileSize));
+        for (int tc = c0; tc <= c1; ++tc)
+            for (int tr = r0; tr <= r1; ++tr)
+                tiles[tc * tileRows + tr].push_back(i);
+    }
+
+    auto classifyTile = [&](int tc, int tr)
+    {
+        std::vector<PointId>& ids = tiles[tc * tileRows + tr];
+
+        GroundGrid grid(global);
+        grid.m_colOffset = (std::max)(0, tc * tileSize - buffer);
+        grid.m_rowOffset = (std::max)(0, tr * tileSize - buffer);
+        grid.m_cols = (std::min)(global.m_cols, (tc + 1) * tileSize + buffer) -
+            grid.m_colOffset;
+        grid.m_rows = (std::min)(global.m_rows, (tr + 1) * tileSize + buffer) -
+            grid.m_rowOffset;
+        grid.m_threads = 1;
+        grid.m_tile = true;
+        grid.m_prefix = "tile_" + Utils::toString(tc) + "_" +
+            Utils::toString(tr) + "_";
+
+        // Copy the points to a table of the tile's own so that the
+        // classifier is free to add temporary points.
+        PointTable table;
+        PointLayoutPtr layout(table.layout());
+        layout->registerDim(Id::X);
+        layout->registerDim(Id::Y);
+        layout->registerDim(Id::Z);
+        layout->registerDim(Id::Classification);
+        table.finalize();
+
+        PointViewPtr local(new PointView(table, view->spatialReference()));
+        for (PointId i = 0; i < ids.size(); ++i)
+        {
+            local->setField(Id::X, i, view->getFieldAs<double>(Id::X, ids[i]));
+            local->setField(Id::Y, i, view->getFieldAs<double>(Id::Y, ids[i]));
+            local->setField(Id::Z, i, view->getFieldAs<double>(Id::Z, ids[i]));
+            local->setField(Id::Classification, i,
+                view->getFieldAs<uint8_t>(Id::Classification, ids[i]));
+        }
+
+        classify(local, grid);
+
+        // Keep the classification of the points in the tile proper.
+        for (PointId i = 0; i < ids.size(); ++i)
+        {
+            int c = global.col(local->getFieldAs<double>(Id::X, i));
+            int r = global.row(local->getFieldAs<double>(Id::Y, i));
+            if (c / tileSize == tc && r / tileSize == tr)
+                view->setField(Id::Classification, ids[i],
+                    local->getFieldAs<uint8_t>(Id::Classification, i));
+        }
+        std::vector<PointId>().swap(ids);
+    };
+
+    ThreadPool pool(numThreads);
+    for (int tc = 0; tc < tileCols; ++tc)
+        for (int tr = 0; tr < tileRows; ++tr)
+            if (tiles[tc * tileRows + tr].size())
+                pool.add([&classifyTile, tc, tr](){ classifyTile(tc, tr); });
+    pool.join();
+}
+
+} // namespace pdal
@@ -0,0 +1,115 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/PointView.hpp>
+#include <pdal/util/Bounds.hpp>
+
+#include <cmath>
+#include <functional>
+#include <string>
+
+namespace pdal
+{
+
+// A raster over part of a global grid of square cells, as used by the
+// ground filters.  Rasters are stored in column-major order.
+struct GroundGrid
+{
+    double m_originX;    // Lower-left corner of the global grid.
+    double m_originY;
+    double m_cell;       // Cell size.
+    int m_colOffset;     // Position of the raster in the global grid.
+    int m_rowOffset;
+    int m_cols;          // Size of the raster.
+    int m_rows;
+    size_t m_threads;    // Threads available to process the raster.
+    bool m_tile;         // Whether the raster is one of several tiles
+                         // classified concurrently.
+    std::string m_prefix;  // Prefix of debugging output filenames.
+
+    // Raster column containing an X position.
+    int col(double x) const
+        { return (int)std::floor((x - m_originX) / m_cell) - m_colOffset; }
+
+    // Raster row containing a Y position.
+    int row(double y) const
+        { return (int)std::floor((y - m_originY) / m_cell) - m_rowOffset; }
+
+    // X position of the center of a raster column.
+    double x(int col) const
+        { return m_originX + (col + m_colOffset + 0.5) * m_cell; }
+
+    // Y position of the center of a raster row.
+    double y(int row) const
+        { return m_originY + (row + m_rowOffset + 0.5) * m_cell; }
+
+    // Bounds of the raster.
+    BOX2D bounds() const
+    {
+        double minx = m_originX + m_colOffset * m_cell;
+        double miny = m_originY + m_rowOffset * m_cell;
+        return BOX2D(minx, miny, minx + m_cols * m_cell,
+            miny + m_rows * m_cell);
+    }
+};
+
+// Function that classifies the points of a view using rasters laid out
+// as described by a grid.
+typedef std::function<void(PointViewPtr, const GroundGrid&)> GroundClassifier;
+
+/**
+  Classify points with a raster-based ground filter.
+
+  When tiling, the grid covering the points is split into square tiles.
+  Each tile is classified with the points in the tile and in a buffer
+  around it, and only the classification of the points inside the tile is
+  kept.  Tiles are classified concurrently, each in a point table of its
+  own.  The result doesn't depend on the number of threads.
+
+  \param view  Points to classify.  Only the Classification dimension is
+    changed.
+  \param cell  Cell size of the grid.
+  \param tileSize  Number of cells along each side of a tile.  If zero, the
+    points are classified in place as a single raster.
+  \param buffer  Number of cells added on each side of a tile.  This should
+    cover the extent of the filter's raster operations.
+  \param numThreads  Number of threads to use.
+  \param classify  Function that classifies points.
+*/
+PDAL_DLL void classifyTiles(PointViewPtr view, double cell, int tileSize,
+    int buffer, size_t numThreads, GroundClassifier classify);
+
+} // namespace pdal
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace pdal
+{
+
+// A static R-tree of axis-aligned boxes, packed with the Sort-Tile-Recursive
+// algorithm (Leutenegger, Lopez and Edgington, 1997).  Queries report the
+// index of every box that contains a point.  Once built, the tree is
+// read-only and can be queried from multiple threads.
+class EnvelopeTree
+{
+public:
+    struct Box
+    {
+        Box() : minx(std::numeric_limits<double>::max()),
+            miny(std::numeric_limits<double>::max()),
+            maxx(std::numeric_limits<double>::lowest()),
+            maxy(std::numeric_limits<double>::lowest())
+        {}
+
+        void grow(double x, double y)
+        {
+            minx = (std::min)(minx, x);
+            miny = (std::min)(miny, y);
+            maxx = (std::max)(maxx, x);
+            maxy = (std::max)(maxy, y);
+        }
+
+        void grow(const Box& b)
+        {
+            grow(b.minx, b.miny);
+            grow(b.maxx, b.maxy);
+        }
+
+        // Boxes are closed, so a point on the boundary is contained.
+        bool contains(double x, double y) const
+            { return x >= minx && x <= maxx && y >= miny && y <= maxy; }
+
+        double minx;
+        double miny;
+        double maxx;
+        double maxy;
+    };
+
+    EnvelopeTree()
+    {}
+
+    // Build the tree over a set of boxes.  Boxes are identified by their
+    // position in the vector.
+    void build(const std::vector<Box>& boxes)
+    {
+        m_levels.clear();
+        m_leaves.clear();
+        m_ids.clear();
+        if (boxes.empty())
+            return;
+
+        // The leaf level holds the boxes themselves.
+        std::vector<Node> items(boxes.size());
+        for (size_t i = 0; i < boxes.size(); ++i)
+        {
+            items[i].m_box = boxes[i];
+            items[i].m_begin = i;
+            items[i].m_end = i + 1;
+        }
+        pack(items);
+        for (const Node& n : items)
+        {
+            m_leaves.push_back(n.m_box);
+            m_ids.push_back(n.m_begin);
+        }
+
+        // Each level groups runs of the level below until a single root
+        // node remains.
+        std::vector<Node> level = group(items);
+        while (true)
+        {
+            m_levels.push_back(level);
+            if (level.size() == 1)
+                break;
+            std::vector<Node> below(level);
+            pack(below);
+            m_levels.back() = below;
+            level = group(below);
+        }
+        std::reverse(m_levels.begin(), m_levels.end());
+    }
+
+    bool empty() const
+        { return m_ids.empty(); }
+
+    // Call func(id) for each box that contains the point (x, y).
+    template<typename FUNC>
+    void query(double x, double y, FUNC func) const
+    {
+        if (empty() || !m_levels[0][0].m_box.contains(x, y))
+            return;
+
+        struct Entry
+        {
+            size_t m_level;
+            size_t m_node;
+        };
+        // Each level adds at most NodeSize entries to the stack.
+        Entry stack[NodeSize * 16];
+        size_t depth = 0;
+        stack[depth++] = Entry{0, 0};
+        while (depth)
+        {
+            Entry e = stack[--depth];
+            const Node& n = m_levels[e.m_level][e.m_node];
+            if (e.m_level + 1 == m_levels.size())
+            {
+                for (size_t i = n.m_begin; i < n.m_end; ++i)
+                    if (m_leaves[i].contains(x, y))
+                        func(m_ids[i]);
+                continue;
+            }
+            const std::vector<Node>& children = m_levels[e.m_level + 1];
+            for (size_t i = n.m_begin; i < n.m_end; ++i)
+                if (children[i].m_box.contains(x, y))
+                    stack[depth++] = Entry{e.m_level + 1, i};
+        }
+    }
+
+private:
+    static const size_t NodeSize = 16;
+
+    struct Node
+    {
+        Box m_box;
+        size_t m_begin;   // Range of children in the level below.
+        size_t m_end;
+    };
+
+    static double centerX(const Node& n)
+        { return n.m_box.minx + n.m_box.maxx; }
+    static double centerY(const Node& n)
+        { return n.m_box.miny + n.m_box.maxy; }
+
+    // Order nodes so that each run of NodeSize nodes covers a compact
+    // area: sort by X into vertical slices, then sort each slice by Y.
+    void pack(std::vector<Node>& nodes)
+    {
+        size_t numGroups = (nodes.size() + NodeSize - 1) / NodeSize;
+        size_t numSlices = (size_t)std::ceil(std::sqrt((double)numGroups));
+        size_t sliceSize = numSlices * NodeSize;
+
+        std::sort(nodes.begin(), nodes.end(),
+            [](const Node& a, const Node& b)
+            { return centerX(a) < centerX(b); });
+        for (size_t start = 0; start < nodes.size(); start += sliceSize)
+        {
+            auto end = nodes.begin() +
+                (std::min)(start + sliceSize, nodes.size());
+            std::sort(nodes.begin() + start, end,
+                [](const Node& a, const Node& b)
+                { return centerY(a) < centerY(b); });
+        }
+    }
+
+    // Create the parent nodes of runs of NodeSize nodes.
+    std::vector<Node> group(const std::vector<Node>& nodes)
+    {
+        std::vector<Node> parents;
+        for (size_t start = 0; start < nodes.size(); start += NodeSize)
+        {
+            Node p;
+            p.m_begin = start;
+            p.m_end = (std::min)(start + NodeSize, nodes.size());
+            for (size_t i = p.m_begin; i < p.m_end; ++i)
+                p.m_box.grow(nodes[i].m_box);
+            parents.push_back(p);
+        }
+        return parents;
+    }
+
+    std::vector<std::vector<Node>> m_levels;  // Root level first.
+    std::vector<Box> m_leaves;
+    std::vector<size_t> m_ids;
+};
+
+} // namespace pdal
@@ -62,6 +62,11 @@ public:
     */
     Point origin() const
         { return { m_xOrigin, m_yOrigin }; }
+    /**
+      Return the number of cells in the X and Y directions.
+    */
+    Pos size() const
+        { return { m_width, m_height }; }
     /**
       Return the cell width.
     */
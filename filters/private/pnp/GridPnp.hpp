@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory>
 #include <random>
+#include <stdexcept>
 #include <vector>
 #include <set>
 
@@ -78,6 +80,22 @@ public:
         return testCell(cell, x, y);
     }
 
+    // Compute the state of every grid cell up front.  Cells are otherwise
+    // computed by inside() as they're hit, so inside() may only be called
+    // from multiple threads after this.
+    void prepare()
+    {
+        XYIndex size = m_grid->size();
+        for (size_t y = 0; y < size.second; ++y)
+            for (size_t x = 0; x < size.first; ++x)
+            {
+                XYIndex idx(x, y);
+                Cell& cell = m_grid->cell(idx);
+                if (!cell.computed())
+                    computeCell(cell, idx);
+            }
+    }
+
 private:
     using XYIndex = std::pair<size_t, size_t>;
     using Edge = std::pair<Point, Point>;
@@ -39,38 +39,81 @@
 #include <limits>
 #include <iostream>
 #include <pdal/pdal_types.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
 
+namespace
+{
+
+bool seekSpill(std::FILE *f, int64_t pos)
+{
+#ifdef _WIN32
+    return _fseeki64(f, pos, SEEK_SET) == 0;
+#else
+    return fseeko(f, (off_t)pos, SEEK_SET) == 0;
+#endif
+}
+
+} // unnamed namespace
+
 GDALGrid::GDALGrid(size_t width, size_t height, double edgeLength,
-        double radius, int outputTypes, size_t windowSize) :
+        double radius, int outputTypes, size_t windowSize, size_t tileSize,
+        size_t numThreads, uint64_t memoryLimit) :
     m_width(width), m_height(height), m_windowSize(windowSize),
-    m_edgeLength(edgeLength), m_radius(radius), m_outputTypes(outputTypes)
+    m_edgeLength(edgeLength), m_radius(radius), m_outputTypes(outputTypes),
+    m_tileSize((int64_t)std::max(tileSize, (size_t)1)),
+    m_memoryLimit(memoryLimit), m_residentBytes(0), m_clock(0),
+    m_lastTile(nullptr), m_pendingCount(0), m_spill(nullptr),
+    m_spillSlots(0), m_colOffset(0), m_rowOffset(0)
 {
-    size_t size(width * height);
-
-    m_count.reset(new DataVec(size));
+    std::fill(m_used, m_used + bufLast, false);
+    m_used[bufCount] = true;
     if (m_outputTypes & statMin)
-        m_min.reset(new DataVec(size, std::numeric_limits<double>::max()));
+        m_used[bufMin] = true;
     if (m_outputTypes & statMax)
-        m_max.reset(new DataVec(size, std::numeric_limits<double>::lowest()));
+        m_used[bufMax] = true;
     if (m_outputTypes & statIdw)
     {
-        m_idw.reset(new DataVec(size));
-        m_idwDist.reset(new DataVec(size));
+        m_used[bufIdw] = true;
+        m_used[bufIdwDist] = true;
     }
     if ((m_outputTypes & statMean) || (m_outputTypes & statStdDev))
-        m_mean.reset(new DataVec(size));
+        m_used[bufMean] = true;
     if (m_outputTypes & statStdDev)
-        m_stdDev.reset(new DataVec(size));
+        m_used[bufStdDev] = true;
+
+    // Binned points take memory too.  Keep them to a fraction of the limit.
+    const size_t maxPending = 1 << 22;
+    m_pendingLimit = maxPending;
+    if (m_memoryLimit)
+    {
+        uint64_t limit = m_memoryLimit / 4 / sizeof(Point);
+        m_pendingLimit = (size_t)std::min(std::max(limit, (uint64_t)1024),
+            (uint64_t)maxPending);
+    }
+
+    if (numThreads > 1)
+        m_pool.reset(new ThreadPool(numThreads));
+}
+
+
+GDALGrid::~GDALGrid()
+{
+    if (m_spill)
+        std::fclose(m_spill);
 }
 
 
 /**
-  Expand the grid to a new size.
+  Expand the grid to a new size.  Existing tiles don't move -- only the
+  position of the grid relative to the tiles changes.
 
-  /param width
+  \param width  New width of the grid, in cells.
+  \param height  New height of the grid, in cells.
+  \param xshift  Number of cells added to the left of the existing grid.
+  \param yshift  Number of cells added below the existing grid.
 */
 void GDALGrid::expand(size_t width, size_t height, size_t xshift, size_t yshift)
 {
@@ -86,42 +129,13 @@ void GDALGrid::expand(size_t width, size_t height, size_t xshift, size_t yshift)
     if (width == m_width && height == m_height)
         return;
 
+    // Binned points are positioned relative to the existing grid.
+    flush();
+
     // Grid (raster) works upside down from standard X/Y.
     yshift = height - (m_height + yshift);
-    auto moveVec = [=](DataPtr& src, double initializer)
-    {
-        // Compute an index in the destination given source index coords.
-        auto dstIndex = [width, xshift, yshift](size_t i, size_t j)
-        {
-            return ((yshift + j) * width) + i + xshift;
-        };
-
-        size_t size(width * height);
-        DataPtr dst(new DataVec(size, initializer));
-        for (size_t j = 0; j < m_height; ++j)
-        {
-            size_t srcPos = index(0, j);
-            size_t dstPos = dstIndex(0, j);
-            std::copy(src->begin() + srcPos, src->begin() + srcPos + m_width,
-                dst->begin() + dstPos);
-        }
-        src = std::move(dst);
-    };
-
-    moveVec(m_count, 0);
-    if (m_outputTypes & statMin)
-        moveVec(m_min, std::numeric_limits<double>::max());
-    if (m_outputTypes & statMax)
-        moveVec(m_max, std::numeric_limits<double>::lowest());
-    if (m_outputTypes & statIdw)
-    {
-        moveVec(m_idw, 0);
-        moveVec(m_idwDist, 0);
-    }
-    if ((m_outputTypes & statMean) || (m_outputTypes & statStdDev))
-        moveVec(m_mean, 0);
-    if (m_outputTypes & statStdDev)
-        moveVec(m_stdDev, 0);
+    m_colOffset -= (int64_t)xshift;
+    m_rowOffset -= (int64_t)yshift;
     m_width = width;
     m_height = height;
 }
@@ -147,26 +161,261 @@ int GDALGrid::numBands() const
 }
 
 
-double *GDALGrid::data(const std::string& name)
+bool GDALGrid::hasBand(const std::string& name) const
+{
+    return (name == "count" && (m_outputTypes & statCount)) ||
+        (name == "min" && (m_outputTypes & statMin)) ||
+        (name == "max" && (m_outputTypes & statMax)) ||
+        (name == "mean" && (m_outputTypes & statMean)) ||
+        (name == "idw" && (m_outputTypes & statIdw)) ||
+        (name == "stdev" && (m_outputTypes & statStdDev));
+}
+
+
+GDALGrid::CellIterator GDALGrid::cells(const std::string& name)
+{
+    if (!hasBand(name))
+        throw error("Grid has no band '" + name + "'.");
+
+    int buf = bufCount;
+    if (name == "min")
+        buf = bufMin;
+    else if (name == "max")
+        buf = bufMax;
+    else if (name == "mean")
+        buf = bufMean;
+    else if (name == "idw")
+        buf = bufIdw;
+    else if (name == "stdev")
+        buf = bufStdDev;
+    return CellIterator(this, buf, 0);
+}
+
+
+uint64_t GDALGrid::tileBytes() const
+{
+    uint64_t bufs = std::count(m_used, m_used + bufLast, true);
+    return bufs * m_tileSize * m_tileSize * sizeof(double);
+}
+
+
+GDALGrid::Tile& GDALGrid::tile(int64_t tileCol, int64_t tileRow)
+{
+    if (m_lastTile && m_lastTile->m_col == tileCol * m_tileSize &&
+            m_lastTile->m_row == tileRow * m_tileSize)
+        return *m_lastTile;
+
+    std::unique_ptr<Tile>& t = m_tiles[std::make_pair(tileCol, tileRow)];
+    if (!t)
+        t.reset(new Tile(tileCol * m_tileSize, tileRow * m_tileSize));
+    m_lastTile = t.get();
+    return *t;
+}
+
+
+GDALGrid::Tile *GDALGrid::findTile(int64_t tileCol, int64_t tileRow) const
+{
+    auto it = m_tiles.find(std::make_pair(tileCol, tileRow));
+    return it == m_tiles.end() ? nullptr : it->second.get();
+}
+
+
+// Load a tile's data from the spill file or initialize it, spilling
+// other tiles if necessary to stay within the memory limit.
+void GDALGrid::makeResident(Tile& t)
+{
+    t.m_lastUse = ++m_clock;
+    if (t.m_resident)
+        return;
+
+    const uint64_t bytes = tileBytes();
+    if (m_memoryLimit)
+        while (m_residentBytes + bytes > m_memoryLimit && evictOne())
+            ;
+
+    const size_t cells = (size_t)(m_tileSize * m_tileSize);
+    for (int b = 0; b < bufLast; ++b)
+        if (m_used[b])
+            t.m_buf[b].resize(cells);
+
+    if (t.m_spillSlot >= 0)
+    {
+        if (!seekSpill(m_spill, t.m_spillSlot * (int64_t)bytes))
+            throw error("Unable to seek in raster tile spill file.");
+        for (int b = 0; b < bufLast; ++b)
+            if (m_used[b] && std::fread(t.m_buf[b].data(), sizeof(double),
+                    cells, m_spill) != cells)
+                throw error("Unable to read raster tile spill file.");
+        t.m_dirty = false;
+    }
+    else
+    {
+        if (m_used[bufMin])
+            std::fill(t.m_buf[bufMin].begin(), t.m_buf[bufMin].end(),
+                std::numeric_limits<double>::max());
+        if (m_used[bufMax])
+            std::fill(t.m_buf[bufMax].begin(), t.m_buf[bufMax].end(),
+                std::numeric_limits<double>::lowest());
+        t.m_dirty = true;
+    }
+    t.m_resident = true;
+    m_residentBytes += bytes;
+}
+
+
+// Spill the least-recently used tile that isn't pinned.
+bool GDALGrid::evictOne()
+{
+    Tile *victim = nullptr;
+    for (auto& p : m_tiles)
+    {
+        Tile *t = p.second.get();
+        if (t->m_resident && !t->m_pins &&
+                (!victim || t->m_lastUse < victim->m_lastUse))
+            victim = t;
+    }
+    if (!victim)
+        return false;
+    spill(*victim);
+    return true;
+}
+
+
+void GDALGrid::spill(Tile& t)
+{
+    const uint64_t bytes = tileBytes();
+    if (t.m_dirty)
+    {
+        if (!m_spill)
+        {
+            m_spill = std::tmpfile();
+            if (!m_spill)
+                throw error("Unable to create raster tile spill file.");
+        }
+        if (t.m_spillSlot < 0)
+            t.m_spillSlot = m_spillSlots++;
+        if (!seekSpill(m_spill, t.m_spillSlot * (int64_t)bytes))
+            throw error("Unable to seek in raster tile spill file.");
+        for (int b = 0; b < bufLast; ++b)
+            if (m_used[b] && std::fwrite(t.m_buf[b].data(), sizeof(double),
+                    t.m_buf[b].size(), m_spill) != t.m_buf[b].size())
+                throw error("Unable to write raster tile spill file.");
+    }
+    for (int b = 0; b < bufLast; ++b)
+        std::vector<double>().swap(t.m_buf[b]);
+    t.m_resident = false;
+    t.m_dirty = false;
+    m_residentBytes -= bytes;
+}
+
+
+// Run a function on each of a set of tiles.  Tiles are made resident in
+// groups that fit in the memory limit and the tiles of a group are
+// processed in parallel.
+void GDALGrid::run(const std::vector<Tile *>& tiles,
+    const std::function<void(Tile&)>& fn)
+{
+    const uint64_t bytes = tileBytes();
+
+    size_t pos = 0;
+    while (pos < tiles.size())
+    {
+        size_t end = pos + 1;
+        uint64_t groupBytes = bytes;
+        while (end < tiles.size() &&
+            (!m_memoryLimit || groupBytes + bytes <= m_memoryLimit))
+        {
+            groupBytes += bytes;
+            end++;
+        }
+
+        for (size_t i = pos; i < end; ++i)
+            tiles[i]->m_pins++;
+        for (size_t i = pos; i < end; ++i)
+            makeResident(*tiles[i]);
+
+        if (m_pool)
+        {
+            for (size_t i = pos; i < end; ++i)
+            {
+                Tile *t = tiles[i];
+                m_pool->add([&fn, t](){ fn(*t); });
+            }
+            m_pool->await();
+        }
+        else
+            for (size_t i = pos; i < end; ++i)
+                fn(*tiles[i]);
+
+        for (size_t i = pos; i < end; ++i)
+        {
+            tiles[i]->m_pins--;
+            tiles[i]->m_dirty = true;
+        }
+        pos = end;
+    }
+}
+
+
+// Apply binned points to their tiles.
+void GDALGrid::flush()
 {
-    if (name == "count" && (m_outputTypes & statCount))
-        return m_count->data();
-    if (name == "min" && (m_outputTypes & statMin))
-        return m_min->data();
-    if (name == "max" && (m_outputTypes & statMax))
-        return m_max->data();
-    if (name == "mean" && (m_outputTypes & statMean))
-        return m_mean->data();
-    if (name == "idw" && (m_outputTypes & statIdw))
-         return m_idw->data();
-    if (name == "stdev" && (m_outputTypes & statStdDev))
-        return m_stdDev->data();
-    return nullptr;
+    if (!m_pendingCount)
+        return;
+
+    std::vector<Tile *> tiles;
+    for (auto& p : m_tiles)
+        if (p.second->m_pending.size())
+            tiles.push_back(p.second.get());
+
+    run(tiles, [this](Tile& t)
+    {
+        for (const Point& p : t.m_pending)
+            applyPoint(t, p);
+        std::vector<Point>().swap(t.m_pending);
+    });
+    m_pendingCount = 0;
 }
 
 
 void GDALGrid::addPoint(double x, double y, double z)
 {
+    // Find the range of cells whose centers may be within the radius
+    // of the point and add the point to the bin of each tile that contains
+    // any of them.  The range is padded by a cell on each side to be safe.
+    double iLow = std::max(std::floor((x - m_radius) / m_edgeLength) - 1,
+        0.0);
+    double iHigh = std::min(std::floor((x + m_radius) / m_edgeLength) + 1,
+        (double)m_width - 1);
+    double jLow = std::max(std::floor(m_height -
+        (y + m_radius) / m_edgeLength) - 1, 0.0);
+    double jHigh = std::min(std::floor(m_height -
+        (y - m_radius) / m_edgeLength) + 1, (double)m_height - 1);
+    if (!(iLow <= iHigh && jLow <= jHigh))
+        return;
+
+    int64_t colFirst = tileIndex((int64_t)iLow + m_colOffset);
+    int64_t colLast = tileIndex((int64_t)iHigh + m_colOffset);
+    int64_t rowFirst = tileIndex((int64_t)jLow + m_rowOffset);
+    int64_t rowLast = tileIndex((int64_t)jHigh + m_rowOffset);
+    for (int64_t row = rowFirst; row <= rowLast; ++row)
+        for (int64_t col = colFirst; col <= colLast; ++col)
+        {
+            tile(col, row).m_pending.push_back({x, y, z});
+            m_pendingCount++;
+        }
+
+    if (m_pendingCount >= m_pendingLimit)
+        flush();
+}
+
+
+void GDALGrid::applyPoint(Tile& t, const Point& p)
+{
+    const double x = p.m_x;
+    const double y = p.m_y;
+    const double z = p.m_z;
+
     int iOrigin = horizontalIndex(x);
     int jOrigin = verticalIndex(y);
 
@@ -198,6 +447,8 @@ void GDALGrid::addPoint(double x, double y, double z)
     //       <--- | v
     //         <- v
 
+    // The walk covers the whole grid, but only cells in tile \c t are
+    // updated.  A point is walked once for each tile that it was binned to.
 
     // First quadrant;
     int i = iOrigin + 1;
@@ -207,7 +458,7 @@ void GDALGrid::addPoint(double x, double y, double z)
         double d = distance(i, j, x, y);
         if (d < m_radius)
         {
-            update(i, j, z, d);
+            update(t, i, j, z, d);
             i++;
         }
         else
@@ -227,7 +478,7 @@ void GDALGrid::addPoint(double x, double y, double z)
         double d = distance(i, j, x, y);
         if (d < m_radius)
         {
-            update(i, j, z, d);
+            update(t, i, j, z, d);
             j--;
         }
         else
@@ -247,7 +498,7 @@ void GDALGrid::addPoint(double x, double y, double z)
         double d = distance(i, j, x, y);
         if (d < m_radius)
         {
-            update(i, j, z, d);
+            update(t, i, j, z, d);
             i--;
         }
         else
@@ -266,7 +517,7 @@ void GDALGrid::addPoint(double x, double y, double z)
         double d = distance(i, j, x, y);
         if (d < m_radius)
         {
-            update(i, j, z, d);
+            update(t, i, j, z, d);
             j++;
         }
         else
@@ -283,11 +534,11 @@ void GDALGrid::addPoint(double x, double y, double z)
     double d = distance(iOrigin, jOrigin, x, y);
     if (d < m_radius &&
         iOrigin >= 0 && jOrigin >= 0 &&
-        iOrigin < (int)m_width && jOrigin <= (int)m_height)
-        update(iOrigin, jOrigin, z, d);
+        iOrigin < (int)m_width && jOrigin < (int)m_height)
+        update(t, iOrigin, jOrigin, z, d);
 }
 
-void GDALGrid::update(int i, int j, double val, double dist)
+void GDALGrid::update(Tile& t, int i, int j, double val, double dist)
 {
     // Once we determine that a point is close enough to a cell to count it,
     // this function does the actual math.  We use the value of the
@@ -299,40 +550,46 @@ void GDALGrid::update(int i, int j, double val, double dist)
     // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
     // https://en.wikipedia.org/wiki/Inverse_distance_weighting
 
-    size_t offset = index(i, j);
+    if (i < 0 || j < 0 || i >= (int)m_width || j >= (int)m_height)
+        return;
+    int64_t col = i + m_colOffset - t.m_col;
+    int64_t row = j + m_rowOffset - t.m_row;
+    if (col < 0 || row < 0 || col >= m_tileSize || row >= m_tileSize)
+        return;
+    size_t offset = (size_t)(row * m_tileSize + col);
 
-    double& count = (*m_count)[offset];
+    double& count = t.m_buf[bufCount][offset];
     count++;
 
-    if (m_min)
+    if (m_used[bufMin])
     {
-        double& min = (*m_min)[offset];
+        double& min = t.m_buf[bufMin][offset];
         min = std::min(val, min);
     }
 
-    if (m_max)
+    if (m_used[bufMax])
     {
-        double& max = (*m_max)[offset];
+        double& max = t.m_buf[bufMax][offset];
         max = std::max(val, max);
     }
 
-    if (m_mean)
+    if (m_used[bufMean])
     {
-        double& mean = (*m_mean)[offset];
+        double& mean = t.m_buf[bufMean][offset];
         double delta = val - mean;
 
         mean += delta / count;
-        if (m_stdDev)
+        if (m_used[bufStdDev])
         {
-            double& stdDev = (*m_stdDev)[offset];
+            double& stdDev = t.m_buf[bufStdDev][offset];
             stdDev += delta * (val - mean);
         }
     }
 
-    if (m_idw)
+    if (m_used[bufIdw])
     {
-        double& idw = (*m_idw)[offset];
-        double& idwDist = (*m_idwDist)[offset];
+        double& idw = t.m_buf[bufIdw][offset];
+        double& idwDist = t.m_buf[bufIdwDist][offset];
 
         // If the distance is 0, we set the idwDist to nan to signal that
         // we should ignore the distance and take the value as is.
@@ -353,111 +610,227 @@ void GDALGrid::update(int i, int j, double val, double dist)
 }
 
 void GDALGrid::finalize()
+{
+    flush();
+
+    std::vector<Tile *> tiles;
+    for (auto& p : m_tiles)
+        tiles.push_back(p.second.get());
+    run(tiles, [this](Tile& t){ finalizeTile(t); });
+
+    if (m_windowSize == 0)
+        return;
+
+    // Window filling reads cells from neighboring tiles, so it's done a row
+    // of tiles at a time with the rows in the window kept resident.
+    const int64_t ring = (m_windowSize + m_tileSize - 1) / m_tileSize;
+    const int64_t colFirst = tileIndex(m_colOffset);
+    const int64_t colLast = tileIndex(m_colOffset + m_width - 1);
+    const int64_t rowFirst = tileIndex(m_rowOffset);
+    const int64_t rowLast = tileIndex(m_rowOffset + m_height - 1);
+
+    auto hasPoints = [this](int64_t col, int64_t row)
+    {
+        Tile *t = findTile(col, row);
+        return t && t->m_hasPoints;
+    };
+
+    for (int64_t row = rowFirst; row <= rowLast; ++row)
+    {
+        // Fill tiles that are near any tile with points.  Others can only
+        // contain empty cells.
+        std::vector<Tile *> fill;
+        for (int64_t col = colFirst; col <= colLast; ++col)
+        {
+            bool near = false;
+            for (int64_t r = row - ring; !near && r <= row + ring; ++r)
+                for (int64_t c = col - ring; !near && c <= col + ring; ++c)
+                    near = hasPoints(c, r);
+            if (!near)
+                continue;
+            if (!findTile(col, row))
+                tile(col, row).m_hasPoints = false;
+            fill.push_back(findTile(col, row));
+        }
+
+        std::vector<Tile *> sources;
+        for (int64_t r = row - ring; r <= row + ring; ++r)
+            for (int64_t c = colFirst - ring; c <= colLast + ring; ++c)
+                if (hasPoints(c, r))
+                    sources.push_back(findTile(c, r));
+        for (Tile *t : sources)
+            t->m_pins++;
+        for (Tile *t : sources)
+            makeResident(*t);
+
+        run(fill, [this](Tile& t){ windowFill(t); });
+
+        for (Tile *t : sources)
+            t->m_pins--;
+    }
+}
+
+
+void GDALGrid::finalizeTile(Tile& t)
 {
     // See
     // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
     // https://en.wikipedia.org/wiki/Inverse_distance_weighting
-    if (m_stdDev)
-        for (size_t i = 0; i < m_count->size(); ++i)
-            if (!empty(i))
-                (*m_stdDev)[i] = sqrt((*m_stdDev)[i] / (*m_count)[i]);
-
-    if (m_idw)
-        for (size_t i = 0; i < m_count->size(); ++i)
-            if (!empty(i))
+    const std::vector<double>& count = t.m_buf[bufCount];
+    if (m_used[bufStdDev])
+    {
+        std::vector<double>& stdDev = t.m_buf[bufStdDev];
+        for (size_t i = 0; i < count.size(); ++i)
+            if (count[i] > 0)
+                stdDev[i] = sqrt(stdDev[i] / count[i]);
+    }
+
+    if (m_used[bufIdw])
+    {
+        std::vector<double>& idw = t.m_buf[bufIdw];
+        std::vector<double>& idwDist = t.m_buf[bufIdwDist];
+        for (size_t i = 0; i < count.size(); ++i)
+            if (count[i] > 0)
             {
-                double& distSum = (*m_idwDist)[i];
+                double& distSum = idwDist[i];
 
                 if (!std::isnan(distSum))
-                    (*m_idw)[i] /= distSum;
+                    idw[i] /= distSum;
             }
+    }
 
-    if (m_windowSize > 0)
-        windowFill();
-    else
-        for (size_t i = 0; i < m_count->size(); ++i)
-            if (empty(i))
-                fillNodata(i);
+    if (m_windowSize == 0)
+        for (size_t i = 0; i < count.size(); ++i)
+            if (count[i] <= 0)
+                fillNodata(t, i);
 }
 
 
-void GDALGrid::fillNodata(size_t i)
+void GDALGrid::fillNodata(Tile& t, size_t i)
 {
-    if (m_min)
-        (*m_min)[i] = std::numeric_limits<double>::quiet_NaN();
-    if (m_max)
-        (*m_max)[i] = std::numeric_limits<double>::quiet_NaN();
-    if (m_mean)
-        (*m_mean)[i] = std::numeric_limits<double>::quiet_NaN();
-    if (m_idw)
-        (*m_idw)[i] = std::numeric_limits<double>::quiet_NaN();
-    if (m_stdDev)
-        (*m_stdDev)[i] = std::numeric_limits<double>::quiet_NaN();
+    for (int b : { bufMin, bufMax, bufMean, bufIdw, bufStdDev })
+        if (m_used[b])
+            t.m_buf[b][i] = std::numeric_limits<double>::quiet_NaN();
 }
 
 
-void GDALGrid::windowFill(size_t dstI, size_t dstJ)
+void GDALGrid::windowFill(Tile& t)
 {
-    size_t istart = dstI > m_windowSize ? dstI - m_windowSize : (size_t)0;
-    size_t iend = std::min(width(), dstI + m_windowSize + 1);
-    size_t jstart = dstJ > m_windowSize ? dstJ - m_windowSize : (size_t)0;
-    size_t jend = std::min(height(), dstJ + m_windowSize + 1);
-
-    double distSum = 0;
-    size_t dstIdx = index(dstI, dstJ);
-
-    // Initialize to 0 (rather than numeric_limits::max/lowest) since we're
-    // going to accumulate and average.
-    if (m_min)
-        (*m_min)[dstIdx] = 0;
-    if (m_max)
-        (*m_max)[dstIdx] = 0;
-
-    for (size_t i = istart; i < iend; ++i)
-        for (size_t j = jstart; j < jend; ++j)
+    const int64_t ring = (m_windowSize + m_tileSize - 1) / m_tileSize;
+    const int64_t span = 2 * ring + 1;
+    const int64_t tileCol = tileIndex(t.m_col);
+    const int64_t tileRow = tileIndex(t.m_row);
+
+    // Tiles that may hold source cells, indexed relative to this tile.
+    // Tiles without points have no source cells.
+    std::vector<const Tile *> neighbors(span * span);
+    for (int64_t r = 0; r < span; ++r)
+        for (int64_t c = 0; c < span; ++c)
         {
-            size_t srcIdx = index(i, j);
-            if ((srcIdx == dstIdx) || empty(srcIdx))
-                continue;
-            // The ternaries just avoid underflow UB.  We're just trying to
-            // find the distance from j to dstJ or i to dstI.
-            double distance = (double)std::max(j > dstJ ? j - dstJ : dstJ - j,
-                i > dstI ? i - dstI : dstI - i);
-            windowFillCell(srcIdx, dstIdx, distance);
-            distSum += (1 / distance);
+            const Tile *n = findTile(tileCol + c - ring, tileRow + r - ring);
+            if (n && n->m_hasPoints)
+                neighbors[r * span + c] = n;
         }
 
-    // Divide summed values by the (inverse) distance sum.
-    if (distSum > 0)
+    auto neighbor = [&](size_t i, size_t j, size_t& idx) -> const Tile *
     {
-        if (m_min)
-            (*m_min)[dstIdx] /= distSum;
-        if (m_max)
-            (*m_max)[dstIdx] /= distSum;
-        if (m_mean)
-            (*m_mean)[dstIdx] /= distSum;
-        if (m_idw)
-            (*m_idw)[dstIdx] /= distSum;
-        if (m_stdDev)
-            (*m_stdDev)[dstIdx] /= distSum;
-    }
-    else
-        fillNodata(dstIdx);
+        int64_t a = (int64_t)i + m_colOffset;
+        int64_t b = (int64_t)j + m_rowOffset;
+        int64_t c = tileIndex(a) - tileCol + ring;
+        int64_t r = tileIndex(b) - tileRow + ring;
+        const Tile *n = neighbors[r * span + c];
+        if (n)
+            idx = (size_t)((b - n->m_row) * m_tileSize + (a - n->m_col));
+        return n;
+    };
+
+    const std::vector<double>& count = t.m_buf[bufCount];
+    for (int64_t row = 0; row < m_tileSize; ++row)
+        for (int64_t col = 0; col < m_tileSize; ++col)
+        {
+            size_t dstIdx = (size_t)(row * m_tileSize + col);
+            int64_t dstI = t.m_col + col - m_colOffset;
+            int64_t dstJ = t.m_row + row - m_rowOffset;
+            if (dstI < 0 || dstJ < 0 || dstI >= (int64_t)m_width ||
+                    dstJ >= (int64_t)m_height || count[dstIdx] > 0)
+                continue;
+
+            size_t di = (size_t)dstI;
+            size_t dj = (size_t)dstJ;
+            size_t istart = di > m_windowSize ? di - m_windowSize : (size_t)0;
+            size_t iend = std::min(width(), di + m_windowSize + 1);
+            size_t jstart = dj > m_windowSize ? dj - m_windowSize : (size_t)0;
+            size_t jend = std::min(height(), dj + m_windowSize + 1);
+
+            double distSum = 0;
+
+            // Initialize to 0 (rather than numeric_limits::max/lowest) since
+            // we're going to accumulate and average.
+            if (m_used[bufMin])
+                t.m_buf[bufMin][dstIdx] = 0;
+            if (m_used[bufMax])
+                t.m_buf[bufMax][dstIdx] = 0;
+
+            for (size_t i = istart; i < iend; ++i)
+                for (size_t j = jstart; j < jend; ++j)
+                {
+                    size_t srcIdx;
+                    const Tile *src = neighbor(i, j, srcIdx);
+                    if (!src || src->m_buf[bufCount][srcIdx] <= 0)
+                        continue;
+                    // The ternaries just avoid underflow UB.  We're just
+                    // trying to find the distance from j to dstJ or i to
+                    // dstI.
+                    double distance = (double)std::max(
+                        j > dj ? j - dj : dj - j, i > di ? i - di : di - i);
+                    windowFillCell(*src, srcIdx, t, dstIdx, distance);
+                    distSum += (1 / distance);
+                }
+
+            // Divide summed values by the (inverse) distance sum.
+            if (distSum > 0)
+            {
+                for (int b : { bufMin, bufMax, bufMean, bufIdw, bufStdDev })
+                    if (m_used[b])
+                        t.m_buf[b][dstIdx] /= distSum;
+            }
+            else
+                fillNodata(t, dstIdx);
+        }
 }
 
 
-void GDALGrid::windowFillCell(size_t srcIdx, size_t dstIdx, double distance)
+void GDALGrid::windowFillCell(const Tile& src, size_t srcIdx, Tile& dst,
+    size_t dstIdx, double distance)
 {
-    if (m_min)
-        (*m_min)[dstIdx] += (*m_min)[srcIdx] / distance;
-    if (m_max)
-        (*m_max)[dstIdx] += (*m_max)[srcIdx] / distance;
-    if (m_mean)
-        (*m_mean)[dstIdx] += (*m_mean)[srcIdx] / distance;
-    if (m_idw)
-        (*m_idw)[dstIdx] += (*m_idw)[srcIdx] / distance;
-    if (m_stdDev)
-        (*m_stdDev)[dstIdx] += (*m_stdDev)[srcIdx] / distance;
+    for (int b : { bufMin, bufMax, bufMean, bufIdw, bufStdDev })
+        if (m_used[b])
+            dst.m_buf[b][dstIdx] += src.m_buf[b][srcIdx] / distance;
+}
+
+
+// Return the value of a band at position \c pos (row-major) of the grid.
+// \c t caches the most recently used tile.
+double GDALGrid::value(int buf, size_t pos, Tile *& t)
+{
+    size_t i = pos % m_width;
+    size_t j = pos / m_width;
+    if (j >= m_height)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    int64_t a = (int64_t)i + m_colOffset;
+    int64_t b = (int64_t)j + m_rowOffset;
+    if (!t || !t->m_resident || a < t->m_col || b < t->m_row ||
+        a >= t->m_col + m_tileSize || b >= t->m_row + m_tileSize)
+    {
+        t = findTile(tileIndex(a), tileIndex(b));
+        if (!t)
+            return buf == bufCount ? 0 :
+                std::numeric_limits<double>::quiet_NaN();
+        makeResident(*t);
+    }
+    return t->m_buf[buf][(size_t)((b - t->m_row) * m_tileSize +
+        (a - t->m_col))];
 }
 
 } //namespace pdal
@@ -33,6 +33,11 @@
 ****************************************************************************/
 
 #include <math.h>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -41,6 +46,17 @@
 namespace pdal
 {
 
+class ThreadPool;
+
+/**
+  Raster grid that accumulates point statistics into cells.
+
+  Cells are stored in square tiles that are allocated only when a point
+  affects them.  Points are binned to the tiles they affect and applied a
+  batch at a time, one tile per thread.  When a memory limit is set, tiles
+  that haven't been used recently are written to a temporary file and
+  reloaded when needed.
+*/
 class GDALGrid
 {
 public:
@@ -57,16 +73,131 @@ public:
         {}
     };
 
+private:
+    // Buffers stored for each tile.  Not all are allocated for every set
+    // of output types.
+    enum
+    {
+        bufCount,
+        bufMin,
+        bufMax,
+        bufMean,
+        bufStdDev,
+        bufIdw,
+        bufIdwDist,
+        bufLast
+    };
+
+    struct Point
+    {
+        double m_x;
+        double m_y;
+        double m_z;
+    };
+
+    struct Tile
+    {
+        Tile(int64_t col, int64_t row) : m_col(col), m_row(row),
+            m_resident(false), m_dirty(false), m_hasPoints(true),
+            m_pins(0), m_spillSlot(-1), m_lastUse(0)
+        {}
+
+        int64_t m_col;         // Absolute column of the first tile cell.
+        int64_t m_row;         // Absolute row of the first tile cell.
+        bool m_resident;
+        bool m_dirty;          // Data has changed since last spilled.
+        bool m_hasPoints;      // Created to hold points (not by a fill).
+        int m_pins;            // May not be spilled when nonzero.
+        int64_t m_spillSlot;   // Position in the spill file, or -1.
+        uint64_t m_lastUse;
+        std::vector<double> m_buf[bufLast];
+        std::vector<Point> m_pending;
+    };
+    typedef std::map<std::pair<int64_t, int64_t>, std::unique_ptr<Tile>>
+        TileMap;
+
+public:
+    /**
+      Forward iterator over the values of a band in row-major order
+      suitable for gdal::Raster::writeBand().  Positions past the end of
+      the grid have no data.
+    */
+    class CellIterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef double value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const double *pointer;
+        typedef double reference;
+
+        CellIterator(GDALGrid *grid, int buf, size_t pos) :
+            m_grid(grid), m_buf(buf), m_pos(pos), m_tile(nullptr)
+        {}
+
+        double operator*() const
+            { return m_grid->value(m_buf, m_pos, m_tile); }
+        CellIterator& operator++()
+        {
+            m_pos++;
+            return *this;
+        }
+        CellIterator operator++(int)
+        {
+            CellIterator it(*this);
+            m_pos++;
+            return it;
+        }
+        CellIterator operator+(difference_type n) const
+        {
+            CellIterator it(*this);
+            it.m_pos += n;
+            return it;
+        }
+        bool operator==(const CellIterator& other) const
+            { return m_pos == other.m_pos; }
+        bool operator!=(const CellIterator& other) const
+            { return m_pos != other.m_pos; }
+
+    private:
+        GDALGrid *m_grid;
+        int m_buf;
+        size_t m_pos;
+        mutable Tile *m_tile;
+    };
+
+    /**
+      Create a grid.
+
+      \param width  Width of the grid in cells.
+      \param height  Height of the grid in cells.
+      \param edgeLength  Length of a cell edge.
+      \param radius  Distance from a cell center within which points
+        affect the cell.
+      \param outputTypes  Bitwise OR of the statistics to compute.
+      \param windowSize  Cell distance used to fill empty cells.  Zero
+        disables filling.
+      \param tileSize  Number of cells along the edge of a tile.
+      \param numThreads  Number of threads used to process tiles.
+      \param memoryLimit  Approximate maximum number of bytes used by
+        resident tiles.  Zero means no limit.
+    */
     GDALGrid(size_t width, size_t height, double edgeLength, double radius,
-        int outputTypes, size_t windowSize);
+        int outputTypes, size_t windowSize, size_t tileSize = 256,
+        size_t numThreads = 1, uint64_t memoryLimit = 0);
+    ~GDALGrid();
 
     void expand(size_t width, size_t height, size_t xshift, size_t yshift);
 
     // Get the number of bands represented by this grid.
     int numBands() const;
 
-    // Return a pointer to the data in a raster band, row-major ordered.
-    double *data(const std::string& name);
+    // Determine if the grid has the band \c name.
+    bool hasBand(const std::string& name) const;
+
+    // Return an iterator to the start of a raster band.  The band must
+    // exist.
+    CellIterator cells(const std::string& name);
 
     // Add a point to the raster grid.
     void addPoint(double x, double y, double z);
@@ -80,36 +211,35 @@ public:
     size_t height() const
         { return m_height; }
 
+    // Number of tiles that have been written to the spill file.
+    size_t spilledTiles() const
+        { return (size_t)m_spillSlots; }
+
 private:
     size_t m_width;
     size_t m_height;
     size_t m_windowSize;
     double m_edgeLength;
     double m_radius;
-
-    typedef std::vector<double> DataVec;
-    typedef std::unique_ptr<DataVec> DataPtr;
-    DataPtr m_count;
-    DataPtr m_min;
-    DataPtr m_max;
-    DataPtr m_mean;
-    DataPtr m_stdDev;
-    DataPtr m_idw;
-    DataPtr m_idwDist;
-
     int m_outputTypes;
 
-    // Find an index into the actual storage given a grid coordinate.
-    size_t index(size_t i, size_t j)
-        { return (j * m_width) + i; }
+    int64_t m_tileSize;
+    uint64_t m_memoryLimit;
+    uint64_t m_residentBytes;
+    uint64_t m_clock;
+    bool m_used[bufLast];
+    TileMap m_tiles;
+    Tile *m_lastTile;
+    size_t m_pendingCount;
+    size_t m_pendingLimit;
+    std::FILE *m_spill;
+    int64_t m_spillSlots;
+    std::unique_ptr<ThreadPool> m_pool;
 
-    // Determine if a cell i, j has no associated points.
-    bool empty(size_t i, size_t j)
-        { return empty(index(i, j)); }
-
-    // Determine if a cell with index \c idx has no associated points.
-    bool empty(size_t idx)
-        { return ((*m_count)[idx] <= 0); }
+    // Absolute position of cell 0, 0.  Tiles are placed in absolute
+    // positions so that expanding the grid never moves data.
+    int64_t m_colOffset;
+    int64_t m_rowOffset;
 
     // Convert an absolute X position to a horizontal cell index.
     int horizontalIndex(double x)
@@ -138,29 +268,46 @@ private:
         return sqrt(pow(x1 - x, 2) + pow(y1 - y, 2));
     }
 
-    // Update cell at i, j with value at a distance.
-    void update(int i, int j, double val, double dist);
-
-    // Fill cell at index \c i with the nondata value.
-    void fillNodata(size_t i);
-
-    // Fill an empty cell with a value inverse-distance averaged from
-    // surrounding cells.
-    void windowFill()
+    // Return the index of the tile containing absolute cell position \c p.
+    int64_t tileIndex(int64_t p) const
     {
-        for (size_t i = 0; i < width(); ++i)
-            for (size_t j = 0; j < height(); ++j)
-                if (empty(i, j))
-                    windowFill(i, j);
+        return p >= 0 ? p / m_tileSize :
+            -((m_tileSize - 1 - p) / m_tileSize);
     }
 
-    // Fill empty cell at dstI, dstJ with inverse-distance weighted values
-    // from neighboring cells.
-    void windowFill(size_t dstI, size_t dstJ);
+    // Size of the data of a tile, in bytes.
+    uint64_t tileBytes() const;
+
+    Tile& tile(int64_t tileCol, int64_t tileRow);
+    Tile *findTile(int64_t tileCol, int64_t tileRow) const;
+    void makeResident(Tile& t);
+    bool evictOne();
+    void spill(Tile& t);
+    void run(const std::vector<Tile *>& tiles,
+        const std::function<void(Tile&)>& fn);
+    void flush();
+    double value(int buf, size_t pos, Tile *& t);
+
+    // Apply a point to those cells of a tile that it affects.
+    void applyPoint(Tile& t, const Point& p);
+
+    // Update cell at i, j with value at a distance if it's in tile \c t.
+    void update(Tile& t, int i, int j, double val, double dist);
+
+    // Compute final statistics for the cells of a tile.
+    void finalizeTile(Tile& t);
+
+    // Fill cell at index \c i of a tile with the nondata value.
+    void fillNodata(Tile& t, size_t i);
+
+    // Fill the empty cells of a tile with values inverse-distance averaged
+    // from surrounding cells.
+    void windowFill(Tile& t);
 
     // Cumulate data from a source cell to a destination cell when doing
     // a window fill.
-    void windowFillCell(size_t srcIdx, size_t dstIdx, double distance);
+    void windowFillCell(const Tile& src, size_t srcIdx, Tile& dst,
+        size_t dstIdx, double distance);
 };
 typedef std::unique_ptr<GDALGrid> GDALGridPtr;
 
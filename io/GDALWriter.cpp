@@ -77,6 +77,12 @@ void GDALWriter::addArgs(ProgramArgs& args)
     args.add("dimension", "Dimension to use", m_interpDimString, "Z");
     args.add("bounds", "Bounds of data.  Required in streaming mode.",
         m_bounds);
+    args.add("tile_size", "Edge length, in cells, of the tiles into which "
+        "the raster is divided for processing", m_tileSize, (size_t)256);
+    args.add("memory_budget", "Approximate maximum memory, in megabytes, "
+        "used by raster tiles before they're spilled to a temporary file",
+        m_memoryBudget, (uint64_t)1024);
+    addThreadsArg(args, "Number of threads used to process raster tiles");
 }
 
 
@@ -105,6 +111,8 @@ void GDALWriter::initialize()
         else
             throwError("Invalid output type: '" + ts + "'.");
     }
+    if (m_tileSize == 0)
+        throwError("Option 'tile_size' must be greater than 0.");
 
     gdal::registerDrivers();
 }
@@ -144,7 +152,8 @@ void GDALWriter::createGrid(BOX2D bounds)
     size_t width = ((m_curBounds.maxx - m_curBounds.minx) / m_edgeLength) + 1;
     size_t height = ((m_curBounds.maxy - m_curBounds.miny) / m_edgeLength) + 1;
     m_grid.reset(new GDALGrid(width, height, m_edgeLength, m_radius,
-        m_outputTypes, m_windowSize));
+        m_outputTypes, m_windowSize, m_tileSize, numThreads(),
+        m_memoryBudget * 1024 * 1024));
 }
 
 
@@ -220,7 +229,14 @@ void GDALWriter::doneFile()
     pixelToPos[5] = -m_edgeLength;
     gdal::Raster raster(m_outputFilename, m_drivername, m_srs, pixelToPos);
 
-    m_grid->finalize();
+    try
+    {
+        m_grid->finalize();
+    }
+    catch (const GDALGrid::error& err)
+    {
+        throwError(err.what());
+    }
 
     gdal::GDALError err = raster.open(m_grid->width(), m_grid->height(),
         m_grid->numBands(), m_dataType, m_noData, m_options);
@@ -229,27 +245,21 @@ void GDALWriter::doneFile()
         throwError(raster.errorMsg());
     int bandNum = 1;
 
-    // Perhaps the grid should return an iterator, which would work as well.
-    double *src;
-    src = m_grid->data("min");
+    // The grid is read a GDAL block at a time through a cell iterator so
+    // that the whole raster is never in memory.
     double srcNoData = std::numeric_limits<double>::quiet_NaN();
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "min");
-    src = m_grid->data("max");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "max");
-    src = m_grid->data("mean");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "mean");
-    src = m_grid->data("idw");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "idw");
-    src = m_grid->data("count");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "count");
-    src = m_grid->data("stdev");
-    if (src && err == gdal::GDALError::None)
-        err = raster.writeBand(src, srcNoData, bandNum++, "stdev");
+    try
+    {
+        for (const std::string name :
+            { "min", "max", "mean", "idw", "count", "stdev" })
+            if (m_grid->hasBand(name) && err == gdal::GDALError::None)
+                err = raster.writeBand(m_grid->cells(name), srcNoData,
+                    bandNum++, name);
+    }
+    catch (const GDALGrid::error& e)
+    {
+        throwError(e.what());
+    }
     if (err != gdal::GDALError::None)
         throwError(raster.errorMsg());
 
@@ -87,6 +87,8 @@ private:
     Dimension::Id m_interpDim;
     std::string m_interpDimString;
     Dimension::Type m_dataType;
+    size_t m_tileSize;
+    uint64_t m_memoryBudget;
 };
 
 }
@@ -36,6 +36,8 @@
 
 #include "LasReader.hpp"
 
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
 #include <string.h>
 
@@ -46,6 +48,7 @@
 #include <pdal/util/Extractor.hpp>
 #include <pdal/util/IStream.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "GeotiffSupport.hpp"
 #include "LasHeader.hpp"
@@ -63,9 +66,17 @@ struct invalid_stream : public std::runtime_error
         {}
 };
 
+template<typename T>
+void put(char *point, std::size_t offset, T val)
+{
+    memcpy(point + offset, &val, sizeof(T));
+}
+
 } // unnamed namespace
 
-LasReader::LasReader() : m_decompressor(nullptr), m_index(0)
+LasReader::LasReader() : m_decompressor(nullptr), m_index(0),
+    m_numPoints(0), m_start(0), m_pointData(nullptr),
+    m_mappedPoints(0), m_decoder(nullptr)
 {}
 
 
@@ -74,6 +85,7 @@ LasReader::~LasReader()
 #ifdef PDAL_HAVE_LAZPERF
     delete m_decompressor;
 #endif
+    FileUtils::unmapFile(m_map);
 }
 
 
@@ -84,6 +96,8 @@ void LasReader::addArgs(ProgramArgs& args)
         m_extraDimSpec);
     args.add("compression", "Decompressor to use", m_compression, "EITHER");
     args.add("ignore_vlr", "VLR userid/recordid to ignore", m_ignoreVLROption);
+    addThreadsArg(args, "Number of threads used to decompress LAZ data");
+    args.add("start", "Index of the first point to read", m_start);
 }
 
 
@@ -191,6 +205,7 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
     {
         throwError(e.what());
     }
+    m_numPoints = m_header.pointCount();
 
     for (auto i: m_ignoreVLRs)
     {
@@ -222,12 +237,22 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
 
 
 void LasReader::handleLaszip(int result)
+{
+    handleLaszip(m_laszip, result);
+}
+
+
+void LasReader::handleLaszip(laszip_POINTER laszip, int result)
 {
 #ifdef PDAL_HAVE_LASZIP
     if (result)
     {
-        char *buf;
-        laszip_get_error(m_laszip, &buf);
+        // A handle that couldn't be created has no message.
+        char *buf = nullptr;
+        if (laszip)
+            laszip_get_error(laszip, &buf);
+        if (!buf)
+            throwError("LASzip error " + Utils::toString(result) + ".");
         throwError(buf);
     }
 #endif
@@ -239,7 +264,25 @@ void LasReader::ready(PointTableRef table)
     createStream();
     std::istream *stream(m_streamIf->m_istream);
 
-    m_index = 0;
+    // An uncompressed file may hold fewer points than its header claims.
+    // Only the points in the file are read.
+    m_numPoints = m_header.pointCount();
+    if (!m_header.compressed() && FileUtils::fileExists(m_filename))
+    {
+        const uintmax_t fileLen = FileUtils::fileSize(m_filename);
+        const uint64_t pos = dataOffset() + m_header.pointOffset();
+        const point_count_t available = (fileLen > pos) ?
+            (point_count_t)((fileLen - pos) / m_header.pointLen()) : 0;
+        if (available < m_numPoints)
+        {
+            log()->get(LogLevel::Warning) << "Header of '" << m_filename <<
+                "' claims " << m_numPoints << " points, but the file "
+                "holds only " << available << "." << std::endl;
+            m_numPoints = available;
+        }
+    }
+
+    m_index = (std::min)(m_start, getNumPoints());
     if (m_header.compressed())
     {
 #ifdef PDAL_HAVE_LASZIP
@@ -251,6 +294,8 @@ void LasReader::ready(PointTableRef table)
             handleLaszip(laszip_open_reader_stream(m_laszip, *stream,
                 &compressed));
             handleLaszip(laszip_get_point_pointer(m_laszip, &m_laszipPoint));
+            if (m_index)
+                handleLaszip(laszip_seek_point(m_laszip, m_index));
         }
 #endif
 
@@ -259,10 +304,35 @@ void LasReader::ready(PointTableRef table)
         {
             const LasVLR *vlr = m_header.findVlr(LASZIP_USER_ID,
                 LASZIP_RECORD_ID);
+
+            // Start at the chunk containing the first point to read and
+            // skip the points that precede it in the chunk.
+            std::streamoff chunkOffset = 0;
+            point_count_t skip = m_index;
+            const point_count_t pointsPerChunk = chunkSize();
+            // If the chunk table can't be used, the points are skipped
+            // from the start of the data.
+            if (m_index && pointsPerChunk)
+            {
+                std::vector<std::streamoff> chunkOffsets =
+                    LazPerfVlrDecompressor::chunkOffsets(*stream,
+                        m_header.pointOffset(),
+                        (getNumPoints() + pointsPerChunk - 1) /
+                            pointsPerChunk);
+                const point_count_t chunk = m_index / pointsPerChunk;
+                if (chunk < chunkOffsets.size())
+                {
+                    chunkOffset = chunkOffsets[chunk];
+                    skip -= chunk * pointsPerChunk;
+                }
+            }
+
             delete m_decompressor;
             m_decompressor = new LazPerfVlrDecompressor(*stream,
-                vlr->data(), m_header.pointOffset());
+                vlr->data(), m_header.pointOffset(), chunkOffset);
             m_decompressorBuf.resize(m_decompressor->pointSize());
+            while (skip--)
+                m_decompressor->decompress(m_decompressorBuf.data());
         }
 #endif
 
@@ -272,7 +342,204 @@ void LasReader::ready(PointTableRef table)
 #endif
     }
     else
-        stream->seekg(m_header.pointOffset());
+    {
+        mapPoints();
+        if (m_pointData && table.supportsPointAccess())
+            selectDecoder(*table.layout());
+        else
+            m_decoder = nullptr;
+        if (!m_pointData)
+            stream->seekg(m_header.pointOffset() +
+                (std::streamoff)m_index * m_header.pointLen());
+    }
+}
+
+
+// Map the point data so that points can be decoded where they lie in the
+// file.  If the file can't be mapped, points are read from the stream.
+// Any map left from a previous read is released first.
+void LasReader::mapPoints()
+{
+    m_map = FileUtils::unmapFile(m_map);
+    m_pointData = nullptr;
+    m_mappedPoints = 0;
+
+    const uint64_t pos = dataOffset() + m_header.pointOffset();
+    const uint64_t pointLen = m_header.pointLen();
+    if (!FileUtils::fileExists(m_filename))
+        return;
+    const uintmax_t fileLen = FileUtils::fileSize(m_filename);
+    if (pos >= fileLen)
+        return;
+
+    uintmax_t size = (std::min)((uintmax_t)(fileLen - pos),
+        (uintmax_t)(getNumPoints() * pointLen));
+    m_map = FileUtils::mapFile(m_filename, true, pos, size);
+    if (!m_map.addr())
+    {
+        log()->get(LogLevel::Debug) << "Unable to map point data: " <<
+            m_map.what() << "  Reading from stream." << std::endl;
+        return;
+    }
+    m_pointData = (const char *)m_map.addr();
+    m_mappedPoints = size / pointLen;
+}
+
+
+// Choose the decoder for the point format and find where it should store
+// each dimension.  Decoders store values directly, so they can only be used
+// when each dimension has the type registered in addDimensions().
+void LasReader::selectDecoder(const PointLayout& layout)
+{
+    using namespace Dimension;
+
+    m_decoder = nullptr;
+
+    struct Field
+    {
+        Id id;
+        Type type;
+        std::size_t& offset;
+        bool used;
+    };
+
+    DimOffsets& o = m_offsets;
+    const bool v14 = m_header.has14Format();
+    Field fields[] = {
+        { Id::X, Type::Double, o.x, true },
+        { Id::Y, Type::Double, o.y, true },
+        { Id::Z, Type::Double, o.z, true },
+        { Id::Intensity, Type::Unsigned16, o.intensity, true },
+        { Id::ReturnNumber, Type::Unsigned8, o.returnNumber, true },
+        { Id::NumberOfReturns, Type::Unsigned8, o.numberOfReturns, true },
+        { Id::ScanDirectionFlag, Type::Unsigned8, o.scanDirectionFlag, true },
+        { Id::EdgeOfFlightLine, Type::Unsigned8, o.edgeOfFlightLine, true },
+        { Id::Classification, Type::Unsigned8, o.classification, true },
+        { Id::ScanAngleRank, Type::Float, o.scanAngleRank, true },
+        { Id::UserData, Type::Unsigned8, o.userData, true },
+        { Id::PointSourceId, Type::Unsigned16, o.pointSourceId, true },
+        { Id::GpsTime, Type::Double, o.gpsTime, m_header.hasTime() },
+        { Id::Red, Type::Unsigned16, o.red, m_header.hasColor() },
+        { Id::Green, Type::Unsigned16, o.green, m_header.hasColor() },
+        { Id::Blue, Type::Unsigned16, o.blue, m_header.hasColor() },
+        { Id::Infrared, Type::Unsigned16, o.infrared, m_header.hasInfrared() },
+        { Id::ScanChannel, Type::Unsigned8, o.scanChannel, v14 },
+        { Id::ClassFlags, Type::Unsigned8, o.classFlags, v14 }
+    };
+
+    for (Field& f : fields)
+    {
+        if (!f.used)
+            continue;
+        if (!layout.hasDim(f.id) || layout.dimType(f.id) != f.type)
+            return;
+        f.offset = layout.dimOffset(f.id);
+    }
+
+    switch (m_header.pointFormat())
+    {
+    case 0:
+        m_decoder = &LasReader::decodePoint<false, false, false, false>;
+        break;
+    case 1:
+    case 4:
+        m_decoder = &LasReader::decodePoint<false, true, false, false>;
+        break;
+    case 2:
+        m_decoder = &LasReader::decodePoint<false, false, true, false>;
+        break;
+    case 3:
+    case 5:
+        m_decoder = &LasReader::decodePoint<false, true, true, false>;
+        break;
+    case 6:
+    case 9:
+        m_decoder = &LasReader::decodePoint<true, true, false, false>;
+        break;
+    case 7:
+        m_decoder = &LasReader::decodePoint<true, true, true, false>;
+        break;
+    case 8:
+    case 10:
+        m_decoder = &LasReader::decodePoint<true, true, true, true>;
+        break;
+    }
+}
+
+
+// Decode a point of a format known at compile time into the storage of
+// a point.
+template<bool V14, bool Time, bool Color, bool Infrared>
+void LasReader::decodePoint(const char *buf, char *point) const
+{
+    const LasHeader& h = m_header;
+    const DimOffsets& o = m_offsets;
+    LeExtractor in(buf, h.pointLen());
+
+    int32_t xi, yi, zi;
+    uint16_t intensity;
+    in >> xi >> yi >> zi >> intensity;
+
+    put<double>(point, o.x, xi * h.scaleX() + h.offsetX());
+    put<double>(point, o.y, yi * h.scaleY() + h.offsetY());
+    put<double>(point, o.z, zi * h.scaleZ() + h.offsetZ());
+    put(point, o.intensity, intensity);
+
+    uint8_t flags;
+    uint8_t classification;
+    uint8_t user;
+    uint16_t pointSourceId;
+    if (V14)
+    {
+        uint8_t returnInfo;
+        int16_t scanAngle;
+        in >> returnInfo >> flags >> classification >> user >> scanAngle >>
+            pointSourceId;
+
+        put<uint8_t>(point, o.returnNumber, returnInfo & 0x0F);
+        put<uint8_t>(point, o.numberOfReturns, (returnInfo >> 4) & 0x0F);
+        put<uint8_t>(point, o.classFlags, flags & 0x0F);
+        put<uint8_t>(point, o.scanChannel, (flags >> 4) & 0x03);
+        put<float>(point, o.scanAngleRank, (float)(scanAngle * .006));
+    }
+    else
+    {
+        int8_t scanAngleRank;
+        in >> flags >> classification >> scanAngleRank >> user >>
+            pointSourceId;
+
+        put<uint8_t>(point, o.returnNumber, flags & 0x07);
+        put<uint8_t>(point, o.numberOfReturns, (flags >> 3) & 0x07);
+        put<float>(point, o.scanAngleRank, scanAngleRank);
+    }
+    put<uint8_t>(point, o.scanDirectionFlag, (flags >> 6) & 0x01);
+    put<uint8_t>(point, o.edgeOfFlightLine, (flags >> 7) & 0x01);
+    put(point, o.classification, classification);
+    put(point, o.userData, user);
+    put(point, o.pointSourceId, pointSourceId);
+
+    if (Time)
+    {
+        double time;
+        in >> time;
+        put(point, o.gpsTime, time);
+    }
+
+    if (Color)
+    {
+        uint16_t red, green, blue;
+        in >> red >> green >> blue;
+        put(point, o.red, red);
+        put(point, o.green, green);
+        put(point, o.blue, blue);
+    }
+
+    if (Infrared)
+    {
+        uint16_t nearInfraRed;
+        in >> nearInfraRed;
+        put(point, o.infrared, nearInfraRed);
+    }
 }
 
 
@@ -574,6 +841,12 @@ bool LasReader::processOne(PointRef& point)
             "LAZperf decompression library.");
 #endif
     } // compression
+    else if (m_pointData)
+    {
+        if (m_index >= m_mappedPoints)
+            return false;
+        loadPoint(point, m_pointData + m_index * pointLen, pointLen);
+    }
     else
     {
         std::vector<char> buf(m_header.pointLen());
@@ -595,12 +868,21 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
     if (m_header.compressed())
     {
 #if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
-        if (m_compression == "LASZIP" || m_compression == "LAZPERF")
+        // Chunks can only be decompressed independently when they all
+        // have the same number of points.  The parallel read always runs
+        // to the end of the data, so that the serial decompressor never
+        // needs to be repositioned.
+        std::size_t threadCount = numThreads();
+        std::vector<std::streamoff> chunkOffsets;
+        if (threadCount > 1 && chunkSize() &&
+            count == getNumPoints() - m_index && findChunks(chunkOffsets))
+            i = readThreaded(view, count, threadCount, chunkOffsets);
+        else if (m_compression == "LASZIP" || m_compression == "LAZPERF")
         {
             for (i = 0; i < count; i++)
             {
-                PointRef point = view->point(i);
                 PointId id = view->size();
+                PointRef point = view->point(id);
                 processOne(point);
                 if (m_cb)
                     m_cb(*view, id);
@@ -611,6 +893,37 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
             "LAZperf decompression library.");
 #endif
     }
+    else if (m_pointData)
+    {
+        count = (std::min)(count, m_mappedPoints > m_index ?
+            m_mappedPoints - m_index : 0);
+
+        // Extra bytes follow the fields of the point format.
+        const size_t baseLen = m_header.basePointLen();
+        const char *pos = m_pointData + m_index * pointLen;
+        for (i = 0; i < count; i++)
+        {
+            PointId id = view->size();
+            if (m_decoder)
+            {
+                (this->*m_decoder)(pos, view->getOrAddPoint(id));
+                if (m_extraDims.size())
+                {
+                    PointRef point(*view, id);
+                    LeExtractor in(pos + baseLen, pointLen - baseLen);
+                    loadExtraDims(in, point);
+                }
+            }
+            else
+            {
+                PointRef point(*view, id);
+                loadPoint(point, pos, pointLen);
+            }
+            if (m_cb)
+                m_cb(*view, id);
+            pos += pointLen;
+        }
+    }
     else
     {
         point_count_t remaining = count;
@@ -648,6 +961,207 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
 }
 
 
+// Return the number of points in each LAZ chunk, or zero if the chunk size
+// is variable or unknown.
+point_count_t LasReader::chunkSize() const
+{
+    const LasVLR *vlr = m_header.findVlr(LASZIP_USER_ID, LASZIP_RECORD_ID);
+    if (!vlr || vlr->dataLen() < 16)
+        return 0;
+
+    // The chunk size follows the compressor, coder, version and options.
+    LeExtractor in(vlr->data() + 12, sizeof(uint32_t));
+    uint32_t chunkSize;
+    in >> chunkSize;
+    if (chunkSize == (std::numeric_limits<uint32_t>::max)())
+        return 0;
+    return chunkSize;
+}
+
+
+// Find the stream position of each chunk for a parallel read.  LASzip
+// positions itself, so no offsets are needed.  LAZperf chunks are found
+// from the chunk table.
+// \return  Whether the chunks can be decompressed in parallel.
+bool LasReader::findChunks(std::vector<std::streamoff>& chunkOffsets)
+{
+    chunkOffsets.clear();
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_compression == "LAZPERF")
+    {
+        const point_count_t pointsPerChunk = chunkSize();
+        const point_count_t numChunks =
+            (getNumPoints() + pointsPerChunk - 1) / pointsPerChunk;
+        std::unique_ptr<LasStreamIf> streamIf(openStream());
+        chunkOffsets = LazPerfVlrDecompressor::chunkOffsets(
+            *streamIf->m_istream, m_header.pointOffset(), numChunks);
+        if (chunkOffsets.size() != numChunks)
+        {
+            log()->get(LogLevel::Debug) << "Unable to read the LAZ chunk "
+                "table.  Decompressing points serially." << std::endl;
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+
+// Decompress the remaining points by chunk on a pool of threads.  Each
+// task reads from its own stream and fills points that were added to the
+// view beforehand, so the point order matches that of a serial read.
+// The callback is run for the points of each chunk, in point order, on
+// the calling thread as soon as the chunk and those before it are done.
+point_count_t LasReader::readThreaded(PointViewPtr view, point_count_t count,
+    std::size_t numThreads, const std::vector<std::streamoff>& chunkOffsets)
+{
+    const point_count_t pointsPerChunk = chunkSize();
+    const point_count_t end = m_index + count;
+
+    const PointId first = view->size();
+    for (PointId id = first; id < first + count; ++id)
+        view->setField(Dimension::Id::X, id, 0.0);
+
+    // Point ID past the last point of each task's range, and whether the
+    // task has finished.
+    std::vector<PointId> taskEnds;
+    std::vector<bool> finished;
+    std::mutex mutex;
+    std::condition_variable finishedCv;
+    bool failed = false;
+
+    point_count_t begin = m_index;
+    while (begin < end)
+    {
+        const point_count_t chunkEnd = (std::min)(
+            (begin / pointsPerChunk + 1) * pointsPerChunk, end);
+        taskEnds.push_back(first + (chunkEnd - m_index));
+        begin = chunkEnd;
+    }
+    finished.resize(taskEnds.size());
+
+    ThreadPool pool(numThreads);
+    begin = m_index;
+    for (std::size_t task = 0; task < taskEnds.size(); ++task)
+    {
+        const point_count_t chunk = begin / pointsPerChunk;
+        const point_count_t chunkStart = chunk * pointsPerChunk;
+        const point_count_t chunkEnd = m_index + (taskEnds[task] - first);
+        const std::streamoff chunkOffset =
+            chunk < chunkOffsets.size() ? chunkOffsets[chunk] : 0;
+        const PointId id = first + (begin - m_index);
+
+        PointView *v = view.get();
+        pool.add([this, v, id, chunkStart, begin, chunkEnd, chunkOffset,
+            task, &finished, &failed, &mutex, &finishedCv]()
+        {
+            try
+            {
+                readChunk(*v, id, chunkStart, begin, chunkEnd, chunkOffset);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                failed = true;
+                finishedCv.notify_all();
+                throw;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            finished[task] = true;
+            finishedCv.notify_all();
+        });
+        begin = chunkEnd;
+    }
+
+    if (m_cb)
+    {
+        PointId id = first;
+        for (std::size_t task = 0; task < taskEnds.size(); ++task)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                finishedCv.wait(lock,
+                    [&finished, &failed, task]()
+                    { return finished[task] || failed; });
+                if (failed)
+                    break;
+            }
+            for (; id < taskEnds[task]; ++id)
+                m_cb(*view, id);
+        }
+    }
+    pool.join();
+    return count;
+}
+
+
+// Decompress the points in the range [begin, end) of the chunk that starts
+// at point 'chunkStart' into the view, starting at point 'id'.
+void LasReader::readChunk(PointView& view, PointId id,
+    point_count_t chunkStart, point_count_t begin, point_count_t end,
+    std::streamoff chunkOffset)
+{
+    std::unique_ptr<LasStreamIf> streamIf(openStream());
+    std::istream& stream(*streamIf->m_istream);
+
+#ifdef PDAL_HAVE_LASZIP
+    if (m_compression == "LASZIP")
+    {
+        laszip_POINTER laszip = nullptr;
+        laszip_point_struct *laszipPoint;
+        laszip_BOOL compressed;
+
+        handleLaszip(laszip, laszip_create(&laszip));
+        try
+        {
+            handleLaszip(laszip,
+                laszip_open_reader_stream(laszip, stream, &compressed));
+            handleLaszip(laszip,
+                laszip_get_point_pointer(laszip, &laszipPoint));
+            handleLaszip(laszip, laszip_seek_point(laszip, begin));
+            for (point_count_t idx = begin; idx < end; ++idx)
+            {
+                handleLaszip(laszip, laszip_read_point(laszip));
+                PointRef point(view, id++);
+                loadPoint(point, *laszipPoint);
+            }
+            handleLaszip(laszip, laszip_close_reader(laszip));
+        }
+        catch (...)
+        {
+            laszip_destroy(laszip);
+            throw;
+        }
+        // The handle is gone, so there's no message to report.
+        if (laszip_destroy(laszip))
+            throwError("Unable to destroy LASzip reader.");
+    }
+#endif
+
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_compression == "LAZPERF")
+    {
+        const LasVLR *vlr = m_header.findVlr(LASZIP_USER_ID,
+            LASZIP_RECORD_ID);
+        LazPerfVlrDecompressor decompressor(stream, vlr->data(),
+            m_header.pointOffset(), chunkOffset);
+        std::vector<char> buf(decompressor.pointSize());
+
+        // LAZperf can't seek within a chunk, so points before the first
+        // one requested are decompressed and discarded.
+        for (point_count_t idx = chunkStart; idx < end; ++idx)
+        {
+            decompressor.decompress(buf.data());
+            if (idx < begin)
+                continue;
+            PointRef point(view, id++);
+            loadPoint(point, buf.data(), m_header.pointLen());
+        }
+    }
+#endif
+}
+
+
 point_count_t LasReader::readFileBlock(std::vector<char>& buf,
     point_count_t maxpoints)
 {
@@ -683,7 +1197,7 @@ void LasReader::loadPoint(PointRef& point, laszip_point& p)
 #endif // PDAL_HAVE_LASZIP
 
 
-void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPoint(PointRef& point, const char *buf, size_t bufsize)
 {
     if (m_header.has14Format())
         loadPointV14(point, buf, bufsize);
@@ -734,7 +1248,8 @@ void LasReader::loadPointV10(PointRef& point, laszip_point& p)
 }
 #endif // PDAL_HAVE_LASZIP
 
-void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPointV10(PointRef& point, const char *buf,
+    size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -844,7 +1359,8 @@ void LasReader::loadPointV14(PointRef& point, laszip_point& p)
 #endif  // PDAL_HAVE_LASZIP
 
 
-void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPointV14(PointRef& point, const char *buf,
+    size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -948,6 +1464,8 @@ void LasReader::done(PointTableRef)
         handleLaszip(laszip_destroy(m_laszip));
     }
 #endif
+    m_map = FileUtils::unmapFile(m_map);
+    m_pointData = nullptr;
     m_streamIf.reset();
 }
 
@@ -39,6 +39,7 @@
 #include <pdal/PDALUtils.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #ifdef PDAL_HAVE_LASZIP
 #include <laszip/laszip_api.h>
@@ -97,15 +98,26 @@ public:
 
     const LasHeader& header() const
         { return m_header; }
+    // Number of points that can be read.  This is the header's point count,
+    // limited to the points an uncompressed file holds.
     point_count_t getNumPoints() const
-        { return m_header.pointCount(); }
+        { return m_numPoints; }
 
 protected:
+    // Open a new stream on the LAS data.  Used for the main stream and
+    // for the streams of threads that decompress chunks.
+    virtual LasStreamIf *openStream()
+        { return new LasStreamIf(m_filename); }
+
+    // Offset of the LAS data in the file.
+    virtual uint64_t dataOffset() const
+        { return 0; }
+
     virtual void createStream()
     {
         if (m_streamIf)
             std::cerr << "Attempt to create stream twice!\n";
-        m_streamIf.reset(new LasStreamIf(m_filename));
+        m_streamIf.reset(openStream());
         if (!m_streamIf->m_istream)
         {
             std::ostringstream oss;
@@ -119,6 +131,32 @@ protected:
 
 private:
     typedef std::vector<LasUtils::IgnoreVLR> IgnoreVLRList;
+    typedef void (LasReader::*PointDecoder)(const char *buf,
+        char *point) const;
+
+    // Offsets in the point storage of the dimensions of a LAS point.
+    struct DimOffsets
+    {
+        std::size_t x;
+        std::size_t y;
+        std::size_t z;
+        std::size_t intensity;
+        std::size_t returnNumber;
+        std::size_t numberOfReturns;
+        std::size_t scanDirectionFlag;
+        std::size_t edgeOfFlightLine;
+        std::size_t classification;
+        std::size_t scanAngleRank;
+        std::size_t userData;
+        std::size_t pointSourceId;
+        std::size_t gpsTime;
+        std::size_t red;
+        std::size_t green;
+        std::size_t blue;
+        std::size_t infrared;
+        std::size_t scanChannel;
+        std::size_t classFlags;
+    };
 
     LasHeader m_header;
     laszip_POINTER m_laszip;
@@ -127,11 +165,18 @@ private:
     LazPerfVlrDecompressor *m_decompressor;
     std::vector<char> m_decompressorBuf;
     point_count_t m_index;
+    point_count_t m_numPoints;
     StringList m_extraDimSpec;
     std::vector<ExtraDim> m_extraDims;
     IgnoreVLRList m_ignoreVLRs;
     std::string m_compression;
     StringList m_ignoreVLROption;
+    point_count_t m_start;
+    FileUtils::MapContext m_map;
+    const char *m_pointData;
+    point_count_t m_mappedPoints;
+    PointDecoder m_decoder;
+    DimOffsets m_offsets;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize(PointTableRef table)
@@ -154,13 +199,25 @@ private:
     void loadPoint(PointRef& point, laszip_point& p);
     void loadPointV10(PointRef& point, laszip_point& p);
     void loadPointV14(PointRef& point, laszip_point& p);
-    void loadPoint(PointRef& point, char *buf, size_t bufsize);
-    void loadPointV10(PointRef& point, char *buf, size_t bufsize);
-    void loadPointV14(PointRef& point, char *buf, size_t bufsize);
+    void loadPoint(PointRef& point, const char *buf, size_t bufsize);
+    void loadPointV10(PointRef& point, const char *buf, size_t bufsize);
+    void loadPointV14(PointRef& point, const char *buf, size_t bufsize);
+    void mapPoints();
+    void selectDecoder(const PointLayout& layout);
+    template<bool V14, bool Time, bool Color, bool Infrared>
+    void decodePoint(const char *buf, char *point) const;
     void loadExtraDims(LeExtractor& istream, PointRef& data);
     point_count_t readFileBlock(std::vector<char>& buf,
         point_count_t maxPoints);
+    point_count_t chunkSize() const;
+    bool findChunks(std::vector<std::streamoff>& chunkOffsets);
+    point_count_t readThreaded(PointViewPtr view, point_count_t count,
+        std::size_t numThreads,
+        const std::vector<std::streamoff>& chunkOffsets);
+    void readChunk(PointView& view, PointId id, point_count_t chunkStart,
+        point_count_t begin, point_count_t end, std::streamoff chunkOffset);
     void handleLaszip(int result);
+    void handleLaszip(laszip_POINTER laszip, int result);
 
     LasReader& operator=(const LasReader&); // not implemented
     LasReader(const LasReader&); // not implemented
@@ -132,6 +132,8 @@ void LasWriter::addArgs(ProgramArgs& args)
     args.add("offset_y", "Y offset", m_offsetY);
     args.add("offset_z", "Z offset", m_offsetZ);
     args.add("vlrs", "List of VLRs to set", m_userVLRs);
+    addThreadsArg(args, "Number of threads used to "
+        "compress LAZ data with LAZperf");
 }
 
 void LasWriter::initialize()
@@ -722,7 +724,7 @@ void LasWriter::readyLazPerfCompression()
 
     delete m_compressor;
     m_compressor = new LazPerfVlrCompressor(*m_ostream, schema,
-        zipvlr.chunk_size);
+        zipvlr.chunk_size, numThreads());
 #endif
 }
 
@@ -764,6 +766,44 @@ bool LasWriter::processOne(PointRef& point)
 }
 
 
+// Fill the point buffer with the points of a batch and write them all at
+// once.
+void LasWriter::processBatch(StreamPointTable& table, point_count_t count,
+    SkipMask& skips)
+{
+    // Since we use the LASzip API, we can't benefit from building
+    // a buffer of multiple points.
+    if (m_compression == LasCompression::LasZip)
+    {
+        Streamable::processBatch(table, count, skips);
+        return;
+    }
+
+    point_count_t pointLen = m_lasHeader.pointLen();
+    if (m_pointBuf.size() < count * pointLen)
+        m_pointBuf.resize(count * pointLen);
+
+    LeInserter ostream(m_pointBuf.data(), m_pointBuf.size());
+    PointRef point(table, 0);
+    point_count_t filled = 0;
+    for (PointId idx = 0; idx < count; idx++)
+    {
+        if (skips.skipped(idx))
+            continue;
+        point.setPointId(idx);
+        if (fillPointBuf(point, ostream))
+            filled++;
+        else
+            skips.skip(idx);
+    }
+
+    if (m_compression == LasCompression::LazPerf)
+        writeLazPerfBuf(m_pointBuf.data(), pointLen, filled);
+    else
+        m_ostream->write(m_pointBuf.data(), filled * pointLen);
+}
+
+
 void LasWriter::writeView(const PointViewPtr view)
 {
     Utils::writeProgress(m_progressFd, "READYVIEW",
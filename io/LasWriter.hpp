@@ -145,6 +145,8 @@ private:
         const SpatialReference& srs);
     virtual void writeView(const PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, point_count_t count,
+        SkipMask& skips);
     void spatialReferenceChanged(const SpatialReference& srs);
     virtual void doneFile();
 
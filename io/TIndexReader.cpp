@@ -33,8 +33,14 @@
 ****************************************************************************/
 
 #include "TIndexReader.hpp"
+
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+
 #include <pdal/GDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -121,6 +127,12 @@ void TIndexReader::addArgs(ProgramArgs& args)
         "with lyr_name", m_attributeFilter);
     args.add("dialect", "OGR SQL dialect to use when querying tile "
         "index layer", m_dialect, "OGRSQL");
+    addThreadsArg(args, "Number of threads used to read tiles");
+    args.add("memory_budget", "Approximate maximum memory, in megabytes, "
+        "used by tiles that have been read but not yet merged",
+        m_memoryBudget, (uint64_t)1024);
+    args.add("merge", "Merge the points of all tiles into a single view",
+        m_merge, true);
 }
 
 
@@ -201,55 +213,17 @@ void TIndexReader::initialize()
                 "' for OGR datasource '" + m_filename + "'");
     }
 
-    Options cropOptions;
+    // WKT is set even if we're using a bounding box for filtering, so
+    // can be used as a test here.
     if (m_wkt.size())
-        cropOptions.add("polygon", m_wkt);
-
-    for (auto f : getFiles())
     {
-        log()->get(LogLevel::Debug) << "Adding file " << f.m_filename <<
-            " to merge filter" << std::endl;
-
-        std::string driver = m_factory.inferReaderDriver(f.m_filename);
-        Stage *reader = m_factory.createStage(driver);
-        if (!reader)
-            throwError("Unable to create reader for file '" + f.m_filename +
-                "'.");
-        Options readerOptions;
-        readerOptions.add("filename", f.m_filename);
-        reader->setOptions(readerOptions);
-        Stage *premerge = reader;
-
-        if (m_tgtSrsString != f.m_srs &&
-            (m_tgtSrsString.size() && f.m_srs.size()))
-        {
-            Stage *repro = m_factory.createStage("filters.reprojection");
-            repro->setInput(*reader);
-            Options reproOptions;
-            reproOptions.add("out_srs", m_tgtSrsString);
-            reproOptions.add("in_srs", f.m_srs);
-            log()->get(LogLevel::Debug2) << "Repro = "
-                                         << m_tgtSrsString << "/"
-                                         << f.m_srs << "!\n";
-            repro->setOptions(reproOptions);
-            premerge = repro;
-        }
-
-        // WKT is set even if we're using a bounding box for filtering, so
-        // can be used as a test here.
-        if (!m_wkt.empty())
-        {
-            Stage *crop = m_factory.createStage("filters.crop");
-            crop->setOptions(cropOptions);
-            crop->setInput(*premerge);
-            log()->get(LogLevel::Debug3) << "Cropping data with wkt '"
-                                         << m_wkt << "'" << std::endl;
-            premerge = crop;
-        }
-
-        m_merge.setInput(*premerge);
+        m_polygon.reset(new Polygon(m_wkt));
+        BOX3D b = m_polygon->bounds();
+        m_polygonBounds = BOX2D(b.minx, b.miny, b.maxx, b.maxy);
     }
 
+    m_files = getFiles();
+
     if (m_sql.size())
     {
         // We were created with OGR_DS_ExecuteSQL which needs to have
@@ -264,20 +238,216 @@ void TIndexReader::initialize()
     m_dataset = 0;
 }
 
+// Create the stages that read a tile and reproject it to the output SRS
+// if necessary.  Return the last stage.
+Stage& TIndexReader::createTileStages(const FileInfo& file)
+{
+    std::string driver = m_factory.inferReaderDriver(file.m_filename);
+    Stage *reader = m_factory.createStage(driver);
+    if (!reader)
+        throwError("Unable to create reader for file '" + file.m_filename +
+            "'.");
+    Options readerOptions;
+    readerOptions.add("filename", file.m_filename);
+    reader->setOptions(readerOptions);
+    Stage *last = reader;
+
+    if (m_tgtSrsString != file.m_srs &&
+        (m_tgtSrsString.size() && file.m_srs.size()))
+    {
+        Stage *repro = m_factory.createStage("filters.reprojection");
+        repro->setInput(*reader);
+        Options reproOptions;
+        reproOptions.add("out_srs", m_tgtSrsString);
+        reproOptions.add("in_srs", file.m_srs);
+        repro->setOptions(reproOptions);
+        last = repro;
+    }
+    return *last;
+}
+
+
+// Prepare the stages of every tile against a table of its own, in which
+// the tile is read in run().  The dimensions of all tiles are added to the
+// output table.
 void TIndexReader::prepared(PointTableRef table)
 {
-    m_merge.prepare(table);
+    PointLayoutPtr outLayout = table.layout();
+
+    m_tiles.clear();
+    m_tiles.resize(m_files.size());
+    std::vector<point_count_t> counts;
+    for (size_t i = 0; i < m_files.size(); ++i)
+    {
+        const FileInfo& f = m_files[i];
+        TileData& tile = m_tiles[i];
+
+        log()->get(LogLevel::Debug) << "Adding file " << f.m_filename <<
+            std::endl;
+
+        tile.m_stage = &createTileStages(f);
+        QuickInfo qi = tile.m_stage->preview();
+        counts.push_back(qi.valid() ? qi.m_pointCount : 0);
+        tile.m_table.reset(new PointTable);
+        tile.m_stage->prepare(*tile.m_table);
+
+        PointLayoutPtr layout = tile.m_table->layout();
+        for (Dimension::Id id : layout->dims())
+            outLayout->registerOrAssignDim(layout->dimName(id),
+                layout->dimType(id));
+    }
+
+    const uint64_t pointSize = outLayout->pointSize();
+    for (size_t i = 0; i < m_tiles.size(); ++i)
+    {
+        if (counts[i] < std::numeric_limits<uint64_t>::max() / pointSize)
+            m_tiles[i].m_estimate = counts[i] * pointSize;
+    }
+}
+
+
+// Read a tile into its own table and drop the points that are outside the
+// bounds of the query polygon.
+void TIndexReader::readTile(TileData& data)
+{
+    // The table of a tile is released once the tile is merged, so the
+    // stages are only prepared again if the reader is run again.
+    if (!data.m_table)
+    {
+        data.m_table.reset(new PointTable);
+        data.m_stage->prepare(*data.m_table);
+    }
+    PointViewSet views = data.m_stage->execute(*data.m_table);
+
+    if (!m_polygon)
+    {
+        data.m_views = views;
+        return;
+    }
+
+    for (PointViewPtr view : views)
+    {
+        PointViewPtr kept = view->makeNew();
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            double x = view->getFieldAs<double>(Dimension::Id::X, idx);
+            double y = view->getFieldAs<double>(Dimension::Id::Y, idx);
+            if (m_polygonBounds.contains(x, y))
+                kept->appendPoint(*view, idx);
+        }
+        data.m_views.insert(kept);
+    }
 }
 
-void TIndexReader::ready(PointTableRef table)
+
+// Copy the points of a tile that are covered by the query polygon into the
+// output.  Dimensions are matched by name, since tile tables assign their
+// own IDs to non-standard dimensions.
+void TIndexReader::mergeTile(TileData& data, PointViewPtr view,
+    PointViewSet& views)
 {
-    m_pvSet = m_merge.execute(table);
+    PointLayoutPtr outLayout = view->layout();
+    PointViewPtr out = view;
+    if (!m_merge)
+    {
+        out = view->makeNew();
+        views.insert(out);
+    }
+
+    PointLayoutPtr inLayout = data.m_table->layout();
+    DimTypeList inDims;
+    DimTypeList outDims;
+    for (Dimension::Id id : inLayout->dims())
+    {
+        Dimension::Id outId = outLayout->findDim(inLayout->dimName(id));
+        if (outId == Dimension::Id::Unknown)
+            continue;
+        Dimension::Type type = inLayout->dimType(id);
+        inDims.push_back(DimType(id, type));
+        outDims.push_back(DimType(outId, type));
+    }
+
+    std::vector<char> buf(inLayout->pointSize());
+    for (PointViewPtr in : data.m_views)
+    {
+        for (PointId idx = 0; idx < in->size(); ++idx)
+        {
+            if (m_polygon && !m_polygon->covers(in->point(idx)))
+                continue;
+            in->getPackedPoint(inDims, idx, buf.data());
+            out->setPackedPoint(outDims, out->size(), buf.data());
+        }
+    }
 }
 
 
-PointViewSet TIndexReader::run(PointViewPtr)
+// Tiles are read concurrently and merged in tile index order.  A tile isn't
+// started until the estimated size of the tiles that have been started but
+// not merged fits in the memory budget, though one tile is always allowed.
+PointViewSet TIndexReader::run(PointViewPtr view)
 {
-    return m_pvSet;
+    PointViewSet views;
+    if (m_merge)
+        views.insert(view);
+
+    const size_t numTiles = m_files.size();
+    const uint64_t budget = m_memoryBudget * 1024 * 1024;
+    size_t threadCount = numThreads();
+    threadCount = (std::max)((size_t)1, (std::min)(threadCount, numTiles));
+
+    std::mutex mutex;
+    std::condition_variable doneCv;
+    for (TileData& d : m_tiles)
+    {
+        d.m_done = false;
+        d.m_error = nullptr;
+    }
+
+    ThreadPool pool(threadCount);
+    size_t next = 0;
+    uint64_t pending = 0;
+    for (size_t i = 0; i < numTiles; ++i)
+    {
+        while (next < numTiles && next < i + 2 * threadCount &&
+            (next == i || pending + m_tiles[next].m_estimate <= budget))
+        {
+            TileData& d = m_tiles[next];
+            pool.add([this, &d, &mutex, &doneCv]()
+            {
+                try
+                {
+                    readTile(d);
+                }
+                catch (...)
+                {
+                    d.m_error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                d.m_done = true;
+                doneCv.notify_all();
+            });
+            pending += d.m_estimate;
+            next++;
+        }
+
+        TileData& d = m_tiles[i];
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            doneCv.wait(lock, [&d](){ return d.m_done; });
+        }
+        if (d.m_error)
+            std::rethrow_exception(d.m_error);
+
+        log()->get(LogLevel::Debug) << "Merging file " <<
+            m_files[i].m_filename << std::endl;
+        mergeTile(d, view, views);
+
+        // Free the tile's points.
+        d.m_views.clear();
+        d.m_table.reset();
+        pending -= d.m_estimate;
+    }
+    return views;
 }
 
 } // namespace pdal
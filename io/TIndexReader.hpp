@@ -34,11 +34,13 @@
 
 #pragma once
 
+#include <exception>
+
 #include <pdal/PointView.hpp>
+#include <pdal/Polygon.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/GDALUtils.hpp>
-#include <filters/MergeFilter.hpp>
 
 extern "C" int32_t TIndexReader_ExitFunc();
 extern "C" PF_ExitFunc TIndexReader_InitPlugin();
@@ -64,6 +66,21 @@ class PDAL_DLL TIndexReader : public Reader
         int m_mtime;
     };
 
+    // The prepared stages of a tile and the points read from it, which are
+    // held until they're merged into the output.
+    struct TileData
+    {
+        TileData() : m_stage(nullptr), m_estimate(0), m_done(false)
+        {}
+
+        Stage *m_stage;
+        uint64_t m_estimate;
+        std::unique_ptr<PointTable> m_table;
+        PointViewSet m_views;
+        bool m_done;
+        std::exception_ptr m_error;
+    };
+
 public:
     TIndexReader() : m_dataset(NULL) , m_layer(NULL)
         {}
@@ -77,7 +94,6 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void prepared(PointTableRef table);
-    virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
 
     std::string m_layerName;
@@ -91,17 +107,24 @@ private:
     std::string m_dialect;
     BOX2D m_bounds;
     std::string m_sql;
+    uint64_t m_memoryBudget;
+    bool m_merge;
 
     std::unique_ptr<gdal::SpatialRef> m_out_ref;
     void *m_dataset;
     void *m_layer;
 
     StageFactory m_factory;
-    MergeFilter m_merge;
-    PointViewSet m_pvSet;
+    std::vector<FileInfo> m_files;
+    std::vector<TileData> m_tiles;
+    std::unique_ptr<Polygon> m_polygon;
+    BOX2D m_polygonBounds;
 
     std::vector<FileInfo> getFiles();
     FieldIndexes getFields();
+    Stage& createTileStages(const FileInfo& file);
+    void readTile(TileData& data);
+    void mergeTile(TileData& data, PointViewPtr view, PointViewSet& views);
 };
 
 
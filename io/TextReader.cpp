@@ -34,10 +34,13 @@
 
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "TextReader.hpp"
 #include "../filters/StatsFilter.hpp"
 
+#include <cstring>
+
 namespace pdal
 {
 
@@ -50,6 +53,90 @@ CREATE_STATIC_PLUGIN(1, 0, TextReader, Reader, s_info)
 
 std::string TextReader::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Size of the blocks in which the file is read.
+const size_t BlockSize = 1 << 20;
+
+// Minimum number of lines parsed by each thread.
+const size_t MinChunk = 4096;
+
+// Whitespace in the "C" locale, which is what a stream skips.
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+        c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Convert a decimal number of the form [+-]digits[.digits][(e|E)[+-]digits]
+// that is either at the end of the range or followed by whitespace other
+// than a space.  Only values that can be computed exactly from a mantissa
+// of at most 53 bits and a power of ten of at most 22 are converted, so
+// the result is correctly rounded, as with a stream.  Anything else,
+// including values that a stream would reject, is left to a stream.
+bool fastParse(const char *p, const char *end, double& value)
+{
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+        1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+        1e19, 1e20, 1e21, 1e22 };
+
+    while (p < end && isSpace(*p))
+        p++;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    for (; p < end && isDigit(*p); ++p, ++digits)
+        if (digits < 19)
+            mantissa = mantissa * 10 + (*p - '0');
+    if (p < end && *p == '.')
+        for (++p; p < end && isDigit(*p); ++p, ++digits, --exponent)
+            if (digits < 19)
+                mantissa = mantissa * 10 + (*p - '0');
+    if (digits == 0 || digits > 19)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negExp = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negExp = (*p++ == '-');
+        if (p == end || !isDigit(*p))
+            return false;
+        int e = 0;
+        for (; p < end && isDigit(*p); ++p)
+            if (e < 10000)
+                e = e * 10 + (*p - '0');
+        exponent += negExp ? -e : e;
+    }
+    if (p < end && (*p == ' ' || !isSpace(*p)))
+        return false;
+
+    if (mantissa == 0)
+        value = 0;
+    else if (mantissa > (1ULL << 53) || exponent < -22 || exponent > 22)
+        return false;
+    else if (exponent < 0)
+        value = (double)mantissa / powers[-exponent];
+    else
+        value = (double)mantissa * powers[exponent];
+    if (negative)
+        value = -value;
+    return true;
+}
+
+} // unnamed namespace
+
 // NOTE: - Forces reading of the entire file.
 QuickInfo TextReader::inspect()
 {
@@ -155,6 +242,7 @@ void TextReader::addArgs(ProgramArgs& args)
         "the first line in the file.", m_headerOverride);
     args.add("header_insert", "Use this string as the header line. All "
         "lines of the file are treated as data.", m_headerInsert);
+    addThreadsArg(args, "Number of threads used to parse lines");
 }
 
 
@@ -189,21 +277,84 @@ void TextReader::ready(PointTableRef table)
         std::getline(*m_istream, buf);
         m_line = 1;
     }
+    m_bufPos = 0;
+    m_bufEnd = 0;
 }
 
 
 point_count_t TextReader::read(PointViewPtr view, point_count_t numPts)
 {
+    size_t threadCount = numThreads();
+    std::unique_ptr<ThreadPool> pool;
+    if (threadCount > 1)
+        pool.reset(new ThreadPool(threadCount));
+
+    const size_t numDims = m_dims.size();
+    std::vector<Range> lines;
+    std::vector<double> values;
+    std::vector<char> valid;
+    std::vector<StringList> messages;
+    std::vector<std::vector<Range>> fields;
+
     PointId idx = view->size();
     point_count_t cnt = 0;
-    PointRef point(*view, idx);
     while (cnt < numPts)
     {
-        point.setPointId(idx);
-        if (!processOne(point))
+        // Take the complete lines in the buffer, reading more of the file
+        // only when there are none.  Each line makes at most one point.
+        lines.clear();
+        Range line;
+        while (lines.size() < numPts - cnt && nextLine(line, lines.empty()))
+            lines.push_back(line);
+        if (lines.empty())
             break;
-        cnt++;
-        idx++;
+
+        // Parse chunks of lines in parallel.  Points and messages are
+        // then handled in file order.
+        const size_t numLines = lines.size();
+        size_t numChunks = pool ?
+            (std::min)(threadCount, numLines / MinChunk) : 1;
+        numChunks = (std::max)(numChunks, (size_t)1);
+        values.resize(numLines * numDims);
+        valid.resize(numLines);
+        messages.resize(numChunks);
+        fields.resize(numChunks);
+        auto parse = [&](size_t chunk)
+        {
+            size_t begin = numLines * chunk / numChunks;
+            size_t end = numLines * (chunk + 1) / numChunks;
+            for (size_t i = begin; i < end; ++i)
+                valid[i] = parseLine(lines[i], m_line + i + 1,
+                    values.data() + i * numDims, fields[chunk],
+                    messages[chunk]);
+        };
+        if (numChunks == 1)
+            parse(0);
+        else
+        {
+            for (size_t c = 0; c < numChunks; ++c)
+                pool->add([&parse, c](){ parse(c); });
+            pool->await();
+        }
+        m_line += numLines;
+
+        for (StringList& chunkMessages : messages)
+        {
+            for (const std::string& m : chunkMessages)
+                log()->get(LogLevel::Error) << m << std::endl;
+            chunkMessages.clear();
+        }
+
+        const double *v = values.data();
+        for (size_t i = 0; i < numLines; ++i, v += numDims)
+        {
+            if (!valid[i])
+                continue;
+            for (size_t d = 0; d < numDims; ++d)
+                view->setField(m_dims[d], idx, v[d]);
+            idx++;
+            cnt++;
+        }
     }
     return cnt;
 }
@@ -211,62 +362,171 @@ point_count_t TextReader::read(PointViewPtr view, point_count_t numPts)
 
 bool TextReader::processOne(PointRef& point)
 {
-    if (!fillFields())
-        return false;
+    m_values.resize(m_dims.size());
 
-    double d;
-    for (size_t i = 0; i < m_fields.size(); ++i)
+    Range line;
+    while (nextLine(line, true))
     {
-        if (!Utils::fromString(m_fields[i], d))
-        {
-            log()->get(LogLevel::Error) << "Can't convert "
-                "field '" << m_fields[i] << "' to numeric value on line " <<
-                m_line << " in '" << m_filename << "'.  Setting to 0." <<
-                std::endl;
-            d = 0;
-        }
-        point.setField(m_dims[i], d);
+        m_line++;
+        bool valid = parseLine(line, m_line, m_values.data(), m_fields,
+            m_messages);
+        for (const std::string& m : m_messages)
+            log()->get(LogLevel::Error) << m << std::endl;
+        m_messages.clear();
+        if (!valid)
+            continue;
+
+        for (size_t i = 0; i < m_dims.size(); ++i)
+            point.setField(m_dims[i], m_values[i]);
+        return true;
     }
-    return true;
+    return false;
 }
 
 
-bool TextReader::fillFields()
+bool TextReader::nextLine(Range& line, bool refill)
 {
     while (true)
     {
-        if (!m_istream->good())
+        const char *begin = m_buf.data() + m_bufPos;
+        const char *newline = (m_bufPos == m_bufEnd) ? nullptr :
+            (const char *)std::memchr(begin, '\n', m_bufEnd - m_bufPos);
+        if (newline)
+        {
+            line = Range{ begin, newline };
+            m_bufPos = newline - m_buf.data() + 1;
+            return true;
+        }
+        if (!refill)
             return false;
 
-        std::string buf;
+        // Move the partial line to the start of the buffer and read more
+        // of the file after it.  The buffer grows if the line fills it.
+        size_t remaining = m_bufEnd - m_bufPos;
+        if (remaining && m_bufPos)
+            std::memmove(m_buf.data(), begin, remaining);
+        m_bufPos = 0;
+        m_bufEnd = remaining;
+        if (m_buf.size() < BlockSize)
+            m_buf.resize(BlockSize);
+        else if (remaining == m_buf.size())
+            m_buf.resize(m_buf.size() * 2);
+
+        size_t count = 0;
+        if (m_istream->good())
+        {
+            m_istream->read(m_buf.data() + m_bufEnd, m_buf.size() - m_bufEnd);
+            count = (size_t)m_istream->gcount();
+            m_bufEnd += count;
+        }
+        if (count == 0)
+        {
+            // The last line of the file needn't end with a newline.
+            if (m_bufEnd == 0)
+                return false;
+            line = Range{ m_buf.data(), m_buf.data() + m_bufEnd };
+            m_bufPos = m_bufEnd;
+            return true;
+        }
+    }
+}
 
-        std::getline(*m_istream, buf);
-        m_line++;
-        if (buf.empty())
-            continue;
-        if (m_separator != ' ')
+
+bool TextReader::parseLine(Range line, size_t lineNum, double *values,
+    std::vector<Range>& fields, StringList& messages) const
+{
+    if (line.m_begin == line.m_end)
+        return false;
+
+    fields.clear();
+    if (m_separator != ' ')
+    {
+        const char *begin = line.m_begin;
+        while (true)
         {
-            Utils::remove(buf, ' ');
-            m_fields = Utils::split(buf, m_separator);
+            const char *end = std::find(begin, line.m_end, m_separator);
+            fields.push_back(Range{ begin, end });
+            if (end == line.m_end)
+                break;
+            begin = end + 1;
         }
-        else
-            m_fields = Utils::split2(buf, m_separator);
-        if (m_fields.size() != m_dims.size())
+
+        // Spaces are ignored, so a line of them has no fields.
+        if (fields.size() == 1 && std::all_of(line.m_begin, line.m_end,
+                [](char c){ return c == ' '; }))
+            fields.clear();
+    }
+    else
+    {
+        const char *pos = line.m_begin;
+        while (pos != line.m_end)
         {
-            log()->get(LogLevel::Error) << "Line " << m_line <<
-                " in '" << m_filename << "' contains " << m_fields.size() <<
-                " fields when " << m_dims.size() << " were expected.  "
-                "Ignoring." << std::endl;
-            continue;
+            const char *begin = std::find_if(pos, line.m_end,
+                [](char c){ return c != ' '; });
+            if (begin == line.m_end)
+                break;
+            pos = std::find(begin, line.m_end, ' ');
+            fields.push_back(Range{ begin, pos });
         }
-        return true;
     }
+
+    if (fields.size() != m_dims.size())
+    {
+        std::ostringstream oss;
+        oss << "Line " << lineNum << " in '" << m_filename <<
+            "' contains " << fields.size() << " fields when " <<
+            m_dims.size() << " were expected.  Ignoring.";
+        messages.push_back(oss.str());
+        return false;
+    }
+
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        if (!parseValue(fields[i], values[i]))
+        {
+            std::string field(fields[i].m_begin, fields[i].m_end);
+            if (m_separator != ' ')
+                Utils::remove(field, ' ');
+            std::ostringstream oss;
+            oss << "Can't convert field '" << field << "' to numeric "
+                "value on line " << lineNum << " in '" << m_filename <<
+                "'.  Setting to 0.";
+            messages.push_back(oss.str());
+            values[i] = 0;
+        }
+    }
+    return true;
+}
+
+
+bool TextReader::parseValue(Range field, double& value) const
+{
+    const char *begin = field.m_begin;
+    const char *end = field.m_end;
+
+    // Spaces around a field are ignored when there is a separator.  Fields
+    // with spaces inside, whose parts are joined, are left to the stream.
+    if (m_separator != ' ')
+    {
+        while (begin < end && *begin == ' ')
+            begin++;
+        while (end > begin && *(end - 1) == ' ')
+            end--;
+    }
+    if (fastParse(begin, end, value))
+        return true;
+
+    std::string s(field.m_begin, field.m_end);
+    if (m_separator != ' ')
+        Utils::remove(s, ' ');
+    return Utils::fromString(s, value);
 }
 
 
 void TextReader::done(PointTableRef table)
 {
     Utils::closeFile(m_istream);
+    std::vector<char>().swap(m_buf);
 }
 
 
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <istream>
+#include <vector>
 
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
@@ -52,7 +53,7 @@ public:
     static int32_t destroy(void *);
     std::string getName() const;
 
-    TextReader() : m_istream(NULL)
+    TextReader() : m_istream(NULL), m_bufPos(0), m_bufEnd(0)
     {}
 
 private:
@@ -116,7 +117,47 @@ private:
     */
     virtual bool processOne(PointRef& point);
 
-    bool fillFields();
+    // Range of characters in the read buffer.
+    struct Range
+    {
+        const char *m_begin;
+        const char *m_end;
+    };
+
+    /**
+      Get the next line of the file from the read buffer.
+
+      \param line  Set to the line, without its newline.
+      \param refill  Whether more of the file may be read into the buffer
+        if it doesn't contain a complete line.  Refilling invalidates lines
+        previously returned.
+      \return  False if no line is available.
+    */
+    bool nextLine(Range& line, bool refill);
+
+    /**
+      Split a line into fields and convert them to numeric values.  Errors
+      are reported as messages rather than logged, so that lines can be
+      parsed in parallel.
+
+      \param line  Line to parse.
+      \param lineNum  Line number, for messages.
+      \param values  Set to the values of the fields.
+      \param fields  Scratch list of fields.
+      \param messages  Messages to which errors are appended.
+      \return  False if the line doesn't contain a point.
+    */
+    bool parseLine(Range line, size_t lineNum, double *values,
+        std::vector<Range>& fields, StringList& messages) const;
+
+    /**
+      Convert a field to a numeric value.
+
+      \param field  Field to convert.
+      \param value  Set to the converted value.
+      \return  \c true if the conversion was successful, \c false otherwise.
+    */
+    bool parseValue(Range field, double& value) const;
 
     /**
       Parse a header line into a list of dimension names.
@@ -139,7 +180,12 @@ private:
     std::istream *m_istream;
     StringList m_dimNames;
     Dimension::IdList m_dims;
-    StringList m_fields;
+    std::vector<char> m_buf;
+    size_t m_bufPos;
+    size_t m_bufEnd;
+    std::vector<Range> m_fields;
+    std::vector<double> m_values;
+    StringList m_messages;
     size_t m_line;
     std::string m_headerOverride;
     std::string m_headerInsert;
@@ -39,7 +39,11 @@
 #include <pdal/PointView.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 
 namespace pdal
@@ -54,6 +58,63 @@ CREATE_STATIC_PLUGIN(1, 0, TextWriter, Writer, s_info)
 
 std::string TextWriter::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Append a value with a fixed number of decimals, exactly as
+// printf("%.*f") and a stream in std::fixed mode would format it.  When
+// the scaled value fits in the mantissa of a double and isn't too close to
+// halfway between two integers for the rounding of the scaling to matter,
+// the digits are those of a rounded integer.  Other values are left to
+// snprintf().
+void appendFixed(std::string& out, double v, int precision)
+{
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+        1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17 };
+    const double MaxExact = 9007199254740992.0;  // 2^53
+
+    if (precision <= 17 && std::isfinite(v))
+    {
+        double scaled = std::fabs(v) * powers[precision];
+        double whole = std::floor(scaled);
+        double frac = scaled - whole;
+        if (scaled < MaxExact &&
+            std::fabs(frac - 0.5) > scaled * 4.5e-16 + 1e-300)
+        {
+            uint64_t n = (uint64_t)whole + (frac > 0.5 ? 1 : 0);
+
+            char buf[32];
+            char *end = buf + sizeof(buf);
+            char *p = end;
+            for (int i = 0; i < precision; ++i)
+            {
+                *--p = '0' + (n % 10);
+                n /= 10;
+            }
+            if (precision)
+                *--p = '.';
+            do
+            {
+                *--p = '0' + (n % 10);
+                n /= 10;
+            } while (n);
+            if (std::signbit(v))
+                *--p = '-';
+            out.append(p, end);
+            return;
+        }
+    }
+
+    int len = std::snprintf(nullptr, 0, "%.*f", precision, v);
+    size_t pos = out.size();
+    out.resize(pos + len + 1);
+    std::snprintf(&out[pos], len + 1, "%.*f", precision, v);
+    out.resize(pos + len);
+}
+
+} // unnamed namespace
+
+
 struct FileStreamDeleter
 {
 
@@ -83,6 +144,7 @@ void TextWriter::addArgs(ProgramArgs& args)
     args.add("quote_header", "Whether a header should be quoted",
         m_quoteHeader, true);
     args.add("precision", "Output precision", m_precision, 3);
+    addThreadsArg(args, "Number of threads used to format points");
 }
 
 
@@ -93,6 +155,8 @@ void TextWriter::initialize(PointTableRef table)
     if (!m_stream)
         throwError("Couldn't open '" + m_filename + "' for output.");
     m_outputType = Utils::toupper(m_outputType);
+    if (m_precision < 0)
+        throwError("Invalid 'precision' option.  Must be zero or more.");
 }
 
 
@@ -101,27 +165,58 @@ void TextWriter::ready(PointTableRef table)
     m_stream->precision(m_precision);
     *m_stream << std::fixed;
 
-    // Find the dimensions listed and put them on the id list.
+    // Find the dimensions listed and put them on the id list.  A name may
+    // be followed by a colon and the precision of the dimension's values.
     StringList dimNames = Utils::split2(m_dimOrder, ',');
     for (std::string dim : dimNames)
     {
+        int precision = m_precision;
+        std::string::size_type pos = dim.find(':');
+        if (pos != std::string::npos)
+        {
+            std::string prec = dim.substr(pos + 1);
+            Utils::trim(prec);
+            dim.erase(pos);
+            if (!Utils::fromString(prec, precision) || precision < 0)
+                throwError("Invalid precision '" + prec + "' for "
+                    "dimension '" + dim + "'.");
+        }
         Utils::trim(dim);
         Dimension::Id d = table.layout()->findDim(dim);
         if (d == Dimension::Id::Unknown)
             throwError("Dimension not found with name '" + dim + "'.");
-        m_dims.push_back(d);
+        m_dims.push_back(DimSpec{ d, precision });
     }
 
+    auto findSpec = [this](Dimension::Id id)
+    {
+        return std::find_if(m_dims.begin(), m_dims.end(),
+            [id](const DimSpec& spec){ return spec.m_id == id; });
+    };
+
     // Add the rest of the dimensions to the list if we're doing that.
     // Yes, this isn't efficient when, but it's simple.
     if (m_dimOrder.empty() || m_writeAllDims)
     {
         Dimension::IdList all = table.layout()->dims();
         for (auto di = all.begin(); di != all.end(); ++di)
-            if (!Utils::contains(m_dims, *di))
-                m_dims.push_back(*di);
+            if (findSpec(*di) == m_dims.end())
+                m_dims.push_back(DimSpec{ *di, m_precision });
     }
 
+    // GeoJSON coordinates use the precision of their dimensions.
+    const Dimension::Id xyz[] =
+        { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        auto si = findSpec(xyz[i]);
+        m_xyz[i] = (si == m_dims.end()) ? DimSpec{ xyz[i], m_precision } : *si;
+    }
+    m_properties.clear();
+    for (const DimSpec& spec : m_dims)
+        m_properties.push_back("\"" + table.layout()->dimName(spec.m_id) +
+            "\":\"");
+
     if (!m_writeHeader)
         log()->get(LogLevel::Debug) << "Not writing header" << std::endl;
     else
@@ -169,56 +264,109 @@ void TextWriter::writeCSVHeader(PointTableRef table)
             *m_stream << m_delimiter;
 
         if (m_quoteHeader)
-            *m_stream << "\"" << layout->dimName(*di) << "\"";
+            *m_stream << "\"" << layout->dimName(di->m_id) << "\"";
         else
-            *m_stream << layout->dimName(*di);
+            *m_stream << layout->dimName(di->m_id);
     }
     *m_stream << m_newline;
 }
 
 void TextWriter::writeCSVBuffer(const PointViewPtr view)
 {
-    for (PointId idx = 0; idx < view->size(); ++idx)
+    writePoints(view, &TextWriter::writeCSVPoints);
+}
+
+void TextWriter::writeGeoJSONBuffer(const PointViewPtr view)
+{
+    writePoints(view, &TextWriter::writeGeoJSONPoints);
+}
+
+void TextWriter::writePoints(const PointViewPtr view,
+    void (TextWriter::*format)(const PointView&, PointId, PointId,
+        std::string&))
+{
+    size_t threadCount = numThreads();
+
+    // Chunks of points are formatted into buffers, in parallel, and the
+    // buffers are written in order.
+    const point_count_t ChunkSize = 16384;
+    const point_count_t count = view->size();
+    std::unique_ptr<ThreadPool> pool;
+    if (threadCount > 1 && count > ChunkSize)
+        pool.reset(new ThreadPool(threadCount));
+    m_buffers.resize(threadCount);
+
+    for (PointId start = 0; start < count; start += ChunkSize * threadCount)
+    {
+        size_t numChunks = 0;
+        for (; numChunks < threadCount; ++numChunks)
+        {
+            PointId begin = start + numChunks * ChunkSize;
+            if (begin >= count)
+                break;
+            PointId end = (std::min)(begin + ChunkSize, count);
+            std::string& out = m_buffers[numChunks];
+            out.clear();
+            if (pool)
+                pool->add([this, format, &view, begin, end, &out]()
+                    { (this->*format)(*view, begin, end, out); });
+            else
+                (this->*format)(*view, begin, end, out);
+        }
+        if (pool)
+            pool->await();
+        for (size_t c = 0; c < numChunks; ++c)
+            m_stream->write(m_buffers[c].data(), m_buffers[c].size());
+    }
+}
+
+void TextWriter::writeCSVPoints(const PointView& view, PointId begin,
+    PointId end, std::string& out)
+{
+    for (PointId idx = begin; idx < end; ++idx)
     {
         for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
         {
             if (di != m_dims.begin())
-                *m_stream << m_delimiter;
-            *m_stream << view->getFieldAs<double>(*di, idx);
+                out += m_delimiter;
+            appendFixed(out, view.getFieldAs<double>(di->m_id, idx),
+                di->m_precision);
         }
-        *m_stream << m_newline;
+        out += m_newline;
     }
 }
 
-void TextWriter::writeGeoJSONBuffer(const PointViewPtr view)
+void TextWriter::writeGeoJSONPoints(const PointView& view, PointId begin,
+    PointId end, std::string& out)
 {
-    using namespace Dimension;
-
-    for (PointId idx = 0; idx < view->size(); ++idx)
+    for (PointId idx = begin; idx < end; ++idx)
     {
         if (idx)
-            *m_stream << ",";
+            out += ",";
 
-        *m_stream << "{ \"type\":\"Feature\",\"geometry\": "
+        out += "{ \"type\":\"Feature\",\"geometry\": "
             "{ \"type\": \"Point\", \"coordinates\": [";
-        *m_stream << view->getFieldAs<double>(Id::X, idx) << ",";
-        *m_stream << view->getFieldAs<double>(Id::Y, idx) << ",";
-        *m_stream << view->getFieldAs<double>(Id::Z, idx) << "]},";
-
-        *m_stream << "\"properties\": {";
-
-        for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
+        for (size_t i = 0; i < 3; ++i)
         {
-            if (di != m_dims.begin())
-                *m_stream << ",";
+            if (i)
+                out += ",";
+            appendFixed(out, view.getFieldAs<double>(m_xyz[i].m_id, idx),
+                m_xyz[i].m_precision);
+        }
+        out += "]},";
 
-            *m_stream << "\"" << view->dimName(*di) << "\":";
-            *m_stream << "\"";
-            *m_stream << view->getFieldAs<double>(*di, idx);
-            *m_stream <<"\"";
+        out += "\"properties\": {";
+        for (size_t i = 0; i < m_dims.size(); ++i)
+        {
+            if (i)
+                out += ",";
+            out += m_properties[i];
+            appendFixed(out, view.getFieldAs<double>(m_dims[i].m_id, idx),
+                m_dims[i].m_precision);
+            out += "\"";
         }
-        *m_stream << "}"; // end properties
-        *m_stream << "}"; // end feature
+        out += "}"; // end properties
+        out += "}"; // end feature
     }
 }
 
@@ -36,6 +36,9 @@
 
 #include <pdal/Writer.hpp>
 
+#include <string>
+#include <vector>
+
 extern "C" int32_t TextWriter_ExitFunc();
 extern "C" PF_ExitFunc TextWriter_InitPlugin();
 
@@ -55,6 +58,13 @@ public:
     std::string getName() const;
 
 private:
+    // A dimension to write and the number of decimals of its values.
+    struct DimSpec
+    {
+        Dimension::Id m_id;
+        int m_precision;
+    };
+
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize(PointTableRef table);
     virtual void ready(PointTableRef table);
@@ -68,6 +78,13 @@ private:
 
     void writeGeoJSONBuffer(const PointViewPtr view);
     void writeCSVBuffer(const PointViewPtr view);
+    void writeGeoJSONPoints(const PointView& view, PointId begin, PointId end,
+        std::string& out);
+    void writeCSVPoints(const PointView& view, PointId begin, PointId end,
+        std::string& out);
+    void writePoints(const PointViewPtr view,
+        void (TextWriter::*format)(const PointView&, PointId, PointId,
+            std::string&));
 
     std::string m_filename;
     std::string m_outputType;
@@ -82,7 +99,10 @@ private:
     int m_precision;
 
     FileStreamPtr m_stream;
-    Dimension::IdList m_dims;
+    std::vector<DimSpec> m_dims;
+    DimSpec m_xyz[3];
+    StringList m_properties;
+    std::vector<std::string> m_buffers;
 
     TextWriter& operator=(const TextWriter&); // not implemented
     TextWriter(const TextWriter&); // not implemented
@@ -51,7 +51,8 @@ CREATE_STATIC_PLUGIN(1, 0, PipelineKernel, Kernel, s_info)
 
 std::string PipelineKernel::getName() const { return s_info.name; }
 
-PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1)
+PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1),
+    m_threads(1), m_threadsArg(nullptr)
 {}
 
 
@@ -88,6 +89,8 @@ void PipelineKernel::addSwitches(ProgramArgs& args)
         m_PointCloudSchemaOutput).setHidden();
     args.add("stdin,s", "Read pipeline from standard input", m_usestdin);
     args.add("stream", "Attempt to run pipeline in streaming mode.", m_stream);
+    m_threadsArg = &args.add("threads", "Maximum number of threads to use "
+        "to run the pipeline", m_threads);
     args.add("metadata", "Metadata filename", m_metadataFile);
 }
 
@@ -128,6 +131,8 @@ int PipelineKernel::execute()
     }
 
     m_manager.readPipeline(m_inputFile);
+    if (m_threadsArg->set())
+        m_manager.setThreads(m_threads);
     if (m_stream)
     {
         FixedPointTable table(10000);
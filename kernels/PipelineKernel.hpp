@@ -68,6 +68,8 @@ private:
     int m_progressFd;
     bool m_usestdin;
     bool m_stream;
+    std::size_t m_threads;
+    Arg *m_threadsArg;
 };
 
 } // pdal
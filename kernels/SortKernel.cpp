@@ -61,20 +61,35 @@ void SortKernel::addSwitches(ProgramArgs& args)
     args.add("metadata,m",
         "Forward metadata (VLRs, header entries, etc) from previous stages",
         m_bForwardMetadata);
+    args.add("dims,d", "Dimensions on which to sort, most significant "
+        "first.  If not given, points are sorted in Morton order of X and Y",
+        m_dims);
+    args.add("order", "Sort order of 'dims', ASC(ending) or DESC(ending)",
+        m_order, "ASC");
 }
 
 
 int SortKernel::execute()
 {
     Stage& readerStage = makeReader(m_inputFile, m_driverOverride);
-    Stage& sortStage = makeFilter("filters.mortonorder", readerStage);
+    Stage *sortStage;
+    if (m_dims.empty())
+        sortStage = &makeFilter("filters.mortonorder", readerStage);
+    else
+    {
+        Options sortOptions;
+        for (auto& dim : m_dims)
+            sortOptions.add("dimension", dim);
+        sortOptions.add("order", m_order);
+        sortStage = &makeFilter("filters.sort", readerStage, sortOptions);
+    }
 
     Options writerOptions;
     if (m_bCompress)
         writerOptions.add("compression", true);
     if (m_bForwardMetadata)
         writerOptions.add("forward_metadata", true);
-    Stage& writer = makeWriter(m_outputFile, sortStage, "", writerOptions);
+    Stage& writer = makeWriter(m_outputFile, *sortStage, "", writerOptions);
 
     PointTable table;
     writer.prepare(table);
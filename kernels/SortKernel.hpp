@@ -58,6 +58,8 @@ private:
     std::string m_outputFile;
     bool m_bCompress;
     bool m_bForwardMetadata;
+    std::vector<std::string> m_dims;
+    std::string m_order;
 };
 
 } // namespace pdal
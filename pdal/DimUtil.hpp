@@ -35,6 +35,7 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <pdal/util/Utils.hpp>
@@ -103,6 +104,18 @@ inline BaseType base(Type t)
     return BaseType(Utils::toNative(t) & 0xFF00);
 }
 
+/// Get the type corresponding to an arithmetic C++ type.
+/// \return  Corresponding type enumeration value.
+template<typename T>
+inline Type type()
+{
+    static_assert(std::is_arithmetic<T>::value,
+        "Dimension type must be arithmetic.");
+    BaseType b = std::is_floating_point<T>::value ? BaseType::Floating :
+        std::is_signed<T>::value ? BaseType::Signed : BaseType::Unsigned;
+    return Type(unsigned(b) | sizeof(T));
+}
+
 static const int COUNT = std::numeric_limits<uint16_t>::max();
 static const int PROPRIETARY = 0xF000;
 
@@ -35,14 +35,20 @@
 #include <pdal/EigenUtils.hpp>
 #include <pdal/GDALUtils.hpp>
 #include <pdal/KDIndex.hpp>
+#include <pdal/Morphology.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/util/Bounds.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 
+#include <algorithm>
 #include <cfloat>
+#include <functional>
+#include <limits>
 #include <numeric>
 #include <vector>
 
@@ -107,9 +113,124 @@ uint8_t computeRank(PointView& view, std::vector<PointId> ids, double threshold)
     return static_cast<uint8_t>(svd.rank());
 }
 
+namespace
+{
+
+// Thin plate spline radial basis function, r^2 log(r), of a squared
+// distance.
+inline double tpsBasis(double rsqr)
+{
+    return rsqr == 0.0 ? 0.0 : 0.5 * rsqr * std::log10(rsqr);
+}
+
+// Wendland's C2 compactly supported radial basis function of a distance
+// scaled by the support radius.
+inline double wendlandBasis(double r)
+{
+    if (r >= 1.0)
+        return 0.0;
+    double t = 1.0 - r;
+    t *= t;
+    return t * t * (4.0 * r + 1.0);
+}
+
+// A thin plate spline fitted to the control points of a neighbourhood.
+struct LocalSpline
+{
+    Eigen::Vector3d m_affine;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_w;
+
+    double eval(double x, double y) const
+    {
+        double sum = m_affine(0) + m_affine(1) * x + m_affine(2) * y;
+        for (size_t j = 0; j < m_w.size(); ++j)
+        {
+            double dx = m_x[j] - x;
+            double dy = m_y[j] - y;
+            sum += m_w[j] * tpsBasis(dx * dx + dy * dy);
+        }
+        return sum;
+    }
+};
+
+// Fit a thin plate spline to the valid control points of a block.  Cells
+// with no control point (NaN) don't take part in the system.
+void fitLocalSpline(const Eigen::MatrixXd& x, const Eigen::MatrixXd& y,
+    const Eigen::MatrixXd& z, int rs, int cs, int row_size, int col_size,
+    LocalSpline& spline)
+{
+    using namespace Eigen;
+
+    spline.m_x.clear();
+    spline.m_y.clear();
+    std::vector<double> zs;
+    for (int c = cs; c < cs + col_size; ++c)
+        for (int r = rs; r < rs + row_size; ++r)
+        {
+            double xj = x(r, c);
+            double yj = y(r, c);
+            double zj = z(r, c);
+            if (std::isnan(xj) || std::isnan(yj) || std::isnan(zj))
+                continue;
+            spline.m_x.push_back(xj);
+            spline.m_y.push_back(yj);
+            zs.push_back(zj);
+        }
+
+    int nsize = (int)zs.size();
+    MatrixXd A = MatrixXd::Zero(nsize + 3, nsize + 3);
+    VectorXd b = VectorXd::Zero(nsize + 3);
+    for (int j = 0; j < nsize; ++j)
+    {
+        double xj = spline.m_x[j];
+        double yj = spline.m_y[j];
+        for (int k = j + 1; k < nsize; ++k)
+        {
+            double dx = xj - spline.m_x[k];
+            double dy = yj - spline.m_y[k];
+            A(j, k) = A(k, j) = tpsBasis(dx * dx + dy * dy);
+        }
+        A(j, nsize) = A(nsize, j) = 1.0;
+        A(j, nsize + 1) = A(nsize + 1, j) = xj;
+        A(j, nsize + 2) = A(nsize + 2, j) = yj;
+        b(j) = zs[j];
+    }
+
+    VectorXd sol = A.fullPivHouseholderQr().solve(b);
+    spline.m_affine = sol.tail(3);
+    spline.m_w.assign(sol.data(), sol.data() + nsize);
+}
+
+// Run func(begin, end) over [0, count) split into contiguous ranges.
+void runRanges(int count, size_t numThreads,
+    const std::function<void(int, int)>& func)
+{
+    if (numThreads == 0)
+        numThreads = ThreadPool::hardwareThreads();
+    int numTasks = (std::min)((int)(numThreads * 4), count);
+    if (numThreads <= 1 || numTasks <= 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    ThreadPool pool(numThreads);
+    for (int t = 0; t < numTasks; ++t)
+    {
+        int begin = (int)((int64_t)count * t / numTasks);
+        int end = (int)((int64_t)count * (t + 1) / numTasks);
+        pool.add([&func, begin, end](){ func(begin, end); });
+    }
+    pool.join();
+}
+
+} // unnamed namespace
+
 Eigen::MatrixXd computeSpline(Eigen::MatrixXd x, Eigen::MatrixXd y,
                               Eigen::MatrixXd z, Eigen::MatrixXd xx,
-                              Eigen::MatrixXd yy)
+                              Eigen::MatrixXd yy, size_t numThreads)
 {
     using namespace Eigen;
 
@@ -117,92 +238,194 @@ Eigen::MatrixXd computeSpline(Eigen::MatrixXd x, Eigen::MatrixXd y,
     int num_cols = xx.cols();
 
     MatrixXd S = MatrixXd::Zero(num_rows, num_cols);
+    if (!num_rows || !num_cols)
+        return S;
 
-    for (auto col = 0; col < num_cols; ++col)
-    {
-        for (auto row = 0; row < num_rows; ++row)
-        {
-            // Further optimizations are achieved by estimating only the
-            // interpolated surface within a local neighbourhood (e.g. a 7 x 7
-            // neighbourhood is used in our case) of the cell being filtered.
-            int radius = 3;
+    // Further optimizations are achieved by estimating only the
+    // interpolated surface within a local neighbourhood (e.g. a 7 x 7
+    // neighbourhood is used in our case) of the cell being filtered.
+    const int radius = 3;
 
-            int c = std::floor(col/2);
-            int r = std::floor(row/2);
+    // Each control cell is centered on a 2 x 2 block of output cells, which
+    // share the same neighbourhood.  The spline of a neighbourhood is fitted
+    // once and evaluated for each of the cells of its block.
+    const int ctrl_rows = (num_rows + 1) / 2;
+    const int ctrl_cols = (num_cols + 1) / 2;
 
+    auto process = [&](int begin, int end)
+    {
+        LocalSpline spline;
+        for (int c = begin; c < end; ++c)
+        {
             int cs = Utils::clamp(c-radius, 0, static_cast<int>(z.cols()-1));
             int ce = Utils::clamp(c+radius, 0, static_cast<int>(z.cols()-1));
             int col_size = ce - cs + 1;
-            int rs = Utils::clamp(r-radius, 0, static_cast<int>(z.rows()-1));
-            int re = Utils::clamp(r+radius, 0, static_cast<int>(z.rows()-1));
-            int row_size = re - rs + 1;
+            for (int r = 0; r < ctrl_rows; ++r)
+            {
+                int rs = Utils::clamp(r-radius, 0,
+                    static_cast<int>(z.rows()-1));
+                int re = Utils::clamp(r+radius, 0,
+                    static_cast<int>(z.rows()-1));
+                int row_size = re - rs + 1;
+
+                fitLocalSpline(x, y, z, rs, cs, row_size, col_size, spline);
+
+                for (int col = 2 * c; col < (std::min)(2 * c + 2, num_cols);
+                        ++col)
+                    for (int row = 2 * r;
+                            row < (std::min)(2 * r + 2, num_rows); ++row)
+                        S(row, col) = spline.eval(xx(row, col), yy(row, col));
+            }
+        }
+    };
+    runRanges(ctrl_cols, numThreads, process);
 
-            MatrixXd Xn = x.block(rs, cs, row_size, col_size);
-            MatrixXd Yn = y.block(rs, cs, row_size, col_size);
-            MatrixXd Hn = z.block(rs, cs, row_size, col_size);
+    return S;
+}
 
-            int nsize = row_size * col_size;
-            VectorXd T = VectorXd::Zero(nsize);
-            MatrixXd P = MatrixXd::Zero(nsize, 3);
-            MatrixXd K = MatrixXd::Zero(nsize, nsize);
+Eigen::MatrixXd computeCompactSpline(Eigen::MatrixXd x, Eigen::MatrixXd y,
+                                     Eigen::MatrixXd z, Eigen::MatrixXd xx,
+                                     Eigen::MatrixXd yy, double support,
+                                     size_t numThreads)
+{
+    using namespace Eigen;
 
-            for (auto id = 0; id < nsize; ++id)
+    if (support <= 0.0)
+        throw pdal_error("Spline support radius must be positive.");
+
+    int num_rows = xx.rows();
+    int num_cols = xx.cols();
+    MatrixXd S = MatrixXd::Zero(num_rows, num_cols);
+
+    // Gather the valid control points, relative to their centroid to keep
+    // the affine part well conditioned.
+    std::vector<double> px, py, pz;
+    double mx(0.0), my(0.0);
+    for (int i = 0; i < z.size(); ++i)
+    {
+        if (std::isnan(x(i)) || std::isnan(y(i)) || std::isnan(z(i)))
+            continue;
+        px.push_back(x(i));
+        py.push_back(y(i));
+        pz.push_back(z(i));
+        mx += x(i);
+        my += y(i);
+    }
+    int n = (int)pz.size();
+    if (n == 0)
+        return S;
+    mx /= n;
+    my /= n;
+    for (int j = 0; j < n; ++j)
+    {
+        px[j] -= mx;
+        py[j] -= my;
+    }
+
+    // The affine trend is a least squares plane.  The basis functions
+    // interpolate what remains.
+    MatrixXd P(n, 3);
+    VectorXd h(n);
+    for (int j = 0; j < n; ++j)
+    {
+        P.row(j) << 1.0, px[j], py[j];
+        h(j) = pz[j];
+    }
+    Vector3d a = P.colPivHouseholderQr().solve(h);
+    VectorXd d = h - P * a;
+
+    // Bucket the control points in square cells the size of the support
+    // radius so that only the adjacent cells need to be searched.
+    double minx = *std::min_element(px.begin(), px.end());
+    double miny = *std::min_element(py.begin(), py.end());
+    double maxx = *std::max_element(px.begin(), px.end());
+    double maxy = *std::max_element(py.begin(), py.end());
+    int bcols = (int)((maxx - minx) / support) + 1;
+    int brows = (int)((maxy - miny) / support) + 1;
+    auto bcol = [&](double v)
+        { return Utils::clamp((int)std::floor((v - minx) / support), -1,
+            bcols); };
+    auto brow = [&](double v)
+        { return Utils::clamp((int)std::floor((v - miny) / support), -1,
+            brows); };
+    std::vector<int> bstart(bcols * brows + 1, 0);
+    for (int j = 0; j < n; ++j)
+        bstart[bcol(px[j]) * brows + brow(py[j]) + 1]++;
+    std::partial_sum(bstart.begin(), bstart.end(), bstart.begin());
+    std::vector<int> bucketed(n);
+    {
+        std::vector<int> pos(bstart.begin(), bstart.end() - 1);
+        for (int j = 0; j < n; ++j)
+            bucketed[pos[bcol(px[j]) * brows + brow(py[j])]++] = j;
+    }
+
+    // Call func(j, phi) for each control point within the support radius
+    // of a position.
+    auto neighbors = [&](double qx, double qy,
+        const std::function<void(int, double)>& func)
+    {
+        int qc = bcol(qx);
+        int qr = brow(qy);
+        for (int c = (std::max)(qc - 1, 0); c <= (std::min)(qc + 1, bcols - 1);
+                ++c)
+            for (int r = (std::max)(qr - 1, 0);
+                    r <= (std::min)(qr + 1, brows - 1); ++r)
             {
-                double xj = Xn(id);
-                double yj = Yn(id);
-                double zj = Hn(id);
-                if (std::isnan(xj) || std::isnan(yj) || std::isnan(zj))
-                    continue;
-                T(id) = zj;
-                P.row(id) << 1, xj, yj;
-                for (auto id2 = 0; id2 < nsize; ++id2)
+                int b = c * brows + r;
+                for (int k = bstart[b]; k < bstart[b + 1]; ++k)
                 {
-                    if (id == id2)
-                        continue;
-                    double xk = Xn(id2);
-                    double yk = Yn(id2);
-                    double zk = Hn(id2);
-                    if (std::isnan(xk) || std::isnan(yk) || std::isnan(zk))
-                        continue;
-                    double rsqr = (xj - xk) * (xj - xk) + (yj - yk) * (yj - yk);
-                    if (rsqr == 0.0)
-                        continue;
-                    K(id, id2) = rsqr * std::log10(std::sqrt(rsqr));
+                    int j = bucketed[k];
+                    double dx = px[j] - qx;
+                    double dy = py[j] - qy;
+                    double dist = std::sqrt(dx * dx + dy * dy) / support;
+                    if (dist < 1.0)
+                        func(j, wendlandBasis(dist));
                 }
             }
+    };
 
-            MatrixXd A = MatrixXd::Zero(nsize+3, nsize+3);
-            A.block(0,0,nsize,nsize) = K;
-            A.block(0,nsize,nsize,3) = P;
-            A.block(nsize,0,3,nsize) = P.transpose();
-
-            VectorXd b = VectorXd::Zero(nsize+3);
-            b.head(nsize) = T;
-
-            VectorXd x = A.fullPivHouseholderQr().solve(b);
+    // The system of the compactly supported basis is sparse and positive
+    // definite.
+    std::vector<std::vector<Triplet<double>>> rows(n);
+    runRanges(n, numThreads, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+            neighbors(px[i], py[i], [&rows, i](int j, double phi)
+                { rows[i].emplace_back(i, j, phi); });
+    });
+    std::vector<Triplet<double>> triplets;
+    for (auto& r : rows)
+    {
+        triplets.insert(triplets.end(), r.begin(), r.end());
+        std::vector<Triplet<double>>().swap(r);
+    }
+    SparseMatrix<double> K(n, n);
+    K.setFromTriplets(triplets.begin(), triplets.end());
+    std::vector<Triplet<double>>().swap(triplets);
 
-            Vector3d a = x.tail(3);
-            VectorXd w = x.head(nsize);
+    SimplicialLDLT<SparseMatrix<double>> solver(K);
+    if (solver.info() != Success)
+        throw pdal_error("Unable to solve compactly supported spline.");
+    VectorXd w = solver.solve(d);
 
-            double sum = 0.0;
-            double xi2 = xx(row, col);
-            double yi2 = yy(row, col);
-            for (auto j = 0; j < nsize; ++j)
+    runRanges(num_cols, numThreads, [&](int begin, int end)
+    {
+        for (int col = begin; col < end; ++col)
+            for (int row = 0; row < num_rows; ++row)
             {
-                double xj = Xn(j);
-                double yj = Yn(j);
-                double zj = Hn(j);
-                if (std::isnan(xj) || std::isnan(yj) || std::isnan(zj))
-                    continue;
-                double rsqr = (xj - xi2) * (xj - xi2) + (yj - yi2) * (yj - yi2);
-                if (rsqr == 0.0)
+                double qx = xx(row, col) - mx;
+                double qy = yy(row, col) - my;
+                if (std::isnan(qx) || std::isnan(qy))
+                {
+                    S(row, col) = std::numeric_limits<double>::quiet_NaN();
                     continue;
-                sum += w(j) * rsqr * std::log10(std::sqrt(rsqr));
+                }
+                double sum = a(0) + a(1) * qx + a(2) * qy;
+                neighbors(qx, qy, [&sum, &w](int j, double phi)
+                    { sum += w(j) * phi; });
+                S(row, col) = sum;
             }
-
-            S(row, col) = a(0) + a(1)*xi2 + a(2)*yi2 + sum;
-        }
-    }
+    });
 
     return S;
 }
@@ -346,193 +569,58 @@ Eigen::MatrixXd extendedLocalMinimum(PointView& view, int rows, int cols,
     return ZImin;
 }
 
-Eigen::MatrixXd matrixClose(Eigen::MatrixXd data, int radius)
+namespace
 {
-    using namespace Eigen;
-
-    MatrixXd data2 = padMatrix(data, radius);
-
-    int nrows = data2.rows();
-    int ncols = data2.cols();
 
-    MatrixXd minZ(nrows, ncols);
-    minZ.setConstant(std::numeric_limits<double>::max());
-    MatrixXd maxZ(nrows, ncols);
-    maxZ.setConstant(std::numeric_limits<double>::lowest());
-    for (auto c = 0; c < ncols; ++c)
-    {
-        int cs = Utils::clamp(c-radius, 0, ncols-1);
-        int ce = Utils::clamp(c+radius, 0, ncols-1);
-
-        for (auto r = 0; r < nrows; ++r)
-        {
-            int rs = Utils::clamp(r-radius, 0, nrows-1);
-            int re = Utils::clamp(r+radius, 0, nrows-1);
-
-            for (auto col = cs; col <= ce; ++col)
-            {
-                for (auto row = rs; row <= re; ++row)
-                {
-                    if ((row-r)*(row-r)+(col-c)*(col-c) > radius*radius)
-                        continue;
-                    if (data2(row, col) > maxZ(r, c))
-                        maxZ(r, c) = data2(row, col);
-                }
-            }
-        }
-    }
-    for (auto c = 0; c < ncols; ++c)
-    {
-        int cs = Utils::clamp(c-radius, 0, ncols-1);
-        int ce = Utils::clamp(c+radius, 0, ncols-1);
-
-        for (auto r = 0; r < nrows; ++r)
-        {
-            int rs = Utils::clamp(r-radius, 0, nrows-1);
-            int re = Utils::clamp(r+radius, 0, nrows-1);
-
-            for (auto col = cs; col <= ce; ++col)
-            {
-                for (auto row = rs; row <= re; ++row)
-                {
-                    if ((row-r)*(row-r)+(col-c)*(col-c) > radius*radius)
-                        continue;
-                    if (maxZ(row, col) < minZ(r, c))
-                        minZ(r, c) = maxZ(row, col);
-                }
-            }
-        }
-    }
-
-    return minZ.block(radius, radius, data.rows(), data.cols());
-}
-
-Eigen::MatrixXd matrixOpen(Eigen::MatrixXd data, int radius)
+// Apply a disk-shaped opening or closing to a symmetrically padded copy of
+// a matrix.
+Eigen::MatrixXd matrixMorph(const Eigen::MatrixXd& data, int radius,
+    bool open, size_t numThreads)
 {
     using namespace Eigen;
 
     MatrixXd data2 = padMatrix(data, radius);
 
-    int nrows = data2.rows();
-    int ncols = data2.cols();
-
-    MatrixXd minZ(nrows, ncols);
-    minZ.setConstant(std::numeric_limits<double>::max());
-    MatrixXd maxZ(nrows, ncols);
-    maxZ.setConstant(std::numeric_limits<double>::lowest());
-    for (auto c = 0; c < ncols; ++c)
-    {
-        int cs = Utils::clamp(c-radius, 0, ncols-1);
-        int ce = Utils::clamp(c+radius, 0, ncols-1);
-
-        for (auto r = 0; r < nrows; ++r)
-        {
-            int rs = Utils::clamp(r-radius, 0, nrows-1);
-            int re = Utils::clamp(r+radius, 0, nrows-1);
-
-            for (auto col = cs; col <= ce; ++col)
-            {
-                for (auto row = rs; row <= re; ++row)
-                {
-                    if ((row-r)*(row-r)+(col-c)*(col-c) > radius*radius)
-                        continue;
-                    if (data2(row, col) < minZ(r, c))
-                        minZ(r, c) = data2(row, col);
-                }
-            }
-        }
-    }
-    for (auto c = 0; c < ncols; ++c)
-    {
-        int cs = Utils::clamp(c-radius, 0, ncols-1);
-        int ce = Utils::clamp(c+radius, 0, ncols-1);
-
-        for (auto r = 0; r < nrows; ++r)
-        {
-            int rs = Utils::clamp(r-radius, 0, nrows-1);
-            int re = Utils::clamp(r+radius, 0, nrows-1);
+    // Eigen matrices are column major by default, like Morphology rasters.
+    std::vector<double> raster(data2.data(), data2.data() + data2.size());
+    if (open)
+        Morphology::open(raster, data2.rows(), data2.cols(),
+            Morphology::Shape::Disk, radius, numThreads);
+    else
+        Morphology::close(raster, data2.rows(), data2.cols(),
+            Morphology::Shape::Disk, radius, numThreads);
+    Map<MatrixXd> out(raster.data(), data2.rows(), data2.cols());
+
+    return out.block(radius, radius, data.rows(), data.cols());
+}
 
-            for (auto col = cs; col <= ce; ++col)
-            {
-                for (auto row = rs; row <= re; ++row)
-                {
-                    if ((row-r)*(row-r)+(col-c)*(col-c) > radius*radius)
-                        continue;
-                    if (minZ(row, col) > maxZ(r, c))
-                        maxZ(r, c) = minZ(row, col);
-                }
-            }
-        }
-    }
+} // unnamed namespace
 
-    return maxZ.block(radius, radius, data.rows(), data.cols());
+Eigen::MatrixXd matrixClose(Eigen::MatrixXd data, int radius,
+    size_t numThreads)
+{
+    return matrixMorph(data, radius, false, numThreads);
 }
 
-std::vector<double> dilateDiamond(std::vector<double> data, size_t rows, size_t cols, int iterations)
+Eigen::MatrixXd matrixOpen(Eigen::MatrixXd data, int radius,
+    size_t numThreads)
 {
-    std::vector<double> out(data.size(), std::numeric_limits<double>::lowest());
-    std::vector<size_t> idx(5);
+    return matrixMorph(data, radius, true, numThreads);
+}
 
-    for (int iter = 0; iter < iterations; ++iter)
-    {
-        for (size_t col = 0; col < cols; ++col)
-        {
-            size_t index = col*rows;
-            for (size_t row = 0; row < rows; ++row)
-            {
-                size_t j = 0;
-                idx[j++] = index+row;
-                if (row > 0)
-                    idx[j++] = idx[0]-1;
-                if (row < rows-1)
-                    idx[j++] = idx[0]+1;
-                if (col > 0)
-                    idx[j++] = idx[0]-rows;
-                if (col < cols-1)
-                    idx[j++] = idx[0]+rows;
-                for (size_t i = 0; i < j; ++i)
-                {
-                    if (data[idx[i]] > out[index+row])
-                        out[index+row] = data[idx[i]];
-                }
-            }
-        }
-        data.swap(out);
-    }
+std::vector<double> dilateDiamond(std::vector<double> data, size_t rows,
+    size_t cols, int iterations, size_t numThreads)
+{
+    Morphology::dilate(data, rows, cols, Morphology::Shape::Diamond,
+        iterations, numThreads);
     return data;
 }
 
-std::vector<double> erodeDiamond(std::vector<double> data, size_t rows, size_t cols, int iterations)
+std::vector<double> erodeDiamond(std::vector<double> data, size_t rows,
+    size_t cols, int iterations, size_t numThreads)
 {
-    std::vector<double> out(data.size(), std::numeric_limits<double>::max());
-    std::vector<size_t> idx(5);
-
-    for (int iter = 0; iter < iterations; ++iter)
-    {
-        for (size_t col = 0; col < cols; ++col)
-        {
-            size_t index = col*rows;
-            for (size_t row = 0; row < rows; ++row)
-            {
-                size_t j = 0;
-                idx[j++] = index+row;
-                if (row > 0)
-                    idx[j++] = idx[0]-1;
-                if (row < rows-1)
-                    idx[j++] = idx[0]+1;
-                if (col > 0)
-                    idx[j++] = idx[0]-rows;
-                if (col < cols-1)
-                    idx[j++] = idx[0]+rows;
-                for (size_t i = 0; i < j; ++i)
-                {
-                    if (data[idx[i]] < out[index+row])
-                        out[index+row] = data[idx[i]];
-                }
-            }
-        }
-        data.swap(out);
-    }
+    Morphology::erode(data, rows, cols, Morphology::Shape::Diamond,
+        iterations, numThreads);
     return data;
 }
 
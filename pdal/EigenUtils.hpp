@@ -300,9 +300,11 @@ PDAL_DLL Eigen::MatrixXd extendedLocalMinimum(PointView& view, int rows,
 
   \param data the input matrix.
   \param radius the radius of the circular structuring element.
+  \param numThreads the number of threads to use.
   \return the morphological closing of the input radius.
 */
-PDAL_DLL Eigen::MatrixXd matrixClose(Eigen::MatrixXd data, int radius);
+PDAL_DLL Eigen::MatrixXd matrixClose(Eigen::MatrixXd data, int radius,
+                                     size_t numThreads = 1);
 
 /**
   Perform a morphological opening of the input matrix.
@@ -313,47 +315,51 @@ PDAL_DLL Eigen::MatrixXd matrixClose(Eigen::MatrixXd data, int radius);
 
   \param data the input matrix.
   \param radius the radius of the circular structuring element.
+  \param numThreads the number of threads to use.
   \return the morphological opening of the input radius.
 */
-PDAL_DLL Eigen::MatrixXd matrixOpen(Eigen::MatrixXd data, int radius);
+PDAL_DLL Eigen::MatrixXd matrixOpen(Eigen::MatrixXd data, int radius,
+                                    size_t numThreads = 1);
 
 /**
   Perform a morphological dilation of the input raster.
 
   Performs a morphological dilation of the input raster using a diamond
-  structuring element. Larger structuring elements are approximated by applying
-  multiple iterations of the opening operation. The input and output rasters are
-  stored in column major order.
+  structuring element whose radius is the number of iterations of a
+  five-cell diamond. The input and output rasters are stored in column major
+  order. See Morphology::dilate().
 
   \param data the input raster.
   \param rows the number of rows.
   \param cols the number of cols.
-  \param iterations the number of iterations used to approximate a larger 
-         structuring element.
+  \param iterations the radius of the structuring element.
+  \param numThreads the number of threads to use.
   \return the morphological dilation of the input raster.
 */
 PDAL_DLL std::vector<double> dilateDiamond(std::vector<double> data,
                                            size_t rows, size_t cols,
-                                           int iterations);
+                                           int iterations,
+                                           size_t numThreads = 1);
 
 /**
   Perform a morphological erosion of the input raster.
 
   Performs a morphological erosion of the input raster using a diamond
-  structuring element. Larger structuring elements are approximated by applying
-  multiple iterations of the opening operation. The input and output rasters are
-  stored in column major order.
+  structuring element whose radius is the number of iterations of a
+  five-cell diamond. The input and output rasters are stored in column major
+  order. See Morphology::erode().
 
   \param data the input raster.
   \param rows the number of rows.
   \param cols the number of cols.
-  \param iterations the number of iterations used to approximate a larger 
-         structuring element.
+  \param iterations the radius of the structuring element.
+  \param numThreads the number of threads to use.
   \return the morphological erosion of the input raster.
 */
 PDAL_DLL std::vector<double> erodeDiamond(std::vector<double> data,
                                           size_t rows, size_t cols,
-                                          int iterations);
+                                          int iterations,
+                                          size_t numThreads = 1);
 
 /**
   Pad input matrix symmetrically.
@@ -936,16 +942,50 @@ PDAL_DLL Derived erode(const Eigen::MatrixBase<Derived>& A, int radius)
 /**
   Thin Plate Spline interpolation.
 
+  The input data is a grid of control points at half the resolution of the
+  points to be interpolated; NaN marks cells without a control point.  Each
+  value is interpolated with a spline fitted to the 7 x 7 neighbourhood of
+  control points around it.  A spline is fitted once for each control cell
+  and reused for the 2 x 2 interpolated cells it covers.
+
   \param x the x coordinate of the input data.
   \param y the y coordinate of the input data.
   \param z the z coordinate of the input data.
   \param xx the x coordinate of the points to be interpolated.
   \param yy the y coordinate of the points to be interpolated.
+  \param numThreads the number of threads to use.
   \return the values of the interpolated data at xx and yy.
 */
 PDAL_DLL Eigen::MatrixXd computeSpline(Eigen::MatrixXd x, Eigen::MatrixXd y,
                                        Eigen::MatrixXd z, Eigen::MatrixXd xx,
-                                       Eigen::MatrixXd yy);
+                                       Eigen::MatrixXd yy,
+                                       size_t numThreads = 1);
+
+/**
+  Compactly supported radial basis function interpolation.
+
+  Fits a least squares plane to all of the input data and interpolates the
+  residuals with Wendland's C2 radial basis function, which is zero beyond
+  the support radius.  This yields a single sparse, positive definite system
+  rather than one dense system per neighbourhood.  NaN marks missing input
+  data.
+
+  \param x the x coordinate of the input data.
+  \param y the y coordinate of the input data.
+  \param z the z coordinate of the input data.
+  \param xx the x coordinate of the points to be interpolated.
+  \param yy the y coordinate of the points to be interpolated.
+  \param support the support radius of the basis function.
+  \param numThreads the number of threads to use.
+  \return the values of the interpolated data at xx and yy.
+*/
+PDAL_DLL Eigen::MatrixXd computeCompactSpline(Eigen::MatrixXd x,
+                                              Eigen::MatrixXd y,
+                                              Eigen::MatrixXd z,
+                                              Eigen::MatrixXd xx,
+                                              Eigen::MatrixXd yy,
+                                              double support,
+                                              size_t numThreads = 1);
 
 
 } // namespace eigen
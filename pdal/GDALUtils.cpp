@@ -37,6 +37,7 @@
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <map>
 
@@ -332,6 +333,9 @@ Raster::Raster(const std::string& filename, const std::string& drivername)
     , m_numBands(0)
     , m_drivername(drivername)
     , m_ds(0)
+    , m_blockWidth(0)
+    , m_blockHeight(0)
+    , m_blockCacheSize(64 * 1024 * 1024)
 {
     m_forwardTransform.fill(0);
     m_forwardTransform[1] = 1;
@@ -352,6 +356,9 @@ Raster::Raster(const std::string& filename, const std::string& drivername,
     , m_forwardTransform(pixelToPos)
     , m_srs(srs)
     , m_ds(0)
+    , m_blockWidth(0)
+    , m_blockHeight(0)
+    , m_blockCacheSize(64 * 1024 * 1024)
 {}
 
 
@@ -633,11 +640,41 @@ GDALError Raster::read(double x, double y, std::vector<double>& data)
         return GDALError::NotOpen;
     }
 
-    int32_t pixel(0);
-    int32_t line(0);
     data.resize(m_numBands);
+    return readPoint(x, y, data.data());
+}
+
+
+GDALError Raster::read(const std::vector<double>& xs,
+    const std::vector<double>& ys, std::vector<double>& data,
+    std::vector<bool>& valid)
+{
+    if (!m_ds)
+    {
+        m_errorMsg = "Raster not open.";
+        return GDALError::NotOpen;
+    }
+
+    const size_t count = (std::min)(xs.size(), ys.size());
+    data.resize(count * m_numBands);
+    valid.assign(count, false);
+    for (size_t i = 0; i < count; ++i)
+    {
+        GDALError error = readPoint(xs[i], ys[i], data.data() + i * m_numBands);
+        if (error == GDALError::None)
+            valid[i] = true;
+        else if (error != GDALError::NoData)
+            return error;
+    }
+    return GDALError::None;
+}
 
-    std::array<double, 2> pix = { {0.0, 0.0} };
+
+// Fetch the value of each band at x/y from the block cache.
+GDALError Raster::readPoint(double x, double y, double *data)
+{
+    int32_t pixel(0);
+    int32_t line(0);
 
     // No data at this x,y if we can't compute a pixel/line location
     // for it.
@@ -646,22 +683,107 @@ GDALError Raster::read(double x, double y, std::vector<double>& data)
         m_errorMsg = "Requested location is not in the raster.";
         return GDALError::NoData;
     }
+    if (m_numBands == 0)
+        return GDALError::None;
 
-    for (int i=0; i < m_numBands; ++i)
+    if (m_blockWidth == 0)
     {
-        GDALRasterBandH b = GDALGetRasterBand(m_ds, i + 1);
-        if (GDALRasterIO(b, GF_Read, pixel, line, 1, 1,
-            &pix[0], 1, 1, GDT_Float64, 0, 0) == CE_None)
+        m_ds->GetRasterBand(1)->GetBlockSize(&m_blockWidth, &m_blockHeight);
+        if (m_blockWidth <= 0 || m_blockHeight <= 0)
         {
-            // we read a pixel put its values in our vector
-            data[i] = pix[0];
+            m_blockWidth = (std::min)(m_width, 256);
+            m_blockHeight = (std::min)(m_height, 256);
         }
     }
 
+    const CachedBlock *block =
+        fetchBlock(pixel / m_blockWidth, line / m_blockHeight);
+    if (!block)
+        return GDALError::CantReadBlock;
+
+    int col = pixel % m_blockWidth;
+    int row = line % m_blockHeight;
+    const double *src = block->m_data.data() +
+        ((size_t)row * block->m_width + col) * m_numBands;
+    std::copy(src, src + m_numBands, data);
     return GDALError::None;
 }
 
 
+// Find a block in the cache, reading it from the raster if necessary.
+// Reading a block evicts the least recently used block when the cache
+// is full.
+const Raster::CachedBlock *Raster::fetchBlock(int xBlock, int yBlock)
+{
+    const int xBlockCnt = ((m_width - 1) / m_blockWidth) + 1;
+    const uint64_t key = (uint64_t)yBlock * xBlockCnt + xBlock;
+
+    // Consecutive points usually fall in the same block.
+    if (m_blocks.size() && m_blocks.front().m_key == key)
+        return &m_blocks.front();
+
+    auto it = m_blockIndex.find(key);
+    if (it != m_blockIndex.end())
+    {
+        m_blocks.splice(m_blocks.begin(), m_blocks, it->second);
+        return &m_blocks.front();
+    }
+
+    const size_t blockBytes =
+        (size_t)m_blockWidth * m_blockHeight * m_numBands * sizeof(double);
+    const size_t maxBlocks = (std::max)((size_t)1,
+        m_blockCacheSize / blockBytes);
+    while (m_blocks.size() >= maxBlocks)
+    {
+        m_blockIndex.erase(m_blocks.back().m_key);
+        m_blocks.pop_back();
+    }
+
+    // Blocks at the right and bottom edges may be partial.
+    const int xOff = xBlock * m_blockWidth;
+    const int yOff = yBlock * m_blockHeight;
+    const int width = (std::min)(m_blockWidth, m_width - xOff);
+    const int height = (std::min)(m_blockHeight, m_height - yOff);
+
+    CachedBlock block;
+    block.m_key = key;
+    block.m_width = width;
+    block.m_data.resize((size_t)width * height * m_numBands);
+
+    // Read all bands in one call, interleaved by pixel.
+    const int pixelSpace = m_numBands * sizeof(double);
+    if (GDALDatasetRasterIO((GDALDatasetH)m_ds, GF_Read, xOff, yOff,
+        width, height, block.m_data.data(), width, height, GDT_Float64,
+        m_numBands, nullptr, pixelSpace, pixelSpace * width,
+        sizeof(double)) != CE_None)
+    {
+        std::ostringstream oss;
+        oss << "Unable to read block (" << xBlock << ", " << yBlock <<
+            ") from raster '" << m_filename << "'.";
+        m_errorMsg = oss.str();
+        return nullptr;
+    }
+
+    m_blocks.push_front(std::move(block));
+    m_blockIndex[key] = m_blocks.begin();
+    return &m_blocks.front();
+}
+
+
+void Raster::setBlockCacheSize(size_t bytes)
+{
+    m_blockCacheSize = bytes;
+    clearBlockCache();
+}
+
+
+void Raster::clearBlockCache()
+{
+    m_blocks.clear();
+    m_blockIndex.clear();
+}
+
+
 SpatialReference Raster::getSpatialRef() const
 {
     SpatialReference srs;
@@ -683,6 +805,9 @@ void Raster::close()
     delete m_ds;
     m_ds = nullptr;
     m_types.clear();
+    clearBlockCache();
+    m_blockWidth = 0;
+    m_blockHeight = 0;
 }
 
 } // namespace gdal
@@ -43,8 +43,10 @@
 
 #include <array>
 #include <functional>
+#include <list>
 #include <mutex>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 #include <cpl_conv.h>
@@ -611,6 +613,7 @@ public:
     GDALError writeBand(SOURCE_ITER si, ITER_VAL<SOURCE_ITER> srcNoData,
         int nBand, const std::string& name = "")
     {
+        clearBlockCache();
         try
         {
             switch(m_bandType)
@@ -682,6 +685,32 @@ public:
     */
     GDALError read(double x, double y, std::vector<double>& data);
 
+    /**
+      Read the data for each band at a set of x/y positions.  Positions
+      are transformed to the basis of the raster before the data is
+      fetched.  The values for all bands of the first position are
+      followed by those for the second position, and so on.  Positions
+      that don't fall in the raster are flagged as invalid and their
+      values are left unset.
+
+      \param xs  X positions to read.
+      \param ys  Y positions to read.  Must be the same size as \a xs.
+      \param[out] data  Vector in which to store data.
+      \param[out] valid  Vector in which to store whether the data for
+        each position was read.
+    */
+    GDALError read(const std::vector<double>& xs,
+        const std::vector<double>& ys, std::vector<double>& data,
+        std::vector<bool>& valid);
+
+    /**
+      Set the maximum amount of memory used to cache raster blocks
+      when reading point values.  At least one block is always cached.
+
+      \param bytes  Size of the block cache in bytes.
+    */
+    void setBlockCacheSize(size_t bytes);
+
     /**
       Get a vector of dimensions that map to the bands of a raster.
     */
@@ -751,9 +780,27 @@ private:
     mutable std::vector<pdal::Dimension::Type> m_types;
     std::vector<std::array<double, 2>> m_block_sizes;
 
+    // Values of all bands for a block, pixel-interleaved.
+    struct CachedBlock
+    {
+        uint64_t m_key;
+        int m_width;
+        std::vector<double> m_data;
+    };
+    typedef std::list<CachedBlock> BlockList;
+
+    int m_blockWidth;
+    int m_blockHeight;
+    size_t m_blockCacheSize;
+    BlockList m_blocks;       // Most recently used first.
+    std::unordered_map<uint64_t, BlockList::iterator> m_blockIndex;
+
     GDALError validateType(Dimension::Type& type, GDALDriver *driver);
     bool getPixelAndLinePosition(double x, double y,
         int32_t& pixel, int32_t& line);
+    GDALError readPoint(double x, double y, double *data);
+    const CachedBlock *fetchBlock(int xBlock, int yBlock);
+    void clearBlockCache();
     GDALError computePDALDimensionTypes();
 };
 
@@ -35,10 +35,13 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <nanoflann/nanoflann.hpp>
 
 #include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace nanoflann
 {
@@ -52,6 +55,91 @@ namespace nanoflann
 namespace pdal
 {
 
+/**
+  The neighbors of each point of a point view, stored contiguously.  The
+  neighbors of a point are ordered by increasing distance and include the
+  point itself.
+*/
+class PDAL_DLL NeighborTable
+{
+    template<int DIM> friend class KDIndex;
+
+public:
+    NeighborTable() : m_offsets(1, 0)
+    {}
+
+    /**
+      Get the number of points for which neighbors are stored.
+
+      \return  Number of points.
+    */
+    point_count_t size() const
+        { return m_offsets.size() - 1; }
+
+    /**
+      Get the number of neighbors of a point.
+
+      \param idx  ID of the point.
+      \return  Number of neighbors.
+    */
+    std::size_t count(PointId idx) const
+        { return m_offsets[idx + 1] - m_offsets[idx]; }
+
+    /**
+      Get the IDs of the neighbors of a point.
+
+      \param idx  ID of the point.
+      \return  Pointer to \ref count() neighbor IDs.
+    */
+    const PointId *ids(PointId idx) const
+        { return m_ids.data() + m_offsets[idx]; }
+
+    /**
+      Get the square distances to the neighbors of a point.
+
+      \param idx  ID of the point.
+      \return  Pointer to \ref count() square distances.
+    */
+    const double *sqrDists(PointId idx) const
+        { return m_sqrDists.data() + m_offsets[idx]; }
+
+    /**
+      Get the IDs of the neighbors of a point as a vector.
+
+      \param idx  ID of the point.
+      \return  Neighbor IDs.
+    */
+    std::vector<PointId> neighbors(PointId idx) const
+        { return std::vector<PointId>(ids(idx), ids(idx) + count(idx)); }
+
+    /**
+      Make a table of at most the first k neighbors of each point.
+
+      \param k  Maximum number of neighbors of each point.
+      \return  New neighbor table.
+    */
+    NeighborTable first(std::size_t k) const
+    {
+        NeighborTable table;
+        table.m_offsets.reserve(m_offsets.size());
+        for (PointId idx = 0; idx < size(); ++idx)
+        {
+            std::size_t n = (std::min)(k, count(idx));
+            table.m_ids.insert(table.m_ids.end(), ids(idx), ids(idx) + n);
+            table.m_sqrDists.insert(table.m_sqrDists.end(), sqrDists(idx),
+                sqrDists(idx) + n);
+            table.m_offsets.push_back(table.m_ids.size());
+        }
+        return table;
+    }
+
+private:
+    // Neighbors of point i are at [m_offsets[i], m_offsets[i + 1]).
+    std::vector<std::size_t> m_offsets;
+    std::vector<PointId> m_ids;
+    std::vector<double> m_sqrDists;
+};
+
 template<int DIM>
 class PDAL_DLL KDIndex
 {
@@ -63,28 +151,229 @@ protected:
     {}
 
 public:
-    std::size_t kdtree_get_point_count() const
-        { return m_buf.size(); }
+    /// Default maximum number of points in a leaf of the tree.
+    static const std::size_t DefaultLeafSize = 100;
 
-    double kdtree_get_pt(const PointId idx, int dim) const;
-    double kdtree_distance(const double *p1, const PointId p2_idx,
-        size_t /*numDims*/) const;
-    template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const;
-    void build()
-    {
-        m_index.reset(new my_kd_tree_t(DIM, *this, nanoflann::KDTreeSingleIndexAdaptorParams(100)));
+    std::size_t kdtree_get_point_count() const
+        { return m_coords.size() / DIM; }
+
+    double kdtree_get_pt(const PointId idx, int dim) const
+        { return m_coords[idx * DIM + dim]; }
+
+    // nanoflann hands us a vector that represents the position of p1.  We
+    // fetch the position of p2 and and compute the square distance.
+    double kdtree_distance(const double *p1, const PointId idx,
+        size_t /*numDims*/) const
+    {
+        const double *p2 = m_coords.data() + idx * DIM;
+        double dist = 0;
+        for (int i = 0; i < DIM; ++i)
+        {
+            double d = p1[i] - p2[i];
+            dist += d * d;
+        }
+        return dist;
+    }
+
+    template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const
+    {
+        for (int i = 0; i < DIM; ++i)
+        {
+            bb[i].low = m_low[i];
+            bb[i].high = m_high[i];
+        }
+        return true;
+    }
+
+    /**
+      Build the index.  The positions of the points are copied from the
+      point view, so changes to the positions made after the index is built
+      aren't reflected in queries.
+
+      \param leafSize  Maximum number of points in a leaf of the tree.
+        Smaller leaves make for faster queries of few neighbors at the
+        cost of a larger tree.
+    */
+    void build(std::size_t leafSize = DefaultLeafSize)
+    {
+        const Dimension::Id ids[] =
+            { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+
+        m_coords.resize(m_buf.size() * DIM);
+        for (int i = 0; i < DIM; ++i)
+        {
+            m_low[i] = 0.0;
+            m_high[i] = 0.0;
+        }
+        double *pos = m_coords.data();
+        for (PointId idx = 0; idx < m_buf.size(); ++idx)
+            for (int i = 0; i < DIM; ++i)
+            {
+                double d = m_buf.getFieldAs<double>(ids[i], idx);
+                if (idx == 0 || d < m_low[i])
+                    m_low[i] = d;
+                if (idx == 0 || d > m_high[i])
+                    m_high[i] = d;
+                *pos++ = d;
+            }
+
+        m_index.reset(new my_kd_tree_t(DIM, *this,
+            nanoflann::KDTreeSingleIndexAdaptorParams(leafSize)));
         m_index->buildIndex();
     }
 
+    /**
+      Find the k nearest neighbors of every point in the index.
+
+      \param k  Number of neighbors to find for each point.  Limited to the
+        number of points in the index.
+      \param numThreads  Number of threads with which to run the queries.
+        If zero, the number of hardware threads is used.
+      \return  Table of neighbors.
+    */
+    NeighborTable knnSearchAll(point_count_t k,
+        std::size_t numThreads = 1) const
+    {
+        const point_count_t np = kdtree_get_point_count();
+        k = (std::min)(np, k);
+
+        NeighborTable table;
+        table.m_offsets.resize(np + 1);
+        for (PointId i = 0; i <= np; ++i)
+            table.m_offsets[i] = i * k;
+        table.m_ids.resize(np * k);
+        table.m_sqrDists.resize(np * k);
+
+        runAll(np, numThreads, [this, k, &table](PointId first, PointId last)
+        {
+            for (PointId i = first; i < last; ++i)
+            {
+                nanoflann::KNNResultSet<double, PointId, point_count_t>
+                    resultSet(k);
+                resultSet.init(table.m_ids.data() + i * k,
+                    table.m_sqrDists.data() + i * k);
+                m_index->findNeighbors(resultSet, position(i),
+                    nanoflann::SearchParams());
+            }
+        });
+        return table;
+    }
+
+    /**
+      Find the neighbors within a radius of every point in the index.
+
+      \param r  Search radius.
+      \param numThreads  Number of threads with which to run the queries.
+        If zero, the number of hardware threads is used.
+      \return  Table of neighbors.
+    */
+    NeighborTable radiusSearchAll(double r, std::size_t numThreads = 1) const
+    {
+        typedef std::vector<std::pair<std::size_t, double>> Matches;
+
+        const point_count_t np = kdtree_get_point_count();
+
+        // Each block of points gets its own list of matches and counts,
+        // which are concatenated when all queries are done.
+        const point_count_t blockSize = blockSizeFor(np, numThreads);
+        const std::size_t numBlocks = (np + blockSize - 1) / blockSize;
+        std::vector<Matches> blockMatches(numBlocks);
+        std::vector<std::size_t> counts(np);
+
+        runAll(np, numThreads,
+            [this, r, blockSize, &blockMatches, &counts](PointId first,
+                PointId last)
+        {
+            Matches& matches = blockMatches[first / blockSize];
+            Matches ret;
+            nanoflann::SearchParams params;
+            params.sorted = true;
+            for (PointId i = first; i < last; ++i)
+            {
+                // Our distance metric is square distance, so we use the
+                // square of the radius.
+                counts[i] = m_index->radiusSearch(position(i), r * r, ret,
+                    params);
+                matches.insert(matches.end(), ret.begin(), ret.end());
+            }
+        });
+
+        NeighborTable table;
+        table.m_offsets.resize(np + 1);
+        for (PointId i = 0; i < np; ++i)
+            table.m_offsets[i + 1] = table.m_offsets[i] + counts[i];
+        table.m_ids.reserve(table.m_offsets[np]);
+        table.m_sqrDists.reserve(table.m_offsets[np]);
+        for (Matches& matches : blockMatches)
+        {
+            for (auto& m : matches)
+            {
+                table.m_ids.push_back(m.first);
+                table.m_sqrDists.push_back(m.second);
+            }
+            Matches().swap(matches);
+        }
+        return table;
+    }
+
 protected:
     const PointView& m_buf;
 
+    // Position of a point, copied from the point view when the index is
+    // built.  Points added to the view after that aren't in the index.
+    const double *position(PointId idx) const
+    {
+        if (idx >= m_coords.size() / DIM)
+            throw pdal_error("KDIndex: point ID " + std::to_string(idx) +
+                " is not in the index.");
+        return m_coords.data() + idx * DIM;
+    }
+
     typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<
-        double, KDIndex, double>, KDIndex, -1, std::size_t> my_kd_tree_t;
+        double, KDIndex, double>, KDIndex, DIM, std::size_t> my_kd_tree_t;
 
     std::unique_ptr<my_kd_tree_t> m_index;
 
 private:
+    // Number of points queried by each task of a batch query.
+    static point_count_t blockSizeFor(point_count_t np,
+        std::size_t numThreads)
+    {
+        if (numThreads == 0)
+            numThreads = ThreadPool::hardwareThreads();
+        // Several blocks per thread balance the load when some parts of
+        // the cloud are denser than others.
+        point_count_t blockSize = np / (numThreads * 8) + 1;
+        return (std::max)(blockSize, (point_count_t)1024);
+    }
+
+    // Call f(first, last) for consecutive blocks of point IDs covering
+    // [0, np), on numThreads threads.
+    template<typename F>
+    void runAll(point_count_t np, std::size_t numThreads, F f) const
+    {
+        const point_count_t blockSize = blockSizeFor(np, numThreads);
+        if (numThreads == 1 || np <= blockSize)
+        {
+            for (PointId first = 0; first < np; first += blockSize)
+                f(first, (std::min)(first + blockSize, np));
+            return;
+        }
+
+        ThreadPool pool(numThreads);
+        for (PointId first = 0; first < np; first += blockSize)
+        {
+            PointId last = (std::min)(first + blockSize, np);
+            pool.add([&f, first, last](){ f(first, last); });
+        }
+        pool.join();
+    }
+
+    // Point positions, packed by point ID, and their bounds.
+    std::vector<double> m_coords;
+    double m_low[DIM];
+    double m_high[DIM];
+
     KDIndex(const KDIndex&);
     KDIndex& operator=(KDIndex&);
 };
@@ -136,8 +425,9 @@ public:
 
     std::vector<PointId> neighbors(PointId idx, point_count_t k)
     {
-        double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
+        const double *p = position(idx);
+        double x = p[0];
+        double y = p[1];
 
         return neighbors(x, y, k);
     }
@@ -167,8 +457,9 @@ public:
     void knnSearch(PointId idx, point_count_t k, std::vector<PointId> *indices,
         std::vector<double> *sqr_dists)
     {
-        double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
+        const double *p = position(idx);
+        double x = p[0];
+        double y = p[1];
 
         knnSearch(x, y, k, indices, sqr_dists);
     }
@@ -197,8 +488,9 @@ public:
 
     std::vector<PointId> radius(PointId idx, double const& r) const
     {
-        double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
+        const double *p = position(idx);
+        double x = p[0];
+        double y = p[1];
 
         return radius(x, y, r);
     }
@@ -263,9 +555,10 @@ public:
 
     std::vector<PointId> neighbors(PointId idx, point_count_t k)
     {
-        double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
+        const double *p = position(idx);
+        double x = p[0];
+        double y = p[1];
+        double z = p[2];
 
         return neighbors(x, y, z, k);
     }
@@ -297,9 +590,10 @@ public:
     void knnSearch(PointId idx, point_count_t k, std::vector<PointId> *indices,
         std::vector<double> *sqr_dists)
     {
-        double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
+        const double *p = position(idx);
+        double x = p[0];
+        double y = p[1];
+        double z = p[2];
 
         knnSearch(x, y, z, k, indices, sqr_dists);
     }
@@ -338,9 +632,10 @@ public:
 
     std::vector<PointId> radius(PointId idx, double r) const
     {
-        double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-        double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
+        const double *p = position(idx);
+        double x = p[0];
+        double y = p[1];
+        double z = p[2];
 
         return radius(x, y, z, r);
     }
@@ -356,129 +651,4 @@ public:
 
 };
 
-template<>
-inline
-double KDIndex<2>::kdtree_get_pt(const PointId idx, int dim) const
-{
-    if (idx >= m_buf.size())
-        return 0.0;
-
-    Dimension::Id id = Dimension::Id::Unknown;
-    switch (dim)
-    {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    default:
-        throw pdal_error("kdtree_get_pt: Request for invalid dimension "
-            "from nanoflann");
-    }
-    return m_buf.getFieldAs<double>(id, idx);
-}
-
-template<>
-inline
-double KDIndex<3>::kdtree_get_pt(const PointId idx, int dim) const
-{
-    if (idx >= m_buf.size())
-        return 0.0;
-
-    Dimension::Id id = Dimension::Id::Unknown;
-    switch (dim)
-    {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    case 2:
-        id = Dimension::Id::Z;
-        break;
-    default:
-        throw pdal_error("kdtree_get_pt: Request for invalid dimension "
-            "from nanoflann");
-    }
-    return m_buf.getFieldAs<double>(id, idx);
-}
-
-// nanoflann hands us a vector that represents the position of p1.  We fetch
-// the position of p2 and and compute the square distance.
-template<>
-inline double KDIndex<2>::kdtree_distance(const double *p1, const PointId idx,
-    size_t /*numDims*/) const
-{
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-
-    return (d0 * d0 + d1 * d1);
-}
-
-template<>
-inline double KDIndex<3>::kdtree_distance(const double *p1, const PointId idx,
-    size_t /*numDims*/) const
-{
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-    double d2 = p1[2] - m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
-
-    return (d0 * d0 + d1 * d1 + d2 * d2);
-}
-
-
-template<>
-template <class BBOX>
-bool KDIndex<2>::kdtree_get_bbox(BBOX& bb) const
-{
-    if (m_buf.empty())
-    {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
-    }
-    else
-    {
-        BOX2D bounds;
-        m_buf.calculateBounds(bounds);
-
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-    }
-    return true;
-}
-
-template<>
-template <class BBOX>
-bool KDIndex<3>::kdtree_get_bbox(BBOX& bb) const
-{
-    if (m_buf.empty())
-    {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
-        bb[2].low = 0.0;
-        bb[2].high = 0.0;
-    }
-    else
-    {
-        BOX3D bounds;
-        m_buf.calculateBounds(bounds);
-
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-        bb[2].low = bounds.minz;
-        bb[2].high = bounds.maxz;
-    }
-    return true;
-}
-
 } // namespace pdal
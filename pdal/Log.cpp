@@ -45,6 +45,7 @@ Log::Log(std::string const& leaderString,
          std::string const& outputName)
     : m_level(LogLevel::Warning)
     , m_deleteStreamOnCleanup(false)
+    , m_leader(leaderString)
 {
 
     if (Utils::iequals(outputName, "stdlog"))
@@ -60,7 +61,6 @@ Log::Log(std::string const& leaderString,
         m_log = Utils::createFile(outputName);
         m_deleteStreamOnCleanup = true;
     }
-    m_leaders.push(leaderString);
 }
 
 
@@ -68,9 +68,9 @@ Log::Log(std::string const& leaderString,
          std::ostream* v)
     : m_level(LogLevel::Error)
     , m_deleteStreamOnCleanup(false)
+    , m_leader(leaderString)
 {
     m_log = v;
-    m_leaders.push(leaderString);
 }
 
 
@@ -85,6 +85,77 @@ Log::~Log()
 }
 
 
+void Log::pushLeader(const std::string& leader)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_leaders[std::this_thread::get_id()].push(leader);
+}
+
+
+std::string Log::leader() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return currentLeader();
+}
+
+
+// Leader of the calling thread.  The mutex must be held.
+std::string Log::currentLeader() const
+{
+    auto it = m_leaders.find(std::this_thread::get_id());
+    if (it == m_leaders.end())
+        return m_leader;
+    return it->second.empty() ? std::string() : it->second.top();
+}
+
+
+void Log::popLeader()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_leaders.find(std::this_thread::get_id());
+    if (it == m_leaders.end())
+        return;
+    it->second.pop();
+    if (it->second.empty())
+        m_leaders.erase(it);
+}
+
+
+void Log::startCapture()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_ptr<std::ostringstream>& buf =
+        m_captures[std::this_thread::get_id()];
+    if (!buf)
+    {
+        buf.reset(new std::ostringstream);
+        buf->copyfmt(*m_log);
+    }
+}
+
+
+std::string Log::endCapture()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_captures.find(std::this_thread::get_id());
+    if (it == m_captures.end())
+        return std::string();
+    std::string text = it->second->str();
+    m_captures.erase(it);
+    return text;
+}
+
+
+void Log::write(const std::string& text)
+{
+    if (text.empty())
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *m_log << text;
+    m_log->flush();
+}
+
+
 void Log::floatPrecision(int level)
 {
     m_log->setf(std::ios_base::fixed, std::ios_base::floatfield);
@@ -106,15 +177,23 @@ std::ostream& Log::get(LogLevel level)
     const auto nativeDebug(Utils::toNative(LogLevel::Debug));
     if (incoming <= stored)
     {
-        const std::string l = leader();
-
-        *m_log << "(" << l;
+        std::ostream *out = m_log;
+        std::string l;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            l = currentLeader();
+            auto it = m_captures.find(std::this_thread::get_id());
+            if (it != m_captures.end())
+                out = it->second.get();
+        }
+
+        *out << "(" << l;
          if (l.size())
-             *m_log << " ";
-         *m_log << getLevelString(level) <<") " <<
+             *out << " ";
+         *out << getLevelString(level) <<") " <<
          std::string(incoming < nativeDebug ? 0 : incoming - nativeDebug,
              '\t');
-        return *m_log;
+        return *out;
     }
     return m_nullStream;
 }
@@ -35,8 +35,12 @@
 #pragma once
 
 #include <cassert>
+#include <map>
 #include <memory> // shared_ptr
+#include <mutex>
+#include <sstream>
 #include <stack>
+#include <thread>
 
 #include <pdal/pdal_internal.hpp>
 #include <pdal/util/NullOStream.hpp>
@@ -91,22 +95,19 @@ public:
     void setLeader(const std::string& leader)
         { pushLeader(leader); }
 
-    /// Push the leader string onto the stack.
+    /// Push the leader string onto the stack.  Each thread has a stack
+    /// of its own, so that stages running on different threads can push
+    /// their leaders concurrently.
     /// \param  leader  Leader string
-    void pushLeader(const std::string& leader)
-        { m_leaders.push(leader); }
+    void pushLeader(const std::string& leader);
 
-    /// Get the leader string.
+    /// Get the leader string.  A thread that hasn't pushed a leader gets
+    /// the leader with which the log was constructed.
     /// \return  The current leader string.
-    std::string leader() const
-        { return m_leaders.empty() ? std::string() : m_leaders.top(); }
+    std::string leader() const;
 
     /// Pop the current leader string.
-    void popLeader()
-    {
-        if (!m_leaders.empty())
-            m_leaders.pop();
-    }
+    void popLeader();
 
     /// @return A string representing the LogLevel
     std::string getLevelString(LogLevel v) const;
@@ -126,6 +127,21 @@ public:
     /// pdal::Log::get is less than the logging level of the pdal::Log instance
     std::ostream& get(LogLevel level = LogLevel::Info);
 
+    /// Send the log output of the calling thread to a buffer instead of
+    /// the log stream, until \ref endCapture() is called.  This lets
+    /// stages running on other threads log without writing to the stream
+    /// at the same time as another thread.
+    void startCapture();
+
+    /// Stop capturing the log output of the calling thread.
+    /// \return  The output captured since \ref startCapture().
+    std::string endCapture();
+
+    /// Write text, such as output captured from another thread, to the
+    /// log stream.
+    /// \param  text  Text to write.
+    void write(const std::string& text);
+
     /// Sets the floating point precision
     void floatPrecision(int level);
 
@@ -139,9 +155,15 @@ private:
     Log(const Log&);
     Log& operator =(const Log&);
 
+    std::string currentLeader() const;
+
     LogLevel m_level;
     bool m_deleteStreamOnCleanup;
-    std::stack<std::string> m_leaders;
+    std::string m_leader;
+    std::map<std::thread::id, std::stack<std::string>> m_leaders;
+    std::map<std::thread::id, std::unique_ptr<std::ostringstream>>
+        m_captures;
+    mutable std::mutex m_mutex;
     NullOStream m_nullStream;
 };
 
@@ -0,0 +1,367 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/Morphology.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace pdal
+{
+
+namespace Morphology
+{
+
+namespace
+{
+
+struct MinOp
+{
+    double operator()(double a, double b) const
+        { return (std::min)(a, b); }
+    static double neutral()
+        { return (std::numeric_limits<double>::max)(); }
+};
+
+struct MaxOp
+{
+    double operator()(double a, double b) const
+        { return (std::max)(a, b); }
+    static double neutral()
+        { return std::numeric_limits<double>::lowest(); }
+};
+
+// Rasters smaller than this are always processed on a single thread.
+const size_t MinParallelCells = 1 << 16;
+
+// Run fn(first, last) over ranges that together cover [0, count).
+void parallel(size_t count, size_t cells, size_t numThreads,
+    const std::function<void(size_t, size_t)>& fn)
+{
+    if (numThreads == 0)
+        numThreads = ThreadPool::hardwareThreads();
+    numThreads = (std::min)(numThreads, count);
+    if (numThreads <= 1 || cells < MinParallelCells)
+    {
+        fn(0, count);
+        return;
+    }
+
+    ThreadPool pool(numThreads);
+    size_t per = (count + numThreads - 1) / numThreads;
+    for (size_t first = 0; first < count; first += per)
+    {
+        size_t last = (std::min)(first + per, count);
+        pool.add([&fn, first, last](){ fn(first, last); });
+    }
+    pool.join();
+}
+
+// Van Herk/Gil-Werman running min/max over a window of half-width w of a
+// strided line of n values.  Positions beyond the ends of the line are
+// ignored.  g and h are scratch buffers.  src and dst may be the same.
+template <typename Op>
+void filterLine(const double *src, std::ptrdiff_t srcStride, double *dst,
+    std::ptrdiff_t dstStride, size_t n, size_t w, std::vector<double>& g,
+    std::vector<double>& h)
+{
+    Op op;
+
+    // A window wider than the line covers all of it.
+    w = (std::min)(w, n);
+    if (w == 0)
+    {
+        if (src != dst)
+            for (size_t i = 0; i < n; ++i)
+                dst[i * dstStride] = src[i * srcStride];
+        return;
+    }
+
+    // The line is padded by w neutral values on each side and split into
+    // blocks the size of the window.  g holds the running result from the
+    // start of each block and h from the end.  Any window spans at most two
+    // blocks, so its result is the combination of one h and one g value.
+    const size_t k = 2 * w + 1;
+    const size_t len = n + 2 * w;
+    g.resize(len);
+    h.resize(len);
+
+    auto val = [&](size_t j)
+    {
+        return (j < w || j >= n + w) ? Op::neutral() :
+            src[(std::ptrdiff_t)(j - w) * srcStride];
+    };
+
+    for (size_t j = 0; j < len; ++j)
+        g[j] = (j % k == 0) ? val(j) : op(g[j - 1], val(j));
+    for (size_t j = len; j-- > 0;)
+        h[j] = (j % k == k - 1 || j == len - 1) ? val(j) :
+            op(h[j + 1], val(j));
+    for (size_t i = 0; i < n; ++i)
+        dst[i * dstStride] = op(h[i], g[i + 2 * w]);
+}
+
+template <typename Op>
+void square(std::vector<double>& data, size_t rows, size_t cols, size_t r,
+    size_t numThreads)
+{
+    // The square is separable into a vertical and a horizontal line.
+    // Columns are contiguous.
+    parallel(cols, data.size(), numThreads, [&](size_t first, size_t last)
+    {
+        std::vector<double> g, h;
+        for (size_t c = first; c < last; ++c)
+        {
+            double *col = data.data() + c * rows;
+            filterLine<Op>(col, 1, col, 1, rows, r, g, h);
+        }
+    });
+    parallel(rows, data.size(), numThreads, [&](size_t first, size_t last)
+    {
+        std::vector<double> g, h;
+        for (size_t row = first; row < last; ++row)
+        {
+            double *line = data.data() + row;
+            filterLine<Op>(line, rows, line, rows, cols, r, g, h);
+        }
+    });
+}
+
+// Apply a five-cell cross to a raster.
+template <typename Op>
+void cross(std::vector<double>& data, size_t rows, size_t cols,
+    size_t numThreads)
+{
+    Op op;
+
+    std::vector<double> src(data);
+    parallel(cols, data.size(), numThreads, [&](size_t first, size_t last)
+    {
+        for (size_t c = first; c < last; ++c)
+            for (size_t r = 0; r < rows; ++r)
+            {
+                size_t i = c * rows + r;
+                double v = src[i];
+                if (r > 0)
+                    v = op(v, src[i - 1]);
+                if (r < rows - 1)
+                    v = op(v, src[i + 1]);
+                if (c > 0)
+                    v = op(v, src[i - rows]);
+                if (c < cols - 1)
+                    v = op(v, src[i + rows]);
+                data[i] = v;
+            }
+    });
+}
+
+// Apply a line of half-length m along the diagonal (down-right) or the
+// anti-diagonal (up-right).
+template <typename Op>
+void diagonal(std::vector<double>& data, size_t rows, size_t cols, size_t m,
+    bool anti, size_t numThreads)
+{
+    if (m == 0)
+        return;
+
+    // Each line starts in the first column or, for the remaining lines, in
+    // the first (diagonal) or last (anti-diagonal) row.
+    const std::ptrdiff_t stride = anti ? (std::ptrdiff_t)rows - 1 :
+        (std::ptrdiff_t)rows + 1;
+    parallel(rows + cols - 1, data.size(), numThreads,
+        [&](size_t first, size_t last)
+    {
+        std::vector<double> g, h;
+        for (size_t l = first; l < last; ++l)
+        {
+            size_t row, col;
+            if (l < rows)
+            {
+                row = l;
+                col = 0;
+            }
+            else
+            {
+                row = anti ? rows - 1 : 0;
+                col = l - rows + 1;
+            }
+            size_t len = (std::min)(anti ? row + 1 : rows - row, cols - col);
+            double *line = data.data() + col * rows + row;
+            filterLine<Op>(line, stride, line, stride, len, m, g, h);
+        }
+    });
+}
+
+template <typename Op>
+void diamond(std::vector<double>& data, size_t rows, size_t cols, size_t r,
+    size_t numThreads)
+{
+    Op op;
+
+    // The diamond is decomposed into lines along the two diagonals, which
+    // reach every other cell of a diamond of radius 2m, combined with a
+    // cross that reaches the cells in between.
+    //   Diamond(2m + 1) = Cross + Diag(m) + AntiDiag(m)
+    //   Diamond(2m) = (Diag(m) + AntiDiag(m)) U
+    //       (Cross + Diag(m - 1) + AntiDiag(m - 1))
+    // Intermediate results are needed outside the raster, so it's padded
+    // with neutral values.
+    const size_t prows = rows + 2 * r;
+    const size_t pcols = cols + 2 * r;
+    std::vector<double> padded(prows * pcols, Op::neutral());
+    for (size_t c = 0; c < cols; ++c)
+        std::copy(data.begin() + c * rows, data.begin() + (c + 1) * rows,
+            padded.begin() + (c + r) * prows + r);
+
+    const size_t m = r / 2;
+    std::vector<double> even;
+    if (r % 2 == 0)
+    {
+        even = padded;
+        diagonal<Op>(even, prows, pcols, m, false, numThreads);
+        diagonal<Op>(even, prows, pcols, m, true, numThreads);
+    }
+    cross<Op>(padded, prows, pcols, numThreads);
+    size_t odd = (r % 2) ? m : m - 1;
+    diagonal<Op>(padded, prows, pcols, odd, false, numThreads);
+    diagonal<Op>(padded, prows, pcols, odd, true, numThreads);
+
+    for (size_t c = 0; c < cols; ++c)
+        for (size_t row = 0; row < rows; ++row)
+        {
+            size_t i = (c + r) * prows + row + r;
+            double v = padded[i];
+            if (even.size())
+                v = op(v, even[i]);
+            data[c * rows + row] = v;
+        }
+}
+
+template <typename Op>
+void disk(std::vector<double>& data, size_t rows, size_t cols, size_t r,
+    size_t numThreads)
+{
+    Op op;
+
+    // Each column offset dc of the disk is a vertical line with half-length
+    // floor(sqrt(r * r - dc * dc)).
+    std::vector<size_t> widths(r + 1);
+    for (size_t dc = 0; dc <= r; ++dc)
+    {
+        size_t rem = r * r - dc * dc;
+        size_t w = (size_t)std::sqrt((double)rem);
+        while (w * w > rem)
+            w--;
+        while ((w + 1) * (w + 1) <= rem)
+            w++;
+        widths[dc] = w;
+    }
+
+    std::vector<double> src(data);
+    parallel(cols, data.size(), numThreads, [&](size_t first, size_t last)
+    {
+        std::vector<double> g, h, line(rows);
+        for (size_t c = first; c < last; ++c)
+        {
+            double *out = data.data() + c * rows;
+            std::fill(out, out + rows, Op::neutral());
+            size_t cfirst = c > r ? c - r : 0;
+            size_t clast = (std::min)(c + r, cols - 1);
+            for (size_t cc = cfirst; cc <= clast; ++cc)
+            {
+                size_t dc = cc > c ? cc - c : c - cc;
+                filterLine<Op>(src.data() + cc * rows, 1, line.data(), 1,
+                    rows, widths[dc], g, h);
+                for (size_t i = 0; i < rows; ++i)
+                    out[i] = op(out[i], line[i]);
+            }
+        }
+    });
+}
+
+template <typename Op>
+void morph(std::vector<double>& data, size_t rows, size_t cols, Shape shape,
+    int radius, size_t numThreads)
+{
+    if (radius <= 0 || rows == 0 || cols == 0)
+        return;
+
+    size_t r = (size_t)radius;
+    switch (shape)
+    {
+    case Shape::Diamond:
+        diamond<Op>(data, rows, cols, r, numThreads);
+        break;
+    case Shape::Square:
+        square<Op>(data, rows, cols, r, numThreads);
+        break;
+    case Shape::Disk:
+        disk<Op>(data, rows, cols, r, numThreads);
+        break;
+    }
+}
+
+} // unnamed namespace
+
+void erode(std::vector<double>& data, size_t rows, size_t cols, Shape shape,
+    int radius, size_t numThreads)
+{
+    morph<MinOp>(data, rows, cols, shape, radius, numThreads);
+}
+
+void dilate(std::vector<double>& data, size_t rows, size_t cols, Shape shape,
+    int radius, size_t numThreads)
+{
+    morph<MaxOp>(data, rows, cols, shape, radius, numThreads);
+}
+
+void open(std::vector<double>& data, size_t rows, size_t cols, Shape shape,
+    int radius, size_t numThreads)
+{
+    erode(data, rows, cols, shape, radius, numThreads);
+    dilate(data, rows, cols, shape, radius, numThreads);
+}
+
+void close(std::vector<double>& data, size_t rows, size_t cols, Shape shape,
+    int radius, size_t numThreads)
+{
+    dilate(data, rows, cols, shape, radius, numThreads);
+    erode(data, rows, cols, shape, radius, numThreads);
+}
+
+} // namespace Morphology
+} // namespace pdal
@@ -0,0 +1,130 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/pdal_export.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace pdal
+{
+
+namespace Morphology
+{
+
+/**
+  Shape of a structuring element.  An element of radius r contains the cells
+  at offset (dr, dc) where:
+
+  - Diamond: |dr| + |dc| <= r
+  - Square: max(|dr|, |dc|) <= r
+  - Disk: dr * dr + dc * dc <= r * r
+*/
+enum class Shape
+{
+    Diamond,
+    Square,
+    Disk
+};
+
+/**
+  Perform a morphological erosion of a raster in place.
+
+  Diamond and square erosions are computed with the van Herk/Gil-Werman
+  algorithm, so their cost doesn't depend on the radius.  A disk is
+  decomposed into one line per column offset and costs O(radius) per cell.
+  Cells of the structuring element that fall outside the raster are ignored.
+  The raster is stored in column major order.
+
+  \param data the raster.
+  \param rows the number of rows.
+  \param cols the number of columns.
+  \param shape the shape of the structuring element.
+  \param radius the radius of the structuring element.
+  \param numThreads the number of threads to use.  Zero means the number of
+         hardware threads.
+*/
+PDAL_DLL void erode(std::vector<double>& data, size_t rows, size_t cols,
+                    Shape shape, int radius, size_t numThreads = 1);
+
+/**
+  Perform a morphological dilation of a raster in place.
+
+  See erode() for details.
+
+  \param data the raster.
+  \param rows the number of rows.
+  \param cols the number of columns.
+  \param shape the shape of the structuring element.
+  \param radius the radius of the structuring element.
+  \param numThreads the number of threads to use.  Zero means the number of
+         hardware threads.
+*/
+PDAL_DLL void dilate(std::vector<double>& data, size_t rows, size_t cols,
+                     Shape shape, int radius, size_t numThreads = 1);
+
+/**
+  Perform a morphological opening (erosion followed by dilation) of a raster
+  in place.
+
+  \param data the raster.
+  \param rows the number of rows.
+  \param cols the number of columns.
+  \param shape the shape of the structuring element.
+  \param radius the radius of the structuring element.
+  \param numThreads the number of threads to use.  Zero means the number of
+         hardware threads.
+*/
+PDAL_DLL void open(std::vector<double>& data, size_t rows, size_t cols,
+                   Shape shape, int radius, size_t numThreads = 1);
+
+/**
+  Perform a morphological closing (dilation followed by erosion) of a raster
+  in place.
+
+  \param data the raster.
+  \param rows the number of rows.
+  \param cols the number of columns.
+  \param shape the shape of the structuring element.
+  \param radius the radius of the structuring element.
+  \param numThreads the number of threads to use.  Zero means the number of
+         hardware threads.
+*/
+PDAL_DLL void close(std::vector<double>& data, size_t rows, size_t cols,
+                    Shape shape, int radius, size_t numThreads = 1);
+
+} // namespace Morphology
+} // namespace pdal
@@ -46,7 +46,7 @@ namespace pdal
 
 PipelineManager::PipelineManager() : m_factory(new StageFactory),
     m_tablePtr(new PointTable()), m_table(*m_tablePtr),
-    m_progressFd(-1), m_input(nullptr)
+    m_progressFd(-1), m_threads(1), m_input(nullptr)
 {}
 
 
@@ -191,6 +191,8 @@ QuickInfo PipelineManager::preview() const
 void PipelineManager::prepare() const
 {
     validateStageOptions();
+    for (Stage *stage : m_stages)
+        stage->setThreads(m_threads);
     Stage *s = getStage();
     if (s)
        s->prepare(m_table);
@@ -222,6 +224,8 @@ void PipelineManager::executeStream(FixedPointTable& table)
     if (!s)
         return;
 
+    for (Stage *stage : m_stages)
+        stage->setThreads(m_threads);
     s->prepare(table);
     s->execute(table);
 }
@@ -68,6 +68,13 @@ public:
     void setProgressFd(int fd)
         { m_progressFd = fd; }
 
+    // Set the maximum number of threads each stage may use to run its
+    // point views.  Zero means the number of hardware threads.
+    void setThreads(std::size_t threads)
+        { m_threads = threads; }
+    std::size_t threads() const
+        { return m_threads; }
+
     void readPipeline(std::istream& input);
     void readPipeline(const std::string& filename);
 
@@ -151,6 +158,7 @@ private:
     PointViewSet m_viewSet;
     std::vector<Stage*> m_stages; // stage observer, never owner
     int m_progressFd;
+    std::size_t m_threads;
     std::istream *m_input;
     LogPtr m_log;
 
@@ -150,6 +150,14 @@ void PipelineReaderJSON::readPipeline(std::istream& input)
     Json::Value& subtree = root["pipeline"];
     if (!subtree)
         throw pdal_error("JSON pipeline: Root element is not a Pipeline");
+    if (root.isMember("threads"))
+    {
+        Json::Value& threads = root["threads"];
+        if (!threads.isUInt())
+            throw pdal_error("JSON pipeline: 'threads' must be specified "
+                "as a non-negative integer.");
+        m_manager.setThreads(threads.asUInt());
+    }
     parsePipeline(subtree);
 }
 
@@ -0,0 +1,192 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/PointSort.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/RadixSort.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace pdal
+{
+namespace PointSort
+{
+
+namespace
+{
+
+// Run func(begin, end) over the points of a view, split into chunks.
+void runChunks(point_count_t count, size_t numThreads,
+    const std::function<void(PointId, PointId)>& func)
+{
+    const point_count_t MinChunk = 65536;
+    size_t numChunks = (std::min)((point_count_t)numThreads,
+        count / MinChunk);
+    if (numChunks <= 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    ThreadPool pool(numChunks);
+    for (size_t c = 0; c < numChunks; ++c)
+    {
+        PointId begin = count * c / numChunks;
+        PointId end = count * (c + 1) / numChunks;
+        pool.add([&func, begin, end](){ func(begin, end); });
+    }
+    pool.join();
+}
+
+// Shift the sort key of a dimension into the low bits of the keys of the
+// points.
+template<typename T>
+void appendKey(const PointView& view, const Key& key,
+    std::vector<uint64_t>& keys, size_t numThreads)
+{
+    const int Bits = sizeof(T) * 8;
+    const uint64_t mask = (Bits == 64) ? ~0ULL : ((1ULL << Bits) - 1);
+    const T *column = view.column<T>(key.m_dim);
+
+    runChunks(view.size(), numThreads, [&](PointId begin, PointId end)
+    {
+        for (PointId i = begin; i < end; ++i)
+        {
+            T val = column ? column[i] : view.getFieldAs<T>(key.m_dim, i);
+            uint64_t k = Utils::radixKey(val);
+            if (key.m_descending)
+                k = ~k & mask;
+            keys[i] = (Bits == 64) ? k : ((keys[i] << (Bits % 64)) | k);
+        }
+    });
+}
+
+void appendKey(const PointView& view, const Key& key,
+    std::vector<uint64_t>& keys, size_t numThreads)
+{
+    using namespace Dimension;
+
+    switch (view.dimType(key.m_dim))
+    {
+    case Type::Float:
+        appendKey<float>(view, key, keys, numThreads);
+        break;
+    case Type::Double:
+        appendKey<double>(view, key, keys, numThreads);
+        break;
+    case Type::Signed8:
+        appendKey<int8_t>(view, key, keys, numThreads);
+        break;
+    case Type::Signed16:
+        appendKey<int16_t>(view, key, keys, numThreads);
+        break;
+    case Type::Signed32:
+        appendKey<int32_t>(view, key, keys, numThreads);
+        break;
+    case Type::Signed64:
+        appendKey<int64_t>(view, key, keys, numThreads);
+        break;
+    case Type::Unsigned8:
+        appendKey<uint8_t>(view, key, keys, numThreads);
+        break;
+    case Type::Unsigned16:
+        appendKey<uint16_t>(view, key, keys, numThreads);
+        break;
+    case Type::Unsigned32:
+        appendKey<uint32_t>(view, key, keys, numThreads);
+        break;
+    case Type::Unsigned64:
+        appendKey<uint64_t>(view, key, keys, numThreads);
+        break;
+    case Type::None:
+        break;
+    }
+}
+
+} // unnamed namespace
+
+
+std::vector<PointId> order(PointView& view, const std::vector<Key>& keys,
+    size_t numThreads)
+{
+    if (numThreads == 0)
+        numThreads = ThreadPool::hardwareThreads();
+
+    const point_count_t count = view.size();
+    std::vector<PointId> positions(count);
+    for (PointId i = 0; i < count; ++i)
+        positions[i] = i;
+    if (count < 2)
+        return positions;
+
+    // Group the keys, least significant first, into composite keys of at
+    // most 64 bits.  Since the radix sort is stable, sorting by each
+    // composite key in turn sorts by all of them.
+    std::vector<uint64_t> composite(count);
+    size_t last = keys.size();
+    while (last > 0)
+    {
+        size_t first = last - 1;
+        size_t bits = Dimension::size(view.dimType(keys[first].m_dim)) * 8;
+        while (first > 0)
+        {
+            Dimension::Type t = view.dimType(keys[first - 1].m_dim);
+            size_t b = Dimension::size(t) * 8;
+            if (bits + b > 64)
+                break;
+            bits += b;
+            first--;
+        }
+
+        std::fill(composite.begin(), composite.end(), 0);
+        for (size_t k = first; k < last; ++k)
+            appendKey(view, keys[k], composite, numThreads);
+        Utils::radixSort(positions,
+            [&composite](PointId p){ return composite[p]; }, numThreads);
+        last = first;
+    }
+    return positions;
+}
+
+
+void sort(PointView& view, const std::vector<Key>& keys, size_t numThreads)
+{
+    view.reorder(order(view, keys, numThreads));
+}
+
+} // namespace PointSort
+} // namespace pdal
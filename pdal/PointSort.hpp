@@ -0,0 +1,98 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <pdal/Dimension.hpp>
+#include <pdal/pdal_export.hpp>
+#include <pdal/pdal_types.hpp>
+
+#include <vector>
+
+namespace pdal
+{
+
+class PointView;
+
+namespace PointSort
+{
+
+/**
+  A dimension by which points are sorted.
+*/
+struct Key
+{
+    Key(Dimension::Id dim = Dimension::Id::Unknown, bool descending = false) :
+        m_dim(dim), m_descending(descending)
+    {}
+
+    Dimension::Id m_dim;
+    bool m_descending;
+};
+
+/**
+  Find the sorted order of the points of a view.
+
+  The value of each key dimension is read once for every point and
+  converted to an unsigned integer that sorts in the same order.  The
+  positions of the points are then radix sorted by those integers.  Keys
+  that fit together in 64 bits are sorted in a single pass.  The sort is
+  stable: points with equal keys stay in view order, even when sorting in
+  descending order.  Floating-point values are ordered by their bits, so
+  NaNs sort after infinity, or before negative infinity if their sign bit
+  is set.
+
+  \param view  View whose points are sorted.
+  \param keys  Sort dimensions, most significant first.
+  \param numThreads  Number of threads used to sort.  If zero, the number
+    of hardware threads is used.
+  \return  Position in the view of each point in sorted order.
+*/
+PDAL_DLL std::vector<PointId> order(PointView& view,
+    const std::vector<Key>& keys, size_t numThreads = 1);
+
+/**
+  Sort the points of a view.  See \ref order().
+
+  \param view  View to sort.
+  \param keys  Sort dimensions, most significant first.
+  \param numThreads  Number of threads used to sort.  If zero, the number
+    of hardware threads is used.
+*/
+PDAL_DLL void sort(PointView& view, const std::vector<Key>& keys,
+    size_t numThreads = 1);
+
+} // namespace PointSort
+} // namespace pdal
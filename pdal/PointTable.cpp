@@ -34,6 +34,8 @@
 
 #include <pdal/PointTable.hpp>
 
+#include <cstdint>
+
 namespace pdal
 {
 
@@ -82,18 +84,31 @@ void SimplePointTable::getFieldInternal(Dimension::Id id, PointId idx,
 
 PointTable::~PointTable()
 {
-    for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
-        delete [] *vi;
+    for (size_t list = 0; list < m_maxLists && m_lists[list]; ++list)
+    {
+        for (size_t block = 0; block < m_listBlockCnt; ++block)
+            delete [] m_lists[list][block];
+        delete [] m_lists[list];
+    }
 }
 
 PointId PointTable::addPoint()
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
     if (m_numPts % m_blockPtCnt == 0)
     {
+        point_count_t block = m_numPts / m_blockPtCnt;
+        size_t list = block / m_listBlockCnt;
+        if (list == m_maxLists)
+            throw pdal_error("Point table is full.");
+        if (!m_lists[list])
+            m_lists[list] = new char *[m_listBlockCnt]();
+
         size_t size = pointsToBytes(m_blockPtCnt);
         char *buf = new char[size];
         memset(buf, 0, size);
-        m_blocks.push_back(buf);
+        m_lists[list][block % m_listBlockCnt] = buf;
     }
     return m_numPts++;
 }
@@ -101,11 +116,88 @@ PointId PointTable::addPoint()
 
 char *PointTable::getPoint(PointId idx)
 {
-    char *buf = m_blocks[idx / m_blockPtCnt];
+    point_count_t block = idx / m_blockPtCnt;
+    char *buf = m_lists[block / m_listBlockCnt][block % m_listBlockCnt];
     return buf + pointsToBytes(idx % m_blockPtCnt);
 }
 
 
+char *ColumnPointTable::column(Dimension::Id id)
+{
+    std::size_t i = Utils::toNative(id);
+    return i < m_columns.size() ? m_columns[i].m_data : nullptr;
+}
+
+
+PointId ColumnPointTable::addPoint()
+{
+    // Dimensions may have been registered since storage was allocated.
+    if (m_numPts == m_capacity)
+        grow((std::max)(m_capacity * 2, m_minCapacity));
+    else if (m_layoutRef.dims().size() != m_numDims)
+        grow(m_capacity);
+    return m_numPts++;
+}
+
+
+// Reallocate the storage of every column, keeping existing values and
+// zeroing new ones.
+void ColumnPointTable::grow(point_count_t capacity)
+{
+    if (m_columns.empty())
+        m_columns.resize(Dimension::COUNT);
+    for (Dimension::Id id : m_layoutRef.dims())
+    {
+        Column& c = m_columns[Utils::toNative(id)];
+        std::size_t size = m_layoutRef.dimSize(id);
+        std::size_t bytes = size * capacity;
+
+        std::unique_ptr<char[]> buf(new char[bytes + m_alignment]);
+        std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(buf.get());
+        addr = (addr + m_alignment - 1) & ~(std::uintptr_t)(m_alignment - 1);
+        char *data = reinterpret_cast<char *>(addr);
+
+        std::size_t used = 0;
+        if (c.m_data)
+        {
+            used = c.m_size * m_numPts;
+            std::copy(c.m_data, c.m_data + used, data);
+        }
+        std::fill(data + used, data + bytes, 0);
+        c.m_buf = std::move(buf);
+        c.m_data = data;
+        c.m_size = size;
+    }
+    m_capacity = capacity;
+    m_numDims = m_layoutRef.dims().size();
+}
+
+
+char *ColumnPointTable::getPoint(PointId)
+{
+    throw pdal_error("Can't access packed point data of a point table "
+        "that stores data by dimension.");
+}
+
+
+void ColumnPointTable::setFieldInternal(Dimension::Id id, PointId idx,
+    const void *value)
+{
+    const Column& c = m_columns[Utils::toNative(id)];
+    const char *src = (const char *)value;
+    std::copy(src, src + c.m_size, c.m_data + c.m_size * idx);
+}
+
+
+void ColumnPointTable::getFieldInternal(Dimension::Id id, PointId idx,
+    void *value) const
+{
+    const Column& c = m_columns[Utils::toNative(id)];
+    const char *src = c.m_data + c.m_size * idx;
+    std::copy(src, src + c.m_size, (char *)value);
+}
+
+
 MetadataNode BasePointTable::toMetadata() const
 {
     return layout()->toMetadata();
@@ -35,7 +35,10 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "pdal/SpatialReference.hpp"
@@ -51,10 +54,11 @@ class PDAL_DLL BasePointTable : public PointContainer
 {
     FRIEND_TEST(PointTable, srs);
     friend class PointView;
+    friend class Streamable;
 
 protected:
     BasePointTable(PointLayout& layout) : m_metadata(new Metadata()),
-        m_layoutRef(layout)
+        m_layoutRef(layout), m_positionGeneration(0), m_neighborViews(0)
     {}
 
 public:
@@ -92,6 +96,13 @@ public:
     }
     virtual bool supportsView() const
         { return false; }
+    /// Whether points may be added from more than one thread at a time.
+    virtual bool supportsConcurrentAdd() const
+        { return false; }
+    /// Whether getPoint() provides the storage of a whole point, with
+    /// dimensions at the offsets given by the layout.
+    virtual bool supportsPointAccess() const
+        { return true; }
     MetadataNode privateMetadata(const std::string& name);
     MetadataNode toMetadata() const;
 
@@ -99,13 +110,34 @@ private:
     // Point data operations.
     virtual PointId addPoint() = 0;
 
+    // Note that points may have moved, so that views discard neighbors
+    // they've cached.  Nothing needs to be noted while no view has cached
+    // neighbors.
+    void positionsChanged()
+    {
+        if (m_neighborViews.load(std::memory_order_relaxed))
+            m_positionGeneration++;
+    }
+
 protected:
     virtual char *getPoint(PointId idx) = 0;
+    /// Get a pointer to the values of a dimension, stored contiguously
+    /// for all points in the table, or null if the table doesn't store
+    /// point data by dimension.
+    virtual char *getColumn(Dimension::Id)
+        { return nullptr; }
 
 protected:
     MetadataPtr m_metadata;
     std::list<SpatialReference> m_spatialRefs;
     PointLayout& m_layoutRef;
+
+private:
+    // Count of changes to point positions, compared by views with the
+    // count when they cached neighbors.
+    std::atomic<uint64_t> m_positionGeneration;
+    // Number of views of the table with cached neighbors.
+    std::atomic<int> m_neighborViews;
 };
 typedef BasePointTable& PointTableRef;
 typedef BasePointTable const & ConstPointTableRef;
@@ -143,17 +175,26 @@ private:
 class PDAL_DLL PointTable : public SimplePointTable
 {
 private:
-    // Point storage.
-    std::vector<char *> m_blocks;
-    point_count_t m_numPts;
+    // Point storage.  Points may be added by stages running on separate
+    // threads while others read existing points, so blocks are found
+    // through a directory that is never reallocated.  The directory holds
+    // lists of blocks that are allocated as needed.
     static const point_count_t m_blockPtCnt = 65536;
+    static const size_t m_listBlockCnt = 1024;
+    static const size_t m_maxLists = 1024;
+    std::unique_ptr<char **[]> m_lists;
+    point_count_t m_numPts;
+    std::mutex m_mutex;
 
 public:
-    PointTable() : SimplePointTable(m_layout), m_numPts(0)
-        {}
+    PointTable() : SimplePointTable(m_layout),
+        m_lists(new char **[m_maxLists]()), m_numPts(0)
+    {}
     virtual ~PointTable();
     virtual bool supportsView() const
         { return true; }
+    virtual bool supportsConcurrentAdd() const
+        { return true; }
 
 protected:
     virtual char *getPoint(PointId idx);
@@ -165,6 +206,66 @@ private:
     PointLayout m_layout;
 };
 
+/// A point table that stores the values of each dimension contiguously in
+/// its own buffer rather than storing each point's data together.  This
+/// allows stages to operate on a dimension as a dense array (see
+/// PointView::column()).  Point data can't be accessed as a packed point,
+/// so getPoint() throws.  Column storage grows as points are added, so
+/// points mustn't be added from more than one thread at a time.
+class PDAL_DLL ColumnPointTable : public BasePointTable
+{
+public:
+    ColumnPointTable() : BasePointTable(m_layout), m_numPts(0), m_capacity(0),
+        m_numDims(0)
+    {}
+    virtual bool supportsView() const
+        { return true; }
+    virtual bool supportsPointAccess() const
+        { return false; }
+
+    /// Get a pointer to the values of a dimension for all points in the
+    /// table.  The pointer is invalidated when points are added.
+    /// \param id  ID of the dimension.
+    /// \return  Pointer to numPoints() values, or null if the dimension
+    ///     has no storage.
+    char *column(Dimension::Id id);
+    point_count_t numPoints() const
+        { return m_numPts; }
+
+protected:
+    virtual char *getPoint(PointId idx);
+    virtual char *getColumn(Dimension::Id id)
+        { return column(id); }
+
+private:
+    struct Column
+    {
+        Column() : m_data(nullptr), m_size(0)
+            {}
+
+        std::unique_ptr<char[]> m_buf;
+        char *m_data;       // m_buf, aligned to m_alignment.
+        std::size_t m_size; // Size of each value in bytes.
+    };
+
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
+    void grow(point_count_t capacity);
+
+    static const point_count_t m_minCapacity = 65536;
+    static const std::size_t m_alignment = 64;
+
+    // Columns are indexed by dimension ID.
+    std::vector<Column> m_columns;
+    point_count_t m_numPts;
+    point_count_t m_capacity;
+    std::size_t m_numDims;
+    PointLayout m_layout;
+};
+
 /// A StreamPointTable must provide storage for point data up to its capacity.
 /// It must implement getPoint() which returns a pointer to a buffer of
 /// sufficient size to contain a point's data.  The minimum size required
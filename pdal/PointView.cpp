@@ -32,6 +32,7 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <algorithm>
 #include <iomanip>
 
 #include <pdal/KDIndex.hpp>
@@ -42,23 +43,29 @@
 namespace pdal
 {
 
-int PointView::m_lastId = 0;
+std::atomic<int> PointView::m_lastId(0);
 
 PointView::PointView(PointTableRef pointTable) : m_pointTable(pointTable),
-m_size(0), m_id(0)
+m_size(0), m_id(0), m_index3Stale(false), m_index2Stale(false),
+m_knnCount(0), m_radius(0), m_neighborsCached(false),
+m_positionGeneration(0)
 {
 	m_id = ++m_lastId;
 }
 
 PointView::PointView(PointTableRef pointTable, const SpatialReference& srs) :
-	m_pointTable(pointTable), m_size(0), m_id(0), m_spatialReference(srs)
+	m_pointTable(pointTable), m_size(0), m_id(0), m_spatialReference(srs),
+    m_index3Stale(false), m_index2Stale(false), m_knnCount(0), m_radius(0),
+    m_neighborsCached(false), m_positionGeneration(0)
 {
 	m_id = ++m_lastId;
 }
 
 
 PointView::~PointView()
-{}
+{
+    discardNeighbors();
+}
 
 
 PointViewIter PointView::begin()
@@ -73,6 +80,18 @@ PointViewIter PointView::end()
 }
 
 
+void PointView::reorder(const std::vector<PointId>& order)
+{
+    assert(order.size() == size());
+
+    std::vector<PointId> ids(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        ids[i] = m_index[order[i]];
+    std::copy(ids.begin(), ids.end(), m_index.begin());
+    discardNeighbors();
+}
+
+
 void PointView::setFieldInternal(Dimension::Id dim, PointId idx,
     const void *buf)
 {
@@ -83,6 +102,7 @@ void PointView::setFieldInternal(Dimension::Id dim, PointId idx,
         m_index.push_back(rawId);
         m_size++;
         assert(m_temps.empty());
+        discardNeighbors();
     }
     else if (idx > size())
     {
@@ -95,6 +115,18 @@ void PointView::setFieldInternal(Dimension::Id dim, PointId idx,
         rawId = m_index[idx];
     }
     m_pointTable.setFieldInternal(dim, rawId, buf);
+    if (dim == Dimension::Id::X || dim == Dimension::Id::Y ||
+        dim == Dimension::Id::Z)
+        invalidateNeighbors();
+}
+
+
+void PointView::setPosition(PointId idx, double x, double y, double z)
+{
+    PointRef point(m_pointTable, m_index[idx]);
+    point.setField(Dimension::Id::X, x);
+    point.setField(Dimension::Id::Y, y);
+    point.setField(Dimension::Id::Z, z);
 }
 
 
@@ -185,34 +217,112 @@ TriangularMesh *PointView::mesh(const std::string& name)
 }
 
 
+// An existing index is rebuilt in place if the points have changed, so
+// that references to it remain valid.
 KD3Index& PointView::build3dIndex()
 {
-    //ABELL
-    // Should we allow a force of point view build - perhaps the index has
-    // changed or the point values have changed.
+    checkNeighbors();
     if (!m_index3)
     {
         m_index3.reset(new KD3Index(*this));
         m_index3->build();
     }
+    else if (m_index3Stale)
+        m_index3->build();
+    m_index3Stale = false;
+    cacheNeighbors();
     return *m_index3.get();
 }
 
 
 KD2Index& PointView::build2dIndex()
 {
-    //ABELL
-    // Should we allow a force of point view build - perhaps the index has
-    // changed or the point values have changed.
+    checkNeighbors();
     if (!m_index2)
     {
         m_index2.reset(new KD2Index(*this));
         m_index2->build();
     }
+    else if (m_index2Stale)
+        m_index2->build();
+    m_index2Stale = false;
+    cacheNeighbors();
     return *m_index2.get();
 }
 
 
+NeighborTablePtr PointView::knnTable(point_count_t k,
+    std::size_t numThreads)
+{
+    checkNeighbors();
+    k = (std::min)(k, size());
+
+    if (m_knnTable)
+    {
+        // Neighbors are sorted by distance, so the first k neighbors from
+        // a table of more neighbors are the k nearest.
+        if (m_knnCount == k)
+            return m_knnTable;
+        if (m_knnCount > k)
+            return NeighborTablePtr(new NeighborTable(m_knnTable->first(k)));
+    }
+
+    NeighborTablePtr table(new NeighborTable(
+        build3dIndex().knnSearchAll(k, numThreads)));
+    m_knnTable = table;
+    m_knnCount = k;
+    return table;
+}
+
+
+NeighborTablePtr PointView::radiusTable(double radius,
+    std::size_t numThreads)
+{
+    checkNeighbors();
+    if (m_radiusTable && m_radius == radius)
+        return m_radiusTable;
+
+    NeighborTablePtr table(new NeighborTable(
+        build3dIndex().radiusSearchAll(radius, numThreads)));
+    m_radiusTable = table;
+    m_radius = radius;
+    return table;
+}
+
+
+// Discard cached neighbors if points of the table have moved since they
+// were cached.
+void PointView::checkNeighbors()
+{
+    if (m_neighborsCached &&
+        m_positionGeneration != m_pointTable.m_positionGeneration)
+        clearNeighbors();
+}
+
+
+void PointView::cacheNeighbors()
+{
+    if (!m_neighborsCached)
+    {
+        m_neighborsCached = true;
+        m_pointTable.m_neighborViews++;
+        m_positionGeneration = m_pointTable.m_positionGeneration;
+    }
+}
+
+
+void PointView::clearNeighbors()
+{
+    m_knnTable.reset();
+    m_radiusTable.reset();
+    m_index3Stale = true;
+    m_index2Stale = true;
+    if (m_neighborsCached)
+        m_pointTable.m_neighborViews--;
+    m_neighborsCached = false;
+}
+
+
 void PointView::dump(std::ostream& ostr) const
 {
     using std::endl;
@@ -43,6 +43,8 @@
 #include <pdal/PointTable.hpp>
 #include <pdal/util/Bounds.hpp>
 
+#include <atomic>
+#include <map>
 #include <memory>
 #include <queue>
 #include <set>
@@ -63,14 +65,17 @@ class PointView;
 class PointViewIter;
 class KD2Index;
 class KD3Index;
+class NeighborTable;
 
 typedef std::shared_ptr<PointView> PointViewPtr;
+typedef std::shared_ptr<const NeighborTable> NeighborTablePtr;
 typedef std::set<PointViewPtr, PointViewLess> PointViewSet;
 
 class PDAL_DLL PointView : public PointContainer
 {
     friend class plang::Invocation;
     friend class PointIdxRef;
+    friend class Stage;
     friend struct PointViewLess;
 public:
     PointView(const PointView&) = delete;
@@ -102,8 +107,17 @@ public:
         m_index.insert(thisEnd, buf.m_index.begin(), bufEnd);
         m_size += buf.size();
         clearTemps();
+        discardNeighbors();
     }
 
+    /**
+      Reorder the points of the view.
+
+      \param order  Position in the view of each point in the new order.
+        Must be a permutation of the positions of the view.
+    */
+    void reorder(const std::vector<PointId>& order);
+
     /// Return a new point view with the same point table as this
     /// point buffer.
     PointViewPtr makeNew() const
@@ -126,6 +140,33 @@ public:
     inline void setField(Dimension::Id dim, Dimension::Type type,
         PointId idx, const void *val);
 
+    /**
+      Set the position of a point without discarding cached neighbor
+      tables and indexes.  Positions of different points can be set from
+      several threads at once, provided \ref invalidateNeighbors() is
+      called before the first position changes and no view of the table
+      finds neighbors until the last.
+
+      \param idx  ID of the point.
+      \param x  X coordinate.
+      \param y  Y coordinate.
+      \param z  Z coordinate.
+    */
+    void setPosition(PointId idx, double x, double y, double z);
+
+    /**
+      Note that positions of points have changed.  The view discards its
+      cached neighbor tables and marks indexes for rebuild, and other views
+      of the point table do the same the next time they're asked for
+      neighbors.  This is done by the view when points are moved with
+      \ref setField() or may be moved through \ref getPoint().
+    */
+    void invalidateNeighbors()
+    {
+        m_pointTable.positionsChanged();
+        discardNeighbors();
+    }
+
     template <typename T>
     bool compare(Dimension::Id dim, PointId id1, PointId id2)
     {
@@ -244,25 +285,60 @@ public:
         }
     }
 
+    /// Whether getPoint() and getOrAddPoint() can be used with the view's
+    /// point table.  When they can't, use the field access functions.
+    bool supportsPointAccess() const
+        { return m_pointTable.supportsPointAccess(); }
+
     /// Provides access to the memory storing the point data.  Though this
     /// function is public, other access methods are safer and preferred.
+    /// Throws if the point table doesn't support point access.
     char *getPoint(PointId id)
-        { return m_pointTable.getPoint(m_index[id]); }
+    {
+        checkPointAccess();
+        m_pointTable.positionsChanged();
+        return m_pointTable.getPoint(m_index[id]);
+    }
 
     /// Provides access to the memory storing the point data.  Though this
     /// function is public, other access methods are safer and preferred.
+    /// Throws, without adding a point, if the point table doesn't support
+    /// point access.
     char *getOrAddPoint(PointId id)
     {
+        checkPointAccess();
         if (id == size())
         {
             m_index.push_back(m_pointTable.addPoint());
             ++m_size;
             assert(m_temps.empty());
+            discardNeighbors();
         }
 
+        m_pointTable.positionsChanged();
         return m_pointTable.getPoint(m_index.at(id));
     }
 
+    /**
+      Get the values of a dimension for all points in the view as a dense
+      array.  This is only possible when the point table stores data by
+      dimension (see ColumnPointTable), the view's points are consecutive
+      points of the table in order and T is the type with which the
+      dimension is stored.  The pointer is invalidated when points are
+      added to the table.  Positions can be changed through a column of X,
+      Y or Z, so getting one discards cached neighbor tables and indexes.
+      Use the const version to only read values.
+
+      \param dim  ID of the dimension.
+      \return  Pointer to size() values, or null if the dimension isn't
+          available as a dense array.
+    */
+    template<typename T>
+    T *column(Dimension::Id dim);
+
+    template<typename T>
+    const T *column(Dimension::Id dim) const;
+
     // The standard idiom is swapping with a stack-created empty queue, but
     // that invokes the ctor and probably allocates.  We've probably only got
     // one or two things in our queue, so just pop until we're empty.
@@ -293,6 +369,33 @@ public:
     KD3Index& build3dIndex();
     KD2Index& build2dIndex();
 
+    /**
+      Get the k nearest neighbors of every point in the view.  The table
+      for the largest k requested is kept with the view until points are
+      added or reordered or points of the table move, so that stages using
+      the same neighborhoods share the cost of finding them.  A table for
+      fewer neighbors is taken from the cached table.
+
+      \param k  Number of neighbors of each point, including the point
+        itself.
+      \param numThreads  Number of threads with which to find neighbors.
+        If zero, the number of hardware threads is used.
+      \return  Table of neighbors.
+    */
+    NeighborTablePtr knnTable(point_count_t k, std::size_t numThreads = 1);
+
+    /**
+      Get the neighbors within a radius of every point in the view.  The
+      table for the last radius requested is cached like those returned by
+      \ref knnTable().
+
+      \param radius  Search radius.
+      \param numThreads  Number of threads with which to find neighbors.
+        If zero, the number of hardware threads is used.
+      \return  Table of neighbors.
+    */
+    NeighborTablePtr radiusTable(double radius, std::size_t numThreads = 1);
+
 protected:
     PointTableRef m_pointTable;
     std::deque<PointId> m_index;
@@ -305,9 +408,20 @@ protected:
     std::map<std::string, std::unique_ptr<TriangularMesh>> m_meshes;
     std::unique_ptr<KD3Index> m_index3;
     std::unique_ptr<KD2Index> m_index2;
+    // Whether the indexes need to be rebuilt because points have changed.
+    bool m_index3Stale;
+    bool m_index2Stale;
+    NeighborTablePtr m_knnTable;
+    point_count_t m_knnCount;
+    NeighborTablePtr m_radiusTable;
+    double m_radius;
+    // Whether there's an index or neighbor table to invalidate.
+    bool m_neighborsCached;
+    // Position count of the table when neighbors were cached.
+    uint64_t m_positionGeneration;
 
 private:
-    static int m_lastId;
+    static std::atomic<int> m_lastId;
 
     template<typename T_IN, typename T_OUT>
     bool convertAndSet(Dimension::Id dim, PointId idx, T_IN in);
@@ -323,6 +437,24 @@ private:
     inline PointId getTemp(PointId id);
     void freeTemp(PointId id)
         { m_temps.push(id); }
+    void checkPointAccess() const
+    {
+        if (!supportsPointAccess())
+            throw pdal_error("Can't access packed point data of a point "
+                "table that stores data by dimension.  Use field access "
+                "instead.");
+    }
+    void clearNeighbors();
+    void discardNeighbors()
+    {
+        if (m_neighborsCached)
+            clearNeighbors();
+    }
+    void checkNeighbors();
+    void cacheNeighbors();
+    // Give the view a new ID, ordering it after all existing views.
+    void renumber()
+        { m_id = ++m_lastId; }
 };
 
 struct PointViewLess
@@ -331,6 +463,34 @@ struct PointViewLess
         { return p1->m_id < p2->m_id; }
 };
 
+template<typename T>
+const T *PointView::column(Dimension::Id dim) const
+{
+    if (empty() || !hasDim(dim) || dimType(dim) != Dimension::type<T>())
+        return nullptr;
+
+    char *base = m_pointTable.getColumn(dim);
+    if (!base)
+        return nullptr;
+
+    PointId first = m_index[0];
+    for (PointId idx = 1; idx < m_size; ++idx)
+        if (m_index[idx] != first + idx)
+            return nullptr;
+    return reinterpret_cast<const T *>(base) + first;
+}
+
+template<typename T>
+T *PointView::column(Dimension::Id dim)
+{
+    T *values = const_cast<T *>(
+        static_cast<const PointView *>(this)->column<T>(dim));
+    if (values && (dim == Dimension::Id::X || dim == Dimension::Id::Y ||
+            dim == Dimension::Id::Z))
+        invalidateNeighbors();
+    return values;
+}
+
 template <class T>
 T PointView::getFieldInternal(Dimension::Id dim, PointId id) const
 {
@@ -559,6 +719,7 @@ inline void PointView::appendPoint(const PointView& buffer, PointId id)
     m_index.push_back(rawId);
     m_size++;
     assert(m_temps.empty());
+    discardNeighbors();
 }
 
 
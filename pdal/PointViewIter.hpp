@@ -76,7 +76,10 @@ public:
             m_tmp = true;
         }
         else
+        {
             m_buf->m_index[m_id] = r.m_buf->m_index[r.m_id];
+            m_buf->discardNeighbors();
+        }
         return *this;
     }
 
@@ -88,6 +91,8 @@ public:
         PointId id = m_buf->m_index[m_id];
         m_buf->m_index[m_id] = p.m_buf->m_index[p.m_id];
         p.m_buf->m_index[p.m_id] = id;
+        m_buf->discardNeighbors();
+        p.m_buf->discardNeighbors();
     }
 };
 
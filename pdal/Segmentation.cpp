@@ -34,13 +34,20 @@
 
 #include <pdal/PDALUtils.hpp>
 
-#include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/Segmentation.hpp>
 #include <pdal/pdal_types.hpp>
 
+#include <pdal/util/ThreadPool.hpp>
+
 #include "../filters/private/DimRange.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <vector>
 
 namespace pdal
@@ -49,67 +56,356 @@ namespace pdal
 namespace Segmentation
 {
 
+namespace
+{
+
+// Integer coordinates of a grid cell.
+struct CellKey
+{
+    int64_t x;
+    int64_t y;
+    int64_t z;
+
+    bool operator==(const CellKey& other) const
+        { return x == other.x && y == other.y && z == other.z; }
+    bool operator<(const CellKey& other) const
+    {
+        if (x != other.x)
+            return x < other.x;
+        if (y != other.y)
+            return y < other.y;
+        return z < other.z;
+    }
+};
+
+// Points of a grid cell, as a range of sorted positions, and their bounds.
+struct Cell
+{
+    CellKey key;
+    PointId begin;
+    PointId end;
+    double low[3];
+    double high[3];
+    bool connected;    // All points in the cell are known to be connected.
+};
+
+// Union-find over point positions that may be updated from several
+// threads at once.  The root of a set is always its smallest member.
+class DisjointSets
+{
+public:
+    DisjointSets(point_count_t size) : m_parent(new std::atomic<PointId>[size])
+    {
+        for (PointId i = 0; i < size; ++i)
+            m_parent[i].store(i, std::memory_order_relaxed);
+    }
+
+    PointId find(PointId i)
+    {
+        while (true)
+        {
+            PointId p = m_parent[i].load(std::memory_order_relaxed);
+            if (p == i)
+                return i;
+            // Path halving.
+            PointId gp = m_parent[p].load(std::memory_order_relaxed);
+            if (p != gp)
+                m_parent[i].compare_exchange_weak(p, gp,
+                    std::memory_order_relaxed);
+            i = gp;
+        }
+    }
+
+    void unite(PointId a, PointId b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            // Another thread may have linked 'a' since we found it, in
+            // which case we try again.
+            PointId expected = a;
+            if (m_parent[a].compare_exchange_strong(expected, b,
+                    std::memory_order_relaxed))
+                return;
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<PointId>[]> m_parent;
+};
+
+double sqrDistance(const double *p, const double *q)
+{
+    double dist = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        double d = p[i] - q[i];
+        dist += d * d;
+    }
+    return dist;
+}
+
+// Connect the points of two cells that are neighbors.
+void connectCells(const Cell& a, const Cell& b,
+    const std::vector<double>& sorted, DisjointSets& sets, double tol2)
+{
+    // Skip cells whose bounds are too far apart.
+    double gap[3];
+    double span[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        gap[j] = (std::max)(0.0, (std::max)(b.low[j] - a.high[j],
+            a.low[j] - b.high[j]));
+        span[j] = (std::max)(b.high[j] - a.low[j], a.high[j] - b.low[j]);
+    }
+    const double zero[3] = { 0.0, 0.0, 0.0 };
+    if (sqrDistance(gap, zero) >= tol2)
+        return;
+
+    // Every pair of points is close enough.
+    if (sqrDistance(span, zero) < tol2)
+    {
+        sets.unite(a.begin, b.begin);
+        return;
+    }
+
+    // When both cells are connected, one neighboring pair connects
+    // everything.
+    const bool both = a.connected && b.connected;
+    if (both && sets.find(a.begin) == sets.find(b.begin))
+        return;
+    for (PointId i = a.begin; i < a.end; ++i)
+        for (PointId j = b.begin; j < b.end; ++j)
+        {
+            if (!both && sets.find(i) == sets.find(j))
+                continue;
+            if (sqrDistance(sorted.data() + i * 3,
+                sorted.data() + j * 3) < tol2)
+            {
+                sets.unite(i, j);
+                if (both)
+                    return;
+            }
+        }
+}
+
+// Call f(first, last) for consecutive blocks of [0, count) on numThreads
+// threads.
+template<typename F>
+void runBlocks(size_t count, size_t numThreads, F f)
+{
+    const size_t blockSize = (std::max)(count / (numThreads * 8) + 1,
+        (size_t)1024);
+    if (numThreads == 1 || count <= blockSize)
+    {
+        f(0, count);
+        return;
+    }
+
+    ThreadPool pool(numThreads);
+    for (size_t first = 0; first < count; first += blockSize)
+    {
+        size_t last = (std::min)(first + blockSize, count);
+        pool.add([&f, first, last](){ f(first, last); });
+    }
+    pool.join();
+}
+
+} // unnamed namespace
+
 std::vector<std::vector<PointId>> extractClusters(PointView& view,
-                                                  uint64_t min_points,
-                                                  uint64_t max_points,
-                                                  double tolerance)
+    uint64_t min_points, uint64_t max_points, double tolerance,
+    size_t numThreads)
 {
-    // Index the incoming PointView for subsequent radius searches.
-    KD3Index kdi(view);
-    kdi.build();
+    if (numThreads == 0)
+        numThreads = ThreadPool::hardwareThreads();
 
-    // Create variables to track PointIds that have already been added to
-    // clusters and to build the list of cluster indices.
-    std::vector<PointId> processed(view.size(), 0);
+    const point_count_t np = view.size();
     std::vector<std::vector<PointId>> clusters;
+    if (np == 0)
+        return clusters;
 
-    for (PointId i = 0; i < view.size(); ++i)
+    // Two points are neighbors when their squared distance is less than
+    // the squared tolerance, as with a KD-tree radius search.
+    const double tol2 = tolerance * tolerance;
+    if (!(tolerance > 0))
     {
-        // Points can only belong to a single cluster.
-        if (processed[i])
-            continue;
+        if (min_points <= 1 && max_points >= 1)
+            for (PointId i = 0; i < np; ++i)
+                clusters.push_back(std::vector<PointId>(1, i));
+        return clusters;
+    }
+
+    // Bin the points in cells whose diagonal is the tolerance, so that
+    // points in the same cell are usually neighbors and neighbors are
+    // never more than two cells apart.
+    const double cellSize = tolerance / std::sqrt(3.0);
+    std::vector<double> pos(np * 3);
+    double low[3] = { 0.0, 0.0, 0.0 };
+    for (PointId i = 0; i < np; ++i)
+    {
+        double *p = pos.data() + i * 3;
+        p[0] = view.getFieldAs<double>(Dimension::Id::X, i);
+        p[1] = view.getFieldAs<double>(Dimension::Id::Y, i);
+        p[2] = view.getFieldAs<double>(Dimension::Id::Z, i);
+        for (int j = 0; j < 3; ++j)
+            if (i == 0 || p[j] < low[j])
+                low[j] = p[j];
+    }
+
+    std::vector<CellKey> keys(np);
+    for (PointId i = 0; i < np; ++i)
+    {
+        const double *p = pos.data() + i * 3;
+        keys[i].x = (int64_t)std::floor((p[0] - low[0]) / cellSize);
+        keys[i].y = (int64_t)std::floor((p[1] - low[1]) / cellSize);
+        keys[i].z = (int64_t)std::floor((p[2] - low[2]) / cellSize);
+    }
+
+    // Sort the points by cell so that each cell is a contiguous range of
+    // positions.  Union-find is done on the sorted positions.
+    std::vector<PointId> order(np);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&keys](PointId a, PointId b)
+        { return keys[a] < keys[b]; });
 
-        // Initialize list of indices belonging to current cluster, marking the
-        // seed point as processed.
-        std::vector<PointId> seed_queue;
-        size_t sq_idx = 0;
-        seed_queue.push_back(i);
-        processed[i] = 1;
+    std::vector<double> sorted(np * 3);
+    for (PointId i = 0; i < np; ++i)
+        std::copy(pos.data() + order[i] * 3, pos.data() + order[i] * 3 + 3,
+            sorted.data() + i * 3);
+    std::vector<double>().swap(pos);
 
-        // Check each point in the cluster for additional neighbors within the
-        // given tolerance, remembering that the list can grow if we add points
-        // to the cluster.
-        while (sq_idx < seed_queue.size())
+    std::vector<Cell> cells;
+    for (PointId i = 0; i < np; ++i)
+    {
+        const CellKey& key = keys[order[i]];
+        const double *p = sorted.data() + i * 3;
+        if (cells.empty() || !(cells.back().key == key))
+        {
+            Cell c;
+            c.key = key;
+            c.begin = i;
+            std::copy(p, p + 3, c.low);
+            std::copy(p, p + 3, c.high);
+            cells.push_back(c);
+        }
+        Cell& c = cells.back();
+        c.end = i + 1;
+        for (int j = 0; j < 3; ++j)
         {
-            // Find neighbors of the next cluster point.
-            PointId j = seed_queue[sq_idx];
-            std::vector<PointId> ids = kdi.radius(j, tolerance);
+            c.low[j] = (std::min)(c.low[j], p[j]);
+            c.high[j] = (std::max)(c.high[j], p[j]);
+        }
+    }
+    std::vector<CellKey>().swap(keys);
 
-            // The case where the only neighbor is the query point.
-            if (ids.size() == 1)
+    DisjointSets sets(np);
+
+    // Connect the points within each cell.  When the bounds of a cell
+    // are smaller than the tolerance, all its points are neighbors.
+    runBlocks(cells.size(), numThreads,
+        [&cells, &sorted, &sets, tol2](size_t first, size_t last)
+    {
+        for (size_t ci = first; ci < last; ++ci)
+        {
+            Cell& c = cells[ci];
+            c.connected = (sqrDistance(c.low, c.high) < tol2);
+            if (c.connected)
             {
-                sq_idx++;
+                for (PointId i = c.begin + 1; i < c.end; ++i)
+                    sets.unite(c.begin, i);
                 continue;
             }
+            for (PointId i = c.begin; i < c.end; ++i)
+                for (PointId j = i + 1; j < c.end; ++j)
+                    if (sets.find(i) != sets.find(j) &&
+                        sqrDistance(sorted.data() + i * 3,
+                            sorted.data() + j * 3) < tol2)
+                        sets.unite(i, j);
+        }
+    });
+
+    // Columns of neighboring cells that follow a cell in key order, so
+    // that each pair of cells is visited once.  The first column is the
+    // cell's own.
+    std::vector<std::pair<int64_t, int64_t>> columns;
+    columns.push_back({ 0, 0 });
+    for (int64_t x = 0; x <= 2; ++x)
+        for (int64_t y = -2; y <= 2; ++y)
+            if (x > 0 || y > 0)
+                columns.push_back({ x, y });
 
-            // Skip neighbors that already belong to a cluster and add the rest
-            // to this cluster.
-            for (auto const& k : ids)
+    // Connect points in neighboring cells.  Since the cells are sorted,
+    // the first candidate cell in each column only moves forward as we
+    // walk the cells.
+    runBlocks(cells.size(), numThreads,
+        [&cells, &columns, &sorted, &sets, tol2](size_t first, size_t last)
+    {
+        auto cellLess = [](const Cell& c, const CellKey& k)
+            { return c.key < k; };
+
+        std::vector<size_t> next(columns.size());
+        for (size_t k = 0; k < columns.size(); ++k)
+        {
+            const CellKey& key = cells[first].key;
+            CellKey start { key.x + columns[k].first,
+                key.y + columns[k].second, key.z - 2 };
+            next[k] = std::lower_bound(cells.begin(), cells.end(), start,
+                cellLess) - cells.begin();
+        }
+
+        for (size_t ci = first; ci < last; ++ci)
+        {
+            const Cell& a = cells[ci];
+            for (size_t k = 0; k < columns.size(); ++k)
             {
-                if (processed[k])
-                    continue;
-                seed_queue.push_back(k);
-                processed[k] = 1;
-            }
+                const int64_t x = a.key.x + columns[k].first;
+                const int64_t y = a.key.y + columns[k].second;
+                CellKey start { x, y, k == 0 ? a.key.z + 1 : a.key.z - 2 };
+                while (next[k] < cells.size() && cells[next[k]].key < start)
+                    next[k]++;
 
-            sq_idx++;
+                for (size_t cj = next[k]; cj < cells.size(); ++cj)
+                {
+                    const Cell& b = cells[cj];
+                    if (b.key.x != x || b.key.y != y || b.key.z > a.key.z + 2)
+                        break;
+                    connectCells(a, b, sorted, sets, tol2);
+                }
+            }
         }
+    });
 
-        // Keep clusters that are within the min/max number of points.
-        if (seed_queue.size() >= min_points && seed_queue.size() <= max_points)
-            clusters.push_back(seed_queue);
+    // Gather clusters in order of their smallest point ID, with the point
+    // IDs of each cluster in ascending order.
+    std::vector<PointId> rank(np);
+    for (PointId i = 0; i < np; ++i)
+        rank[order[i]] = i;
+
+    const size_t NoCluster = (std::numeric_limits<size_t>::max)();
+    std::vector<size_t> clusterOf(np, NoCluster);
+    std::vector<std::vector<PointId>> all;
+    for (PointId i = 0; i < np; ++i)
+    {
+        PointId root = sets.find(rank[i]);
+        if (clusterOf[root] == NoCluster)
+        {
+            clusterOf[root] = all.size();
+            all.push_back(std::vector<PointId>());
+        }
+        all[clusterOf[root]].push_back(i);
     }
 
+    // Keep clusters that are within the min/max number of points.
+    for (auto& c : all)
+        if (c.size() >= min_points && c.size() <= max_points)
+            clusters.push_back(std::move(c));
+
     return clusters;
 }
 
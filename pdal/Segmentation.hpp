@@ -52,21 +52,24 @@ namespace Segmentation
 /**
   Extract clusters of points from input PointView.
 
-  For each point, find neighbors within a given tolerance (Euclidean distance).
-  If a neighbor already belongs to another cluster, skip it. Otherwise, add it
-  to the current cluster. Recursively visit newly added cluster points, looking
-  for neighbors to add to the cluster.
+  Two points are neighbors if they are closer than a given tolerance
+  (Euclidean distance).  A cluster is a set of points connected through
+  neighbors.  Points are binned in a grid of cells and neighbors are only
+  sought in nearby cells.  Clusters are merged with a concurrent
+  union-find, so the work can be spread across threads.
 
   \param[in] view the input PointView.
   \param[in] min_points the minimum number of points in a cluster.
   \param[in] max_points the maximum number of points in a cluster.
   \param[in] tolerance the tolerance for adding points to a cluster.
-  \returns a vector of clusters (themselves vectors of PointIds).
+  \param[in] numThreads the number of threads to use.  If zero, the number
+    of hardware threads is used.
+  \returns a vector of clusters (themselves vectors of PointIds), ordered
+    by their smallest PointId.  The PointIds of a cluster are sorted.
 */
 PDAL_DLL std::vector<std::vector<PointId>> extractClusters(PointView& view,
-                                                           uint64_t min_points,
-                                                           uint64_t max_points,
-                                                           double tolerance);
+    uint64_t min_points, uint64_t max_points, double tolerance,
+    size_t numThreads = 1);
 
 PDAL_DLL void ignoreDimRange(DimRange dr, PointViewPtr input, PointViewPtr keep,
                              PointViewPtr ignore);
@@ -40,9 +40,11 @@
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "private/StageRunner.hpp"
 
+#include <algorithm>
 #include <iterator>
 #include <memory>
 
@@ -50,7 +52,8 @@ namespace pdal
 {
 
 Stage::Stage() : m_progressFd(-1), m_verbose(0), m_pointCount(0),
-    m_faceCount(0)
+    m_faceCount(0), m_threads(1), m_threadsOption(1), m_threadsArg(nullptr),
+    m_viewThreads(1)
 {}
 
 
@@ -203,23 +206,54 @@ PointViewSet Stage::execute(PointTableRef table)
             m_faceCount += m->size();
     }
     // Do the ready operation and then start running all the views
-    // through the stage.
+    // through the stage.  The pool is declared after the runners so that
+    // its threads are joined before the runners are destroyed.
     ready(table);
+    std::unique_ptr<ThreadPool> pool;
+    m_viewThreads = 1;
+    std::size_t viewThreads = (std::min)(this->numThreads(), views.size());
+    if (viewThreads > 1 && parallelRunnable() &&
+        table.supportsConcurrentAdd())
+    {
+        log()->get(LogLevel::Debug) << "Running " << views.size() <<
+            " views on " << viewThreads << " threads." << std::endl;
+        pool.reset(new ThreadPool(viewThreads));
+        m_viewThreads = viewThreads;
+    }
     for (auto const& it : views)
     {
         StageRunnerPtr runner(new StageRunner(this, it));
         runners.push_back(runner);
-        runner->run();
+        if (pool)
+            runner->run(*pool);
+        else
+            runner->run();
     }
 
-    // As the stages complete (synchronously at this time), propagate the
-    // spatial reference and merge the output views.
+    // As the stages complete, propagate the spatial reference and merge
+    // the output views.
     srs = getSpatialReference();
     for (auto const& it : runners)
     {
         StageRunnerPtr runner(it);
         PointViewSet temp = runner->wait();
 
+        // Views created by concurrent runs were numbered in whatever order
+        // the threads happened to create them.  Renumber them in runner
+        // order so that the output views are ordered as if the runs
+        // were made one after another.
+        if (pool)
+        {
+            std::vector<PointViewPtr> ordered(temp.begin(), temp.end());
+            temp.clear();
+            for (PointViewPtr v : ordered)
+            {
+                if (views.find(v) == views.end())
+                    v->renumber();
+                temp.insert(v);
+            }
+        }
+
         // If our stage has a spatial reference, the view takes it on once
         // the stage has been run.
         if (!srs.empty())
@@ -227,6 +261,7 @@ PointViewSet Stage::execute(PointTableRef table)
                 v->setSpatialReference(srs);
         outViews.insert(temp.begin(), temp.end());
     }
+    m_viewThreads = 1;
     l_done(table);
     stopLogging();
     m_pointCount = 0;
@@ -292,6 +327,25 @@ void Stage::addSpatialReferenceArg(ProgramArgs& args)
         m_spatialReference);
 }
 
+// The option is only added by stages that can use more than one thread.
+void Stage::addThreadsArg(ProgramArgs& args, const std::string& description)
+{
+    m_threadsArg = &args.add("threads", description, m_threadsOption);
+}
+
+
+std::size_t Stage::numThreads() const
+{
+    std::size_t numThreads = (m_threadsArg && m_threadsArg->set()) ?
+        m_threadsOption : m_threads;
+    if (numThreads == 0)
+        numThreads = ThreadPool::hardwareThreads();
+    // When views are run concurrently, each run gets a share of the
+    // threads so that nested pools don't multiply the thread count.
+    return (std::max)(numThreads / m_viewThreads, (std::size_t)1);
+}
+
+
 const SpatialReference& Stage::getSpatialReference() const
 {
     return m_spatialReference;
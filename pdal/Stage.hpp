@@ -96,6 +96,17 @@ public:
     void setProgressFd(int fd)
         { m_progressFd = fd; }
 
+    /**
+      Set the maximum number of threads that may be used to run the stage.
+      Point views are run concurrently only by stages that report that
+      their run() is independent of other views.
+
+      \param threads  Number of threads.  Zero means the number of
+        hardware threads.
+    */
+    void setThreads(std::size_t threads)
+        { m_threads = threads; }
+
     /**
       Retrieve some basic point information without reading all data when
       possible.  Usually implemented only by Readers.
@@ -328,6 +339,30 @@ protected:
     */
     point_count_t faceCount() const
         { return m_faceCount; }
+    /**
+      Return the maximum number of threads the stage may use.
+
+      \return  Number of threads.
+    */
+    std::size_t threads() const
+        { return m_threads; }
+    /**
+      Add a "threads" option with which a user can set the number of
+      threads used by this stage, overriding the pipeline setting.
+
+      \param args  Argument list to which the option is added.
+      \param description  Description of the option.
+    */
+    void addThreadsArg(ProgramArgs& args, const std::string& description);
+    /**
+      Return the number of threads the stage should use: the value of the
+      option added by addThreadsArg() if it was set, or else threads().
+      Zero is replaced by the number of hardware threads.  While point
+      views are run concurrently, the count is divided among the runs.
+
+      \return  Number of threads.
+    */
+    std::size_t numThreads() const;
 
 private:
     uint32_t m_verbose;
@@ -344,6 +379,11 @@ private:
     std::string m_userDataJSON;
     point_count_t m_pointCount;
     point_count_t m_faceCount;
+    std::size_t m_threads;
+    std::size_t m_threadsOption;
+    Arg *m_threadsArg;
+    // Number of views being run concurrently by execute().
+    std::size_t m_viewThreads;
     // This is never used, but we want something to bind to the argument
     // we stick in ProgramArgs so that it shows up in help and an options list.
     std::string m_optionFile;
@@ -443,6 +483,16 @@ private:
         return PointViewSet();
     }
 
+    /**
+      Determine whether run() may be called concurrently for different
+      point views.  A stage that returns true must not modify its own
+      state in run().  Implement in subclass.
+
+      \return  Whether views may be run in parallel.
+    */
+    virtual bool parallelRunnable() const
+        { return false; }
+
     /**
       Called after all point views have been processed.  Implement in subclass.
 
@@ -32,17 +32,123 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <condition_variable>
+#include <cstring>
 #include <iterator>
+#include <mutex>
+#include <queue>
 
 #include <pdal/Streamable.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Point storage for one chunk of a threaded streaming run.  It shares the
+// (already finalized) layout of the table provided by the caller.
+class ChunkPointTable : public StreamPointTable
+{
+public:
+    ChunkPointTable(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout), m_capacity(capacity)
+    { m_buf.resize(pointsToBytes(m_capacity + 1)); }
+
+    virtual void reset()
+        { std::fill(m_buf.begin(), m_buf.end(), 0); }
+    virtual point_count_t capacity() const
+        { return m_capacity; }
+
+protected:
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+    point_count_t m_capacity;
+};
+
+
+// A chunk of points handed from one group of stages to the next.
+struct StreamChunk
+{
+    StreamChunk(PointLayout& layout, point_count_t capacity) :
+        m_table(layout, capacity), m_skips(capacity), m_count(0),
+        m_last(false)
+    {}
+
+    ChunkPointTable m_table;
+    SkipMask m_skips;
+    point_count_t m_count;
+    SpatialReference m_srs;
+    bool m_last;
+    // Log output of the stages that processed the chunk, in order.
+    std::vector<std::pair<LogPtr, std::string>> m_messages;
+};
+
+
+// Blocking queue of chunks.  Once closed, pop() returns null.
+class ChunkQueue
+{
+public:
+    ChunkQueue() : m_closed(false)
+    {}
+
+    void push(StreamChunk *chunk)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_chunks.push(chunk);
+        m_cv.notify_one();
+    }
+
+    StreamChunk *pop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_closed || m_chunks.size(); });
+        if (m_closed)
+            return nullptr;
+        StreamChunk *chunk = m_chunks.front();
+        m_chunks.pop();
+        return chunk;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_cv.notify_all();
+    }
+
+private:
+    std::queue<StreamChunk *> m_chunks;
+    bool m_closed;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+} // unnamed namespace
+
 Streamable::Streamable()
 {}
 
 
+void Streamable::processBatch(StreamPointTable& table, point_count_t count,
+    SkipMask& skips)
+{
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
+    {
+        if (skips.skipped(idx))
+            continue;
+        point.setPointId(idx);
+        if (!processOne(point))
+            skips.skip(idx);
+    }
+}
+
+
 bool Streamable::pipelineStreamable() const
 {
     for (const Stage *s : m_inputs)
@@ -107,6 +213,9 @@ void Streamable::execute(StreamPointTable& table)
 
     table.finalize();
 
+    std::size_t numThreads = threads() ? threads() :
+        ThreadPool::hardwareThreads();
+
     // Walk from the current stage backwards.  As we add each input, copy
     // the list of stages and push it on a list.  We then pull a list from the
     // back of list and keep going.  Pushing on the front and pulling from the
@@ -131,7 +240,10 @@ void Streamable::execute(StreamPointTable& table)
             (lastRunStages - stages).done(table);
             // Call ready on all the stages we didn't run last time.
             (stages - lastRunStages).ready(table);
-            execute(table, stages);
+            if (numThreads > 1 && stages.size() > 1 && table.capacity())
+                executeThreaded(table, stages, numThreads);
+            else
+                execute(table, stages);
             lastRunStages = stages;
         }
         else
@@ -158,7 +270,7 @@ void Streamable::execute(StreamPointTable& table)
 void Streamable::execute(StreamPointTable& table,
     std::list<Streamable *>& stages)
 {
-    std::vector<bool> skips(table.capacity());
+    SkipMask skips(table.capacity());
     std::list<Streamable *> filters;
     SpatialReference srs;
     std::map<Streamable *, SpatialReference> srsMap;
@@ -203,9 +315,8 @@ void Streamable::execute(StreamPointTable& table,
         if (!srs.empty())
             table.setSpatialReference(srs);
 
-        // When we get a false back from a filter, we're filtering out a
-        // point, so add it to the list of skips so that it doesn't get
-        // processed by subsequent filters.
+        // When a filter filters out a point, it's added to the skip mask
+        // so that it doesn't get processed by subsequent filters.
         for (Streamable *s : filters)
         {
             if (srsMap[s] != srs)
@@ -214,26 +325,220 @@ void Streamable::execute(StreamPointTable& table,
                 srsMap[s] = srs;
             }
             s->startLogging();
-            for (PointId idx = 0; idx < pointLimit; idx++)
-            {
-                if (skips[idx])
-                    continue;
-                point.setPointId(idx);
-                if (!s->processOne(point))
-                    skips[idx] = true;
-            }
+            s->processBatch(table, pointLimit, skips);
             srs = s->getSpatialReference();
             if (!srs.empty())
                 table.setSpatialReference(srs);
             s->stopLogging();
         }
 
-        // Yes, vector<bool> is terrible.  Can do something better later.
-        for (size_t i = 0; i < skips.size(); ++i)
-            skips[i] = false;
+        skips.reset();
         table.reset();
     }
 }
 
-} // namespace pdal
 
+// Streamed execution in which consecutive groups of stages run on their own
+// threads.  Chunks of points are passed down the pipeline through queues so
+// that, for instance, a reader can decode the next chunk while a writer
+// encodes the previous one.  Each stage still sees every chunk, in order,
+// from a single thread.  Finished chunks are handed to the caller's table
+// in order on the calling thread, as in the serial loop.
+void Streamable::executeThreaded(StreamPointTable& table,
+    std::list<Streamable *>& stages, std::size_t numThreads)
+{
+    typedef std::vector<Streamable *> StageGroup;
+
+    // Split the stages into contiguous groups, one per thread.  The first
+    // group always starts with the reader.
+    std::size_t numGroups = (std::min)(numThreads, stages.size());
+    std::vector<StageGroup> groups(numGroups);
+    auto si = stages.begin();
+    for (std::size_t g = 0; g < numGroups; ++g)
+    {
+        std::size_t count = stages.size() / numGroups;
+        if (g < stages.size() % numGroups)
+            count++;
+        while (count--)
+            groups[g].push_back(*si++);
+    }
+
+    // One chunk per group keeps every thread busy, plus one so that
+    // the reader can start on a new chunk as soon as it's done with the
+    // last one.
+    std::vector<std::unique_ptr<StreamChunk>> chunks;
+    for (std::size_t i = 0; i < numGroups + 1; ++i)
+        chunks.emplace_back(new StreamChunk(*table.layout(),
+            table.capacity()));
+
+    // queues[0] holds free chunks.  queues[g] feeds group g.  The last
+    // group passes finished chunks to the calling thread through 'done'.
+    std::vector<ChunkQueue> queues(numGroups);
+    ChunkQueue done;
+    for (auto& c : chunks)
+        queues[0].push(c.get());
+
+    auto closeAll = [&queues, &done]()
+    {
+        for (ChunkQueue& q : queues)
+            q.close();
+        done.close();
+    };
+
+    // Stages on the worker threads capture their log output, which is
+    // written with the chunk from the calling thread so that only one
+    // thread writes to the log streams.
+    auto capture = [](Streamable *s, StreamChunk& chunk)
+    {
+        LogPtr log = s->log();
+        chunk.m_messages.push_back(std::make_pair(log, log->endCapture()));
+    };
+
+    // Run a stage over the points of a chunk that haven't been skipped.
+    auto process = [&capture](Streamable *s, StreamChunk& chunk,
+        SpatialReference& lastSrs)
+    {
+        s->log()->startCapture();
+        if (lastSrs != chunk.m_srs)
+        {
+            s->spatialReferenceChanged(chunk.m_srs);
+            lastSrs = chunk.m_srs;
+        }
+        s->startLogging();
+        s->processBatch(chunk.m_table, chunk.m_count, chunk.m_skips);
+        SpatialReference srs = s->getSpatialReference();
+        if (!srs.empty())
+        {
+            chunk.m_srs = srs;
+            chunk.m_table.setSpatialReference(srs);
+        }
+        s->stopLogging();
+        capture(s, chunk);
+    };
+
+    auto runGroup = [&](std::size_t g)
+    {
+        StageGroup& group = groups[g];
+        std::vector<SpatialReference> lastSrs(group.size());
+        ChunkQueue& in = queues[g];
+        ChunkQueue& out = (g == numGroups - 1) ? done : queues[g + 1];
+        bool last = false;
+
+        while (!last)
+        {
+            StreamChunk *chunk = in.pop();
+            if (!chunk)
+                break;
+
+            std::size_t first = 0;
+            if (g == 0)
+            {
+                Streamable *reader = group.front();
+                point_count_t pointLimit = chunk->m_table.capacity();
+
+                chunk->m_table.clearSpatialReferences();
+                PointRef point(chunk->m_table, 0);
+                reader->log()->startCapture();
+                reader->startLogging();
+                for (PointId idx = 0; idx < pointLimit; idx++)
+                {
+                    point.setPointId(idx);
+                    if (!reader->processOne(point))
+                    {
+                        pointLimit = idx;
+                        chunk->m_last = true;
+                    }
+                }
+                reader->stopLogging();
+                capture(reader, *chunk);
+                chunk->m_count = pointLimit;
+                chunk->m_srs = reader->getSpatialReference();
+                if (!chunk->m_srs.empty())
+                    chunk->m_table.setSpatialReference(chunk->m_srs);
+                first = 1;
+            }
+            for (std::size_t i = first; i < group.size(); ++i)
+                process(group[i], *chunk, lastSrs[i]);
+
+            last = chunk->m_last;
+            out.push(chunk);
+        }
+    };
+
+    // Write the log output of a chunk, copy its points to the caller's
+    // table and reset the table, which is how the caller consumes them.
+    // The chunk is then recycled for the reader.
+    const PointLayoutPtr layout(table.layout());
+    const std::size_t pointSize = layout->pointSize();
+    auto finish = [&](StreamChunk& chunk)
+    {
+        for (auto& m : chunk.m_messages)
+            m.first->write(m.second);
+        chunk.m_messages.clear();
+
+        for (PointId idx = 0; idx < chunk.m_count; ++idx)
+        {
+            BasePointTable& src = chunk.m_table;
+            BasePointTable& dst = table;
+            std::memcpy(dst.getPoint(idx), src.getPoint(idx), pointSize);
+        }
+        table.clearSpatialReferences();
+        if (!chunk.m_srs.empty())
+            table.setSpatialReference(chunk.m_srs);
+        table.reset();
+
+        chunk.m_table.reset();
+        chunk.m_skips.reset();
+        chunk.m_count = 0;
+        chunk.m_last = false;
+        queues[0].push(&chunk);
+    };
+
+    // Each stage pushes its leader while it processes a chunk, as in the
+    // serial loop.  The log keeps a stack of leaders for each thread, so
+    // the groups don't disturb each other's leaders.
+    ThreadPool pool(numGroups);
+    for (std::size_t g = 0; g < numGroups; ++g)
+        pool.add([&runGroup, &closeAll, &groups, g]()
+        {
+            try
+            {
+                runGroup(g);
+            }
+            catch (...)
+            {
+                // Keep what the stages logged before the error.
+                for (Streamable *s : groups[g])
+                    s->log()->write(s->log()->endCapture());
+
+                // Unblock the other groups so that the pool can be joined.
+                closeAll();
+                throw;
+            }
+        });
+
+    try
+    {
+        while (StreamChunk *chunk = done.pop())
+        {
+            bool last = chunk->m_last;
+            finish(*chunk);
+            if (last)
+                break;
+        }
+    }
+    catch (...)
+    {
+        closeAll();
+        try
+        {
+            pool.join();
+        }
+        catch (...)
+        {}
+        throw;
+    }
+    pool.join();
+}
+
+} // namespace pdal
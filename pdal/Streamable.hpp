@@ -37,9 +37,55 @@
 #include <pdal/pdal_internal.hpp>
 #include <pdal/Stage.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 namespace pdal
 {
 
+/**
+  Marks the points of a batch that have been filtered out during streamed
+  execution, one bit per point.
+*/
+class PDAL_DLL SkipMask
+{
+public:
+    SkipMask(point_count_t size = 0) : m_size(size),
+        m_bits((size + 63) / 64)
+    {}
+
+    /**
+      Determine if a point has been filtered out.
+
+      \param idx  Index of the point in the batch.
+      \return  Whether the point has been filtered out.
+    */
+    bool skipped(PointId idx) const
+        { return (m_bits[idx / 64] >> (idx % 64)) & 1; }
+
+    /**
+      Mark a point as filtered out.
+
+      \param idx  Index of the point in the batch.
+    */
+    void skip(PointId idx)
+        { m_bits[idx / 64] |= (uint64_t)1 << (idx % 64); }
+
+    /**
+      Clear the mask so that no points are filtered out.
+    */
+    void reset()
+        { std::fill(m_bits.begin(), m_bits.end(), 0); }
+
+    point_count_t size() const
+        { return m_size; }
+
+private:
+    point_count_t m_size;
+    std::vector<uint64_t> m_bits;
+};
+
 class PDAL_DLL Streamable : public virtual Stage
 {
 public:
@@ -49,14 +95,21 @@ public:
       Execute a prepared pipeline (linked set of stages) in streaming mode.
 
       This performs the action associated with the stage by executing the
-      \ref processOne function of each stage in depth first order.  Points
-      are processed up to the capacity of the provided StreamPointTable.
-      Not all stages support streaming mode and an exception will be thrown
-      when attempting to \ref execute an unsupported stage.
+      \ref processOne or \ref processBatch function of each stage in depth
+      first order.  Points are processed up to the capacity of the provided
+      StreamPointTable.  Not all stages support streaming mode and an
+      exception will be thrown when attempting to \ref execute an
+      unsupported stage.
 
       Streaming points can reduce memory consumption, but may limit access
       to algorithms that need to operate on full point sets.
 
+      If more than one thread has been allowed with \ref setThreads(),
+      consecutive groups of stages run on separate threads and pass chunks
+      of points between them, so that reading, filtering and writing
+      overlap.  Points are processed in internal chunk tables and copied
+      to \ref table, in order, as each chunk is finished.
+
       \param table  Streming point table used for stage pipeline.  This must be
         the same \ref table used in the \ref prepare function.
 
@@ -76,6 +129,8 @@ protected:
     Streamable(const Streamable&); // not implemented
 
     void execute(StreamPointTable& table, std::list<Streamable *>& stages);
+    void executeThreaded(StreamPointTable& table,
+        std::list<Streamable *>& stages, std::size_t numThreads);
 
     /**
       Process a single point (streaming mode).  Implement in sublcass.
@@ -86,6 +141,21 @@ protected:
         to subsequent stages).
     */
     virtual bool processOne(PointRef& /*point*/) = 0;
+
+    /**
+      Process a batch of points (streaming mode).  This is called for all
+      stages except the first, in place of calling \ref processOne for each
+      point.  The default implementation calls \ref processOne for each
+      point that hasn't been skipped.  Override to handle the points of a
+      batch together.
+
+      \param table  Table holding the points of the batch.
+      \param count  Number of points in the batch, starting with point 0.
+      \param skips  Points filtered out by previous stages.  Set the bit
+        of any point that is to be filtered-out.
+    */
+    virtual void processBatch(StreamPointTable& table, point_count_t count,
+        SkipMask& skips);
     /**
     {
         throwStreamingError();
@@ -42,6 +42,11 @@
 #include <laz-perf/io.hpp>
 #include <laz-perf/las.hpp>
 
+#include <sstream>
+
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
 #include "LazPerfVlrCompression.hpp"
 
 namespace pdal
@@ -66,11 +71,15 @@ class LazPerfVlrCompressorImpl
 
 public:
     LazPerfVlrCompressorImpl(std::ostream& stream, const Schema& schema,
-            uint32_t chunksize) :
+            uint32_t chunksize, std::size_t numThreads) :
         m_stream(stream), m_outputStream(stream), m_schema(schema),
         m_chunksize(chunksize), m_chunkPointsWritten(0), m_chunkInfoPos(0),
-        m_chunkOffset(0)
-    {}
+        m_chunkOffset(0), m_pointSize((size_t)schema.size_in_bytes()),
+        m_started(false)
+    {
+        if (numThreads != 1)
+            m_pool.reset(new ThreadPool(numThreads));
+    }
 
     ~LazPerfVlrCompressorImpl()
     {
@@ -82,6 +91,12 @@ public:
 
     void compress(const char *inbuf)
     {
+        if (m_pool)
+        {
+            compressPending(inbuf);
+            return;
+        }
+
         // First time through.
         if (!m_encoder || !m_compressor)
         {
@@ -103,11 +118,21 @@ public:
 
     void done()
     {
-        // Close and clear the point encoder.
-        m_encoder->done();
-        m_encoder.reset();
+        if (m_pool)
+        {
+            if (!m_started)
+                start();
+            compressChunks();
+            m_pool->join();
+        }
+        else
+        {
+            // Close and clear the point encoder.
+            m_encoder->done();
+            m_encoder.reset();
 
-        newChunk();
+            newChunk();
+        }
 
         // Save our current position.  Go to the location where we need
         // to write the chunk table offset at the beginning of the point data.
@@ -140,6 +165,70 @@ public:
     }
 
 private:
+    // Remember where the chunk table offset goes and skip over it.
+    void start()
+    {
+        m_chunkInfoPos = m_stream.tellp();
+        m_stream.seekp(sizeof(uint64_t), std::ios::cur);
+        m_started = true;
+    }
+
+    // Queue a point to be compressed.  Once there are enough points to
+    // keep every thread busy, the pending chunks are compressed.
+    void compressPending(const char *inbuf)
+    {
+        if (!m_started)
+            start();
+        m_pending.insert(m_pending.end(), inbuf, inbuf + m_pointSize);
+        if (m_pending.size() ==
+                m_pool->numThreads() * m_chunksize * m_pointSize)
+            compressChunks();
+    }
+
+    // Compress each pending chunk in its own task with a fresh encoder, then
+    // write the chunks to the output stream in order.
+    void compressChunks()
+    {
+        const size_t numPoints = m_pending.size() / m_pointSize;
+        const size_t numChunks = (numPoints + m_chunksize - 1) / m_chunksize;
+        std::vector<std::string> chunks(numChunks);
+
+        for (size_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            const size_t first = chunk * m_chunksize;
+            const size_t count =
+                (std::min)((size_t)m_chunksize, numPoints - first);
+            std::string& data = chunks[chunk];
+            m_pool->add([this, first, count, &data]()
+            {
+                std::ostringstream out;
+                {
+                    OutputStream outputStream(out);
+                    Encoder encoder(outputStream);
+                    Compressor::ptr compressor =
+                        laszip::factory::build_compressor(encoder, m_schema);
+
+                    const char *pos = m_pending.data() + first * m_pointSize;
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        compressor->compress(pos);
+                        pos += m_pointSize;
+                    }
+                    encoder.done();
+                }
+                data = out.str();
+            });
+        }
+        m_pool->await();
+
+        for (const std::string& data : chunks)
+        {
+            m_stream.write(data.data(), data.size());
+            m_chunkTable.push_back((uint32_t)data.size());
+        }
+        m_pending.clear();
+    }
+
     void resetCompressor()
     {
         if (m_encoder)
@@ -166,12 +255,17 @@ private:
     std::streampos m_chunkInfoPos;
     std::streampos m_chunkOffset;
     std::vector<uint32_t> m_chunkTable;
+    size_t m_pointSize;
+    bool m_started;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::vector<char> m_pending;
 };
 
 
 LazPerfVlrCompressor::LazPerfVlrCompressor(std::ostream& stream,
-        const Schema& schema, uint32_t chunksize) :
-    m_impl(new LazPerfVlrCompressorImpl(stream, schema, chunksize))
+        const Schema& schema, uint32_t chunksize, std::size_t numThreads) :
+    m_impl(new LazPerfVlrCompressorImpl(stream, schema, chunksize,
+        numThreads))
 {}
 
 
@@ -195,19 +289,93 @@ class LazPerfVlrDecompressorImpl
 {
 public:
     LazPerfVlrDecompressorImpl(std::istream& stream, const char *vlrData,
-        std::streamoff pointOffset) :
+        std::streamoff pointOffset, std::streamoff chunkOffset) :
         m_stream(stream), m_inputStream(stream), m_chunksize(0),
         m_chunkPointsRead(0)
     {
         laszip::io::laz_vlr zipvlr(vlrData);
         m_chunksize = zipvlr.chunk_size;
         m_schema = laszip::io::laz_vlr::to_schema(zipvlr);
-        m_stream.seekg(pointOffset + sizeof(int64_t));
+        if (chunkOffset)
+            m_stream.seekg(chunkOffset);
+        else
+            m_stream.seekg(pointOffset + sizeof(int64_t));
     }
 
     size_t pointSize() const
         { return (size_t)m_schema.size_in_bytes(); }
 
+    static std::vector<std::streamoff> chunkOffsets(std::istream& stream,
+        std::streamoff pointOffset, uint64_t maxChunks)
+    {
+        // A table that can't be read, or doesn't describe chunks that lie
+        // between the start of the point data and the table, gives no
+        // offsets.  The stream is left in a good state.
+        std::vector<std::streamoff> offsets;
+        auto fail = [&stream, &offsets]()
+        {
+            stream.clear();
+            offsets.clear();
+            return offsets;
+        };
+
+        stream.clear();
+        stream.seekg(0, std::ios::end);
+        const std::streamoff fileSize = stream.tellg();
+        if (!stream || fileSize < 0)
+            return fail();
+
+        // The point data starts with the position of the chunk table.  A
+        // writer that didn't finish leaves it as 0 or -1.
+        ILeStream in(&stream);
+        int64_t chunkTablePos;
+        stream.seekg(pointOffset);
+        in >> chunkTablePos;
+        const std::streamoff firstChunk = pointOffset + sizeof(int64_t);
+        if (!stream || chunkTablePos <= firstChunk ||
+            chunkTablePos > fileSize - 8)
+            return fail();
+
+        uint32_t version;
+        uint32_t numChunks;
+        stream.seekg(chunkTablePos);
+        in >> version >> numChunks;
+        if (!stream || version != 0 || numChunks == 0 ||
+            numChunks > maxChunks)
+            return fail();
+
+        // The table holds the compressed size of each chunk.  The first
+        // chunk follows the chunk table position.  The input wrapper reads
+        // ahead, so it reaches the end of the file, and it throws if it
+        // needs data beyond it.
+        try
+        {
+            InputStream inputStream(stream);
+            Decoder decoder(inputStream);
+            laszip::decompressors::integer decompressor(32, 2);
+            decoder.readInitBytes();
+            decompressor.init();
+
+            std::streamoff offset = firstChunk;
+            uint32_t predictor = 0;
+            for (uint32_t i = 0; i < numChunks; ++i)
+            {
+                offsets.push_back(offset);
+                predictor = (uint32_t)decompressor.decompress(decoder,
+                    predictor, 1);
+                offset += predictor;
+                if (predictor == 0 || offset > chunkTablePos)
+                    return fail();
+            }
+        }
+        catch (...)
+        {
+            return fail();
+        }
+        stream.clear();
+        return offsets;
+    }
+
     void decompress(char *outbuf)
     {
         if (m_chunkPointsRead == m_chunksize || !m_decoder || !m_decompressor)
@@ -242,8 +410,10 @@ private:
 };
 
 LazPerfVlrDecompressor::LazPerfVlrDecompressor(std::istream& stream,
-        const char *vlrData, std::streamoff pointOffset) :
-    m_impl(new LazPerfVlrDecompressorImpl(stream, vlrData, pointOffset))
+        const char *vlrData, std::streamoff pointOffset,
+        std::streamoff chunkOffset) :
+    m_impl(new LazPerfVlrDecompressorImpl(stream, vlrData, pointOffset,
+        chunkOffset))
 {}
 
 
@@ -262,5 +432,13 @@ void LazPerfVlrDecompressor::decompress(char *outbuf)
     m_impl->decompress(outbuf);
 }
 
+
+std::vector<std::streamoff> LazPerfVlrDecompressor::chunkOffsets(
+    std::istream& stream, std::streamoff pointOffset, uint64_t maxChunks)
+{
+    return LazPerfVlrDecompressorImpl::chunkOffsets(stream, pointOffset,
+        maxChunks);
+}
+
 } // namespace pdal
 
@@ -34,6 +34,8 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+
 #include <pdal/util/OStream.hpp>
 
 namespace laszip
@@ -58,13 +60,16 @@ namespace pdal
 // The compressor uses the schema of the point data in order to compress
 // the point stream.  The schema is also stored in a VLR that isn't
 // handled as part of the compression process itself.
+// When more than one thread is requested, points are buffered until there
+// is a chunk for each thread.  The chunks are then compressed in parallel
+// and written in order.
 class LazPerfVlrCompressor
 {
     typedef laszip::factory::record_schema Schema;
 
 public:
     PDAL_DLL LazPerfVlrCompressor(std::ostream& stream, const Schema& schema,
-        uint32_t chunksize);
+        uint32_t chunksize, std::size_t numThreads = 1);
     PDAL_DLL ~LazPerfVlrCompressor();
 
     PDAL_DLL void compress(const char *inbuf);
@@ -77,16 +82,27 @@ private:
 
 class LazPerfVlrDecompressorImpl;
 
+// The decompressor reads the point stream written by LazPerfVlrCompressor.
+// Decompression normally starts at the first chunk, but may be started at
+// any chunk whose position has been read from the chunk table.  This allows
+// separate decompressors to work on different chunks at the same time.
 class LazPerfVlrDecompressor
 {
 public:
     PDAL_DLL LazPerfVlrDecompressor(std::istream& stream, const char *vlrData,
-        std::streamoff pointOffset);
+        std::streamoff pointOffset, std::streamoff chunkOffset = 0);
     PDAL_DLL ~LazPerfVlrDecompressor();
 
     PDAL_DLL size_t pointSize() const;
     PDAL_DLL void decompress(char *outbuf);
 
+    // Read the chunk table of the compressed point data that starts at
+    // 'pointOffset' and return the stream position of each chunk.  If the
+    // table is missing, damaged or lists more than 'maxChunks' chunks,
+    // the list is empty.
+    PDAL_DLL static std::vector<std::streamoff> chunkOffsets(
+        std::istream& stream, std::streamoff pointOffset, uint64_t maxChunks);
+
 private:
     std::unique_ptr<LazPerfVlrDecompressorImpl> m_impl;
 };
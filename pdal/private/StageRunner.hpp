@@ -34,9 +34,11 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 
 #include <pdal/Stage.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -45,20 +47,37 @@ class StageRunner
 {
 public:
     StageRunner(Stage *s, PointViewPtr view) :
-        m_stage(s), m_view(view)
+        m_stage(s), m_view(view), m_result(m_promise.get_future())
     {}
 
-    // For now this is all synchronous
+    // Run the stage on the view in the calling thread.
     void run()
-        { m_viewSet = m_stage->run(m_view); }
+    {
+        try
+        {
+            m_promise.set_value(m_stage->run(m_view));
+        }
+        catch (...)
+        {
+            m_promise.set_exception(std::current_exception());
+        }
+    }
 
+    // Queue the stage run on a thread pool.  The runner must outlive
+    // the pool's processing of the task.
+    void run(ThreadPool& pool)
+        { pool.add([this](){ run(); }); }
+
+    // Wait for the run to complete and return its views.  Exceptions
+    // thrown by the stage are rethrown here.
     PointViewSet wait()
-        { return m_viewSet; }
+        { return m_result.get(); }
 
 private:
     Stage *m_stage;
     PointViewPtr m_view;
-    PointViewSet m_viewSet;
+    std::promise<PointViewSet> m_promise;
+    std::future<PointViewSet> m_result;
 };
 typedef std::shared_ptr<StageRunner> StageRunnerPtr;
 
@@ -37,7 +37,10 @@
 #include <iostream>
 #include <sstream>
 #ifndef WIN32
+#include <fcntl.h>
 #include <glob.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #else
 #include <Windows.h>
 #endif
@@ -395,6 +398,119 @@ std::vector<std::string> glob(std::string path)
     return filenames;
 }
 
+
+MapContext mapFile(const std::string& filename, bool readOnly,
+    uintmax_t pos, uintmax_t size)
+{
+    MapContext ctx;
+
+    if (!fileExists(filename))
+    {
+        ctx.m_error = "File doesn't exist.";
+        return ctx;
+    }
+    uintmax_t fileLen = fileSize(filename);
+    if (pos > fileLen || (size && pos + size > fileLen))
+    {
+        ctx.m_error = "Mapped region extends past the end of the file.";
+        return ctx;
+    }
+    if (size == 0)
+        size = fileLen - pos;
+    if (size == 0)
+    {
+        ctx.m_error = "Can't map an empty region.";
+        return ctx;
+    }
+
+#ifndef WIN32
+    ctx.m_fd = ::open(filename.c_str(), readOnly ? O_RDONLY : O_RDWR);
+    if (ctx.m_fd == -1)
+    {
+        ctx.m_error = "Couldn't open file.";
+        return ctx;
+    }
+
+    // The offset of a map must be a multiple of the page size.
+    uintmax_t pageSize = (uintmax_t)sysconf(_SC_PAGESIZE);
+    uintmax_t delta = pos % pageSize;
+    void *addr = ::mmap(0, (size_t)(size + delta),
+        readOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED,
+        ctx.m_fd, (off_t)(pos - delta));
+    if (addr == MAP_FAILED)
+    {
+        ::close(ctx.m_fd);
+        ctx.m_fd = -1;
+        ctx.m_error = "Couldn't map file.";
+        return ctx;
+    }
+    ctx.m_base = addr;
+    ctx.m_addr = (char *)addr + delta;
+#else
+    HANDLE fh = CreateFileA(filename.c_str(),
+        readOnly ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE),
+        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE)
+    {
+        ctx.m_error = "Couldn't open file.";
+        return ctx;
+    }
+
+    HANDLE mh = CreateFileMapping(fh, NULL,
+        readOnly ? PAGE_READONLY : PAGE_READWRITE, 0, 0, NULL);
+    CloseHandle(fh);
+    if (mh == NULL)
+    {
+        ctx.m_error = "Couldn't create file mapping.";
+        return ctx;
+    }
+
+    // The offset of a view must be a multiple of the allocation granularity.
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    uintmax_t delta = pos % info.dwAllocationGranularity;
+    uintmax_t start = pos - delta;
+    void *addr = MapViewOfFile(mh,
+        readOnly ? FILE_MAP_READ : FILE_MAP_WRITE,
+        (DWORD)(start >> 32), (DWORD)start, (SIZE_T)(size + delta));
+    if (addr == NULL)
+    {
+        CloseHandle(mh);
+        ctx.m_error = "Couldn't map file.";
+        return ctx;
+    }
+    ctx.m_handle = mh;
+    ctx.m_base = addr;
+    ctx.m_addr = (char *)addr + delta;
+#endif
+    ctx.m_size = size;
+    return ctx;
+}
+
+
+MapContext unmapFile(MapContext ctx)
+{
+    if (!ctx.m_addr)
+        return ctx;
+
+#ifndef WIN32
+    uintmax_t delta = (char *)ctx.m_addr - (char *)ctx.m_base;
+    if (::munmap(ctx.m_base, (size_t)(ctx.m_size + delta)) == -1)
+        ctx.m_error = "Couldn't unmap file.";
+    ::close(ctx.m_fd);
+#else
+    if (UnmapViewOfFile(ctx.m_base) == 0)
+        ctx.m_error = "Couldn't unmap file.";
+    CloseHandle(ctx.m_handle);
+#endif
+    ctx.m_fd = -1;
+    ctx.m_addr = nullptr;
+    ctx.m_size = 0;
+    ctx.m_base = nullptr;
+    ctx.m_handle = nullptr;
+    return ctx;
+}
+
 } // namespace FileUtils
 
 } // namespace pdal
@@ -41,6 +41,7 @@
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "pdal_util_export.hpp"
 
@@ -49,6 +50,70 @@ namespace pdal
 
 namespace FileUtils
 {
+    /**
+      State of a memory-mapped file.
+    */
+    struct MapContext
+    {
+    public:
+        MapContext() : m_fd(-1), m_addr(nullptr), m_size(0),
+            m_base(nullptr), m_handle(nullptr)
+        {}
+
+        /**
+          Return the address of the mapped data.
+
+          \return  Address of the mapped data, or null if the map failed.
+        */
+        void *addr() const
+            { return m_addr; }
+
+        /**
+          Return the number of bytes mapped.
+
+          \return  Size of the mapped data.
+        */
+        uintmax_t size() const
+            { return m_size; }
+
+        /**
+          Return a description of the error that caused a map to fail.
+
+          \return  Error description.
+        */
+        std::string what() const
+            { return m_error; }
+
+        int m_fd;
+        void *m_addr;
+        uintmax_t m_size;
+        void *m_base;   // Start of the mapped pages.
+        void *m_handle; // Mapping handle (Windows only).
+        std::string m_error;
+    };
+
+    /**
+      Map a file into memory.
+
+      \param filename  Filename.
+      \param readOnly  Whether the mapped data may only be read.
+      \param pos  Offset in the file of the first byte to map.
+      \param size  Number of bytes to map.  Zero means to map from 'pos'
+        to the end of the file.
+      \return  Context of the map.  On failure, the context's address is
+        null and what() describes the error.
+    */
+    PDAL_DLL MapContext mapFile(const std::string& filename,
+        bool readOnly = true, uintmax_t pos = 0, uintmax_t size = 0);
+
+    /**
+      Unmap a file previously mapped with mapFile().
+
+      \param ctx  Context of the map.
+      \return  Context with its address cleared.
+    */
+    PDAL_DLL MapContext unmapFile(MapContext ctx);
+
     /**
       Open an existing file for reading.
 
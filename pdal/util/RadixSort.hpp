@@ -0,0 +1,237 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace pdal
+{
+
+namespace Utils
+{
+
+/**
+  Convert a value to an unsigned key that sorts in the same order as the
+  value when compared as an unsigned integer.  Negative zero is mapped to
+  the key of positive zero so that equal values have equal keys.
+
+  \param d  Value to convert.
+  \return  Sort key.
+*/
+inline uint64_t radixKey(double d)
+{
+    if (d == 0)
+        d = 0;
+    uint64_t u;
+    std::memcpy(&u, &d, sizeof(u));
+    // Flip all bits of negative values and the sign bit of positive ones.
+    return (u & 0x8000000000000000ULL) ? ~u : (u | 0x8000000000000000ULL);
+}
+
+/**
+  \copydoc radixKey(double)
+*/
+inline uint32_t radixKey(float f)
+{
+    if (f == 0)
+        f = 0;
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return (u & 0x80000000U) ? ~u : (u | 0x80000000U);
+}
+
+/**
+  \copydoc radixKey(double)
+*/
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value,
+    typename std::make_unsigned<T>::type>::type radixKey(T t)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    // Flipping the sign bit puts negative values before positive ones.
+    U u = static_cast<U>(t);
+    if (std::is_signed<T>::value)
+        u ^= (U)((U)1 << (sizeof(U) * 8 - 1));
+    return u;
+}
+
+/**
+  Sort items by an unsigned integer key using a least-significant-digit
+  radix sort.  The sort is stable.  Keys are computed and their digits
+  counted in a single pass, and the keys are sorted along with the item's
+  position.  Digits that are the same for every key are skipped.  When
+  sorting on several threads, the digits of each chunk of keys are
+  recounted before each pass after the first.  The items are moved into
+  sorted order once all digits are done.
+
+  \param items  Items to sort.
+  \param key  Function that returns the unsigned integer key of an item.
+  \param numThreads  Number of threads used to sort.  If zero, the number
+    of hardware threads is used.
+*/
+template<typename T, typename KEYFUNC>
+void radixSort(std::vector<T>& items, KEYFUNC key, size_t numThreads = 1)
+{
+    typedef typename std::decay<decltype(key(items[0]))>::type Key;
+    static_assert(std::is_unsigned<Key>::value,
+        "Radix sort keys must be unsigned integers.");
+
+    const size_t Bits = 13;
+    const size_t Radix = (size_t)1 << Bits;
+    const size_t count = items.size();
+    if (count < 2)
+        return;
+    if (numThreads == 0)
+        numThreads = ThreadPool::hardwareThreads();
+
+    // Each chunk of items is counted and scattered by one task.  Small
+    // inputs aren't worth splitting.
+    const size_t MinChunk = 65536;
+    const size_t numChunks =
+        (std::max)((size_t)1, (std::min)(numThreads, count / MinChunk));
+    const size_t chunkSize = (count + numChunks - 1) / numChunks;
+    std::unique_ptr<ThreadPool> pool;
+    if (numChunks > 1)
+        pool.reset(new ThreadPool(numChunks));
+
+    auto run = [&pool, numChunks](const std::function<void(size_t)>& f)
+    {
+        if (!pool)
+            return f(0);
+        for (size_t c = 0; c < numChunks; ++c)
+            pool->add([&f, c](){ f(c); });
+        pool->await();
+    };
+
+    struct Entry
+    {
+        Key key;
+        size_t pos;
+    };
+
+    // Count the occurrences of every digit of the keys, per chunk, while
+    // the keys are computed.
+    const size_t numDigits = (sizeof(Key) * 8 + Bits - 1) / Bits;
+    std::vector<Entry> entries(count);
+    std::vector<std::vector<size_t>> counts(numChunks,
+        std::vector<size_t>(numDigits * Radix));
+    run([&](size_t c)
+    {
+        size_t *cnt = counts[c].data();
+        const size_t end = (std::min)(count, (c + 1) * chunkSize);
+        for (size_t i = c * chunkSize; i < end; ++i)
+        {
+            const Key k = key(items[i]);
+            entries[i] = Entry { k, i };
+            for (size_t d = 0; d < numDigits; ++d)
+                cnt[d * Radix + ((k >> (d * Bits)) & (Radix - 1))]++;
+        }
+    });
+
+    std::vector<Entry> buf(count);
+    std::vector<std::vector<size_t>> offsets(numChunks,
+        std::vector<size_t>(Radix));
+    bool permuted = false;
+    for (size_t d = 0; d < numDigits; ++d)
+    {
+        const size_t shift = d * Bits;
+
+        // Skip the pass when all entries share the digit.
+        bool skip = false;
+        for (size_t v = 0; v < Radix && !skip; ++v)
+        {
+            size_t total = 0;
+            for (size_t c = 0; c < numChunks; ++c)
+                total += counts[c][d * Radix + v];
+            skip = (total == count);
+        }
+        if (skip)
+            continue;
+
+        // Once entries have moved, each chunk holds different entries,
+        // so the digits of each chunk are counted again.
+        if (permuted && numChunks > 1)
+            run([&](size_t c)
+            {
+                size_t *cnt = counts[c].data() + d * Radix;
+                std::fill(cnt, cnt + Radix, 0);
+                const size_t end = (std::min)(count, (c + 1) * chunkSize);
+                for (size_t i = c * chunkSize; i < end; ++i)
+                    cnt[(entries[i].key >> shift) & (Radix - 1)]++;
+            });
+
+        // Convert the counts to the position at which each chunk writes
+        // its entries for each digit value.
+        size_t pos = 0;
+        for (size_t v = 0; v < Radix; ++v)
+            for (size_t c = 0; c < numChunks; ++c)
+            {
+                offsets[c][v] = pos;
+                pos += counts[c][d * Radix + v];
+            }
+
+        run([&](size_t c)
+        {
+            size_t *next = offsets[c].data();
+            const size_t end = (std::min)(count, (c + 1) * chunkSize);
+            for (size_t i = c * chunkSize; i < end; ++i)
+                buf[next[(entries[i].key >> shift) & (Radix - 1)]++] =
+                    entries[i];
+        });
+        entries.swap(buf);
+        permuted = true;
+    }
+    std::vector<Entry>().swap(buf);
+
+    std::vector<T> sorted(count);
+    run([&](size_t c)
+    {
+        const size_t end = (std::min)(count, (c + 1) * chunkSize);
+        for (size_t i = c * chunkSize; i < end; ++i)
+            sorted[i] = std::move(items[entries[i].pos]);
+    });
+    items.swap(sorted);
+}
+
+} // namespace Utils
+} // namespace pdal
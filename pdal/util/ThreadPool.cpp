@@ -0,0 +1,164 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "ThreadPool.hpp"
+
+namespace pdal
+{
+
+ThreadPool::ThreadPool(std::size_t numThreads, std::size_t queueSize) :
+    m_numThreads(numThreads ? numThreads : hardwareThreads()),
+    m_queueSize(queueSize), m_outstanding(0), m_running(false)
+{
+    go();
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    try
+    {
+        join();
+    }
+    catch (...)
+    {}
+}
+
+
+std::size_t ThreadPool::hardwareThreads()
+{
+    std::size_t n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+
+void ThreadPool::go()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+    m_running = true;
+    for (std::size_t i = 0; i < m_numThreads; ++i)
+        m_threads.emplace_back(&ThreadPool::work, this);
+}
+
+
+void ThreadPool::add(std::function<void()> task)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_running)
+    {
+        lock.unlock();
+        go();
+        lock.lock();
+    }
+    m_produceCv.wait(lock, [this]()
+        { return !m_queueSize || m_tasks.size() < m_queueSize; });
+    m_tasks.push(std::move(task));
+    m_outstanding++;
+    lock.unlock();
+    m_consumeCv.notify_one();
+}
+
+
+void ThreadPool::await()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this](){ return m_outstanding == 0; });
+    lock.unlock();
+    rethrow();
+}
+
+
+void ThreadPool::join()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this](){ return m_outstanding == 0; });
+    m_running = false;
+    lock.unlock();
+    m_consumeCv.notify_all();
+
+    for (std::thread& t : m_threads)
+        t.join();
+    m_threads.clear();
+    rethrow();
+}
+
+
+void ThreadPool::rethrow()
+{
+    std::exception_ptr err;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(err, m_error);
+    }
+    if (err)
+        std::rethrow_exception(err);
+}
+
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_consumeCv.wait(lock, [this]()
+            { return m_tasks.size() || !m_running; });
+        if (m_tasks.empty())
+            break;
+
+        std::function<void()> task(std::move(m_tasks.front()));
+        m_tasks.pop();
+        lock.unlock();
+        m_produceCv.notify_one();
+
+        std::exception_ptr err;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            err = std::current_exception();
+        }
+
+        lock.lock();
+        if (err && !m_error)
+            m_error = err;
+        if (--m_outstanding == 0)
+            m_doneCv.notify_all();
+    }
+}
+
+} // namespace pdal
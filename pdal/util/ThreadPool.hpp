@@ -0,0 +1,139 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  A fixed-size pool of worker threads that execute queued tasks.
+
+  Tasks are run in the order they are added.  An exception thrown by a
+  task is captured and rethrown from the next call to \ref await() or
+  \ref join().  Only the first exception is kept.
+*/
+class PDAL_DLL ThreadPool
+{
+public:
+    /**
+      Create a thread pool and start its worker threads.
+
+      \param numThreads  Number of worker threads.  If zero, the number of
+        hardware threads is used.
+      \param queueSize  Maximum number of tasks waiting to be run.  When the
+        queue is full, \ref add() blocks until a task is taken by a worker.
+        Zero means that the queue is unbounded.
+    */
+    ThreadPool(std::size_t numThreads, std::size_t queueSize = 0);
+
+    /**
+      Wait for all queued tasks to complete and stop the worker threads.
+      Any pending task exception is discarded.
+    */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+      Queue a task to be run by a worker thread.
+
+      \param task  Task to run.
+    */
+    void add(std::function<void()> task);
+
+    /**
+      Block until all queued tasks have completed.  The pool remains
+      running and more tasks may be added.  Rethrows the first exception
+      thrown by a task since the last call to await().
+    */
+    void await();
+
+    /**
+      Wait for all queued tasks to complete and stop the worker threads.
+      Rethrows the first exception thrown by a task.
+    */
+    void join();
+
+    /**
+      Restart the worker threads of a pool that has been joined.
+    */
+    void go();
+
+    /**
+      Return the number of worker threads in the pool.
+
+      \return  Number of worker threads.
+    */
+    std::size_t numThreads() const
+        { return m_numThreads; }
+
+    /**
+      Return the number of threads to use when zero threads are requested.
+
+      \return  Number of hardware threads, or one if it can't be determined.
+    */
+    static std::size_t hardwareThreads();
+
+private:
+    void work();
+    void rethrow();
+
+    std::size_t m_numThreads;
+    std::size_t m_queueSize;
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::size_t m_outstanding;
+    bool m_running;
+    std::exception_ptr m_error;
+
+    std::mutex m_mutex;
+    std::condition_variable m_produceCv;
+    std::condition_variable m_consumeCv;
+    std::condition_variable m_doneCv;
+};
+
+} // namespace pdal
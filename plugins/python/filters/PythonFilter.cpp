@@ -60,6 +60,8 @@ void PythonFilter::addArgs(ProgramArgs& args)
     args.add("function", "Function to call", m_function);
     args.add("add_dimension", "Dimensions to add", m_addDimensions);
     args.add("pdalargs", "Dictionary to add to module globals when calling function", m_pdalargs);
+    args.add("share_inputs", "Pass input arrays that share memory with the "
+        "points when possible", m_shareInputs, false);
 }
 
 
@@ -77,6 +79,7 @@ void PythonFilter::ready(PointTableRef table)
     static_cast<plang::Environment*>(plang::Environment::get())->set_stdout(log()->getLogStream());
     m_script = new plang::Script(m_source, m_module, m_function);
     m_pythonMethod = new plang::Invocation(*m_script);
+    m_pythonMethod->setShareInputs(m_shareInputs);
     m_pythonMethod->compile();
     m_totalMetadata = table.metadata();
 }
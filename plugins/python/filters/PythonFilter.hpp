@@ -62,6 +62,7 @@ private:
     std::string m_module;
     std::string m_function;
     StringList m_addDimensions;
+    bool m_shareInputs;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
@@ -51,6 +51,8 @@
 #define PY_ARRAY_UNIQUE_SYMBOL PDAL_ARRAY_API
 #include <numpy/arrayobject.h>
 
+#include <cstring>
+
 namespace
 {
 
@@ -68,6 +70,45 @@ int argCount(PyObject *function)
     return (int) PyList_Size(arglist);
 }
 
+template<typename T>
+char *columnData(pdal::PointView& view, pdal::Dimension::Id dim)
+{
+    return reinterpret_cast<char *>(view.column<T>(dim));
+}
+
+char *columnData(pdal::PointView& view, pdal::Dimension::Id dim,
+    pdal::Dimension::Type type)
+{
+    using namespace pdal::Dimension;
+
+    switch (type)
+    {
+    case Type::Float:
+        return columnData<float>(view, dim);
+    case Type::Double:
+        return columnData<double>(view, dim);
+    case Type::Signed8:
+        return columnData<int8_t>(view, dim);
+    case Type::Signed16:
+        return columnData<int16_t>(view, dim);
+    case Type::Signed32:
+        return columnData<int32_t>(view, dim);
+    case Type::Signed64:
+        return columnData<int64_t>(view, dim);
+    case Type::Unsigned8:
+        return columnData<uint8_t>(view, dim);
+    case Type::Unsigned16:
+        return columnData<uint16_t>(view, dim);
+    case Type::Unsigned32:
+        return columnData<uint32_t>(view, dim);
+    case Type::Unsigned64:
+        return columnData<uint64_t>(view, dim);
+    case Type::None:
+        break;
+    }
+    return nullptr;
+}
+
 }
 
 namespace pdal
@@ -85,6 +126,7 @@ Invocation::Invocation(const Script& script)
     , m_varsOut(NULL)
     , m_scriptArgs(NULL)
     , m_scriptResult(NULL)
+    , m_shareInputs(false)
     , m_metadata_PyObject(NULL)
     , m_schema_PyObject(NULL)
     , m_srs_PyObject(NULL)
@@ -151,12 +193,12 @@ void Invocation::resetArguments()
 
 
 void Invocation::insertArgument(std::string const& name, uint8_t* data,
-    Dimension::Type t, point_count_t count)
+    Dimension::Type t, point_count_t count, std::ptrdiff_t dataStride)
 {
     npy_intp mydims = count;
     int nd = 1;
     npy_intp* dims = &mydims;
-    npy_intp stride = Dimension::size(t);
+    npy_intp stride = dataStride ? dataStride : Dimension::size(t);
     npy_intp* strides = &stride;
 
 #ifdef NPY_ARRAY_CARRAY
@@ -176,6 +218,16 @@ void Invocation::insertArgument(std::string const& name, uint8_t* data,
 
 void *Invocation::extractResult(std::string const& name,
     Dimension::Type t)
+{
+    PyArrayObject* arr = (PyArrayObject*)extractArray(name, t);
+
+    npy_intp one = 0;
+    return PyArray_GetPtr(arr, &one);
+}
+
+
+PyObject *Invocation::extractArray(std::string const& name,
+    Dimension::Type t)
 {
     PyObject* xarr = PyDict_GetItemString(m_varsOut, name.c_str());
     if (!xarr)
@@ -186,8 +238,6 @@ void *Invocation::extractResult(std::string const& name,
 
     PyArrayObject* arr = (PyArrayObject*)xarr;
 
-    npy_intp one = 0;
-    const int pyDataType = pdal::plang::Environment::getPythonDataType(t);
     PyArray_Descr *dtype = PyArray_DESCR(arr);
 
     if (static_cast<uint32_t>(dtype->elsize) != Dimension::size(t))
@@ -226,7 +276,7 @@ void *Invocation::extractResult(std::string const& name,
             "dimension data type of '" << name << "' is not pdal::Floating.";
         throw pdal::pdal_error(oss.str());
     }
-    return PyArray_GetPtr(arr, &one);
+    return xarr;
 }
 
 
@@ -362,24 +412,91 @@ void Invocation::setKWargs(std::string const& s)
     m_pdalargs_PyObject = getPyJSON(s);
 }
 
+// Find the dimensions whose values can be passed to Python without a copy:
+// those stored as a column and, when the points of the view are evenly
+// spaced in memory, those of packed points.  A view of every other point
+// of a table, for example, is evenly spaced.
+std::map<Dimension::Id, Invocation::Field>
+Invocation::findFields(PointView& view)
+{
+    std::map<Dimension::Id, Field> fields;
+    if (view.empty())
+        return fields;
+
+    PointLayoutPtr layout(view.m_pointTable.layout());
+    char *base = nullptr;
+    std::ptrdiff_t stride = layout->pointSize();
+    if (view.supportsPointAccess())
+    {
+        base = view.getPoint(0);
+        if (view.size() > 1)
+            stride = view.getPoint(1) - base;
+        for (PointId idx = 1; idx < view.size(); ++idx)
+            if (!stride || view.getPoint(idx) != base + idx * stride)
+            {
+                base = nullptr;
+                break;
+            }
+    }
+
+    for (Dimension::Id d : layout->dims())
+    {
+        const Dimension::Detail *dd = layout->dimDetail(d);
+        Field f { columnData(view, d, dd->type()), (std::ptrdiff_t)dd->size() };
+        if (!f.m_data && base)
+            f = Field { base + dd->offset(), stride };
+        if (f.m_data)
+            fields[d] = f;
+    }
+    return fields;
+}
+
+
 void Invocation::begin(PointView& view, MetadataNode m)
 {
     PointLayoutPtr layout(view.m_pointTable.layout());
     Dimension::IdList const& dims = layout->dims();
 
+    m_fields = findFields(view);
     for (auto di = dims.begin(); di != dims.end(); ++di)
     {
         Dimension::Id d = *di;
         const Dimension::Detail *dd = layout->dimDetail(d);
-        void *data = malloc(dd->size() * view.size());
+        std::string name = layout->dimName(*di);
+
+        // Arrays of dimensions found in the table can alias the point data.
+        auto fi = m_fields.find(d);
+        if (m_shareInputs && fi != m_fields.end())
+        {
+            insertArgument(name, (uint8_t *)fi->second.m_data, dd->type(),
+                view.size(), fi->second.m_stride);
+            continue;
+        }
+
+        const size_t size = dd->size();
+        void *data = malloc(size * view.size());
         m_buffers.push_back(data);  // Hold pointer for deallocation
         char *p = (char *)data;
-        for (PointId idx = 0; idx < view.size(); ++idx)
+        if (fi != m_fields.end())
         {
-            view.getFieldInternal(d, idx, (void *)p);
-            p += dd->size();
+            const Field& f = fi->second;
+            if (f.m_stride == (std::ptrdiff_t)size)
+                std::memcpy(p, f.m_data, size * view.size());
+            else
+                for (PointId idx = 0; idx < view.size(); ++idx)
+                {
+                    std::memcpy(p, f.m_data + idx * f.m_stride, size);
+                    p += size;
+                }
+        }
+        else
+        {
+            for (PointId idx = 0; idx < view.size(); ++idx)
+            {
+                view.getFieldInternal(d, idx, (void *)p);
+                p += size;
+            }
         }
-        std::string name = layout->dimName(*di);
         insertArgument(name, (uint8_t *)data, dd->type(), view.size());
     }
 
@@ -416,6 +533,12 @@ void Invocation::end(PointView& view, MetadataNode m)
     PointLayoutPtr layout(view.m_pointTable.layout());
     Dimension::IdList const& dims = layout->dims();
 
+    // Arrays to write, as contiguous arrays that don't share memory with
+    // the point data, so that writing one can't change another.
+    std::vector<std::pair<Dimension::Id, PyArrayObject *>> outputs;
+    // A script can change shared inputs in place without adding them to
+    // 'outs', so any position may have changed when inputs are shared.
+    bool moved = m_shareInputs;
     for (auto di = dims.begin(); di != dims.end(); ++di)
     {
         Dimension::Id d = *di;
@@ -423,22 +546,77 @@ void Invocation::end(PointView& view, MetadataNode m)
         std::string name = layout->dimName(*di);
         auto found = std::find(names.begin(), names.end(), name);
         if (found == names.end()) continue; // didn't have this dim in the names
+        if (d == Dimension::Id::X || d == Dimension::Id::Y ||
+                d == Dimension::Id::Z)
+            moved = true;
 
         assert(name == *found);
         assert(hasOutputVariable(name));
 
+        PyArrayObject *arr = (PyArrayObject *)extractArray(name, dd->type());
+        if (PyArray_SIZE(arr) < (npy_intp)view.size())
+        {
+            std::ostringstream oss;
+            oss << "Plang output variable '" << name << "' has " <<
+                PyArray_SIZE(arr) << " values but the view has " <<
+                view.size() << " points.";
+            throw pdal::pdal_error(oss.str());
+        }
+
+        // An array that aliases the dimension's values, such as an input
+        // array that was modified in place, has already been written.
+        auto fi = m_fields.find(d);
+        if (fi != m_fields.end() && PyArray_NDIM(arr) == 1 &&
+            PyArray_BYTES(arr) == fi->second.m_data &&
+            PyArray_STRIDE(arr, 0) == fi->second.m_stride)
+            continue;
+
+        if (PyArray_CHKFLAGS(arr, NPY_ARRAY_OWNDATA))
+            arr = (PyArrayObject *)PyArray_GETCONTIGUOUS(arr);
+        else
+            arr = (PyArrayObject *)PyArray_NewCopy(arr, NPY_CORDER);
+        outputs.push_back(std::make_pair(d, arr));
+    }
+
+    for (auto& out : outputs)
+    {
+        Dimension::Id d = out.first;
+        const Dimension::Detail *dd = layout->dimDetail(d);
         size_t size = dd->size();
-        void *data = extractResult(name, dd->type());
-        char *p = (char *)data;
-        for (PointId idx = 0; idx < view.size(); ++idx)
+        char *p = PyArray_BYTES(out.second);
+
+        auto fi = m_fields.find(d);
+        if (fi != m_fields.end())
         {
-            view.setField(d, dd->type(), idx, (void *)p);
-            p += size;
+            const Field& f = fi->second;
+            if (f.m_stride == (std::ptrdiff_t)size)
+                std::memcpy(f.m_data, p, size * view.size());
+            else
+                for (PointId idx = 0; idx < view.size(); ++idx)
+                {
+                    std::memcpy(f.m_data + idx * f.m_stride, p, size);
+                    p += size;
+                }
         }
+        else
+        {
+            for (PointId idx = 0; idx < view.size(); ++idx)
+            {
+                view.setField(d, dd->type(), idx, (void *)p);
+                p += size;
+            }
+        }
+        Py_DECREF(out.second);
     }
+
+    // Values copied straight to the point data bypass the view, so cached
+    // neighbor tables and indexes have to be discarded here.
+    if (moved)
+        view.invalidateNeighbors();
     for (auto bi = m_buffers.begin(); bi != m_buffers.end(); ++bi)
         free(*bi);
     m_buffers.clear();
+    m_fields.clear();
     if (m_metadata_PyObject)
         addMetadata(m_metadata_PyObject, m);
 }
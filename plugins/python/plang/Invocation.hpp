@@ -42,6 +42,9 @@
 #include <pdal/Dimension.hpp>
 #include <pdal/PointView.hpp>
 
+#include <cstddef>
+#include <map>
+
 namespace pdal
 {
 namespace plang
@@ -60,11 +63,13 @@ public:
 
 
     // creates a Python variable pointing to a (one dimensional) C array
-    // adds the new variable to the arguments dictionary
+    // adds the new variable to the arguments dictionary.  A stride of
+    // zero means that the values are packed.
     void insertArgument(std::string const& name,
                         uint8_t* data,
                         Dimension::Type t,
-                        point_count_t count);
+                        point_count_t count,
+                        std::ptrdiff_t stride = 0);
     void *extractResult(const std::string& name,
                         Dimension::Type dataType);
 
@@ -85,10 +90,27 @@ public:
     void begin(PointView& view, MetadataNode m);
     void end(PointView& view, MetadataNode m);
 
+    // Let the arrays in 'ins' share memory with the point data when
+    // possible, instead of being copies.  A script that changes a shared
+    // array in place changes the points, so this is off by default.
+    void setShareInputs(bool share)
+        { m_shareInputs = share; }
+
     void setKWargs(std::string const& s);
 
 private:
+    // Values of a dimension in the point table, spaced by a constant
+    // stride.
+    struct Field
+    {
+        char *m_data;
+        std::ptrdiff_t m_stride;
+    };
+
     void cleanup();
+    PyObject *extractArray(const std::string& name,
+                           Dimension::Type dataType);
+    std::map<Dimension::Id, Field> findFields(PointView& view);
 
     Script m_script;
 
@@ -106,6 +128,8 @@ private:
     Invocation& operator=(Invocation const& rhs); // nope
 
     std::vector<void *> m_buffers;
+    std::map<Dimension::Id, Field> m_fields;
+    bool m_shareInputs;
     PyObject* m_metadata_PyObject;
     PyObject* m_schema_PyObject;
     PyObject* m_srs_PyObject;
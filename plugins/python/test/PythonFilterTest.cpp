@@ -34,6 +34,7 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/KDIndex.hpp>
 #include <pdal/PipelineManager.hpp>
 #include <pdal/StageFactory.hpp>
 #include <io/FauxReader.hpp>
@@ -871,6 +872,175 @@ TEST(PLangTest, PLangTest_reentry)
     }
 }
 
+namespace
+{
+
+// Run a script that modifies an input array in place and swaps two
+// dimensions, on every other point of the table if 'skip' is set.
+void testBeginEnd(BasePointTable& table, bool skip, bool share)
+{
+    const char* source =
+        "import numpy as np\n"
+        "def yow(ins,outs):\n"
+        "  X = ins['X']\n"
+        "  X += 1\n"
+        "  outs['X'] = X\n"
+        "  outs['Y'] = ins['Z']\n"
+        "  outs['Z'] = ins['Y']\n"
+        "  return True\n"
+        ;
+
+    using namespace Dimension;
+
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+    table.finalize();
+    PointViewPtr all(new PointView(table));
+    for (PointId i = 0; i < 20; ++i)
+    {
+        all->setField(Id::X, i, i);
+        all->setField(Id::Y, i, i * 10);
+        all->setField(Id::Z, i, i * 100);
+    }
+    PointViewPtr view = all->makeNew();
+    for (PointId i = 0; i < all->size(); i += (skip ? 2 : 1))
+        view->appendPoint(*all, i);
+
+    Script script(source, "MyTest", "yow");
+    Invocation meth(script);
+    meth.setShareInputs(share);
+    meth.compile();
+    meth.begin(*view, MetadataNode());
+    meth.execute();
+    meth.end(*view, MetadataNode());
+
+    for (PointId i = 0; i < all->size(); ++i)
+    {
+        bool changed = !skip || (i % 2 == 0);
+        EXPECT_EQ(all->getFieldAs<double>(Id::X, i), changed ? i + 1 : i);
+        EXPECT_EQ(all->getFieldAs<double>(Id::Y, i),
+            changed ? i * 100 : i * 10);
+        EXPECT_EQ(all->getFieldAs<double>(Id::Z, i),
+            changed ? i * 10 : i * 100);
+    }
+}
+
+} // unnamed namespace
+
+// When shared, arrays alias the point data for columns and evenly spaced
+// points and are copies otherwise (every other point of a column table).
+// The results must be the same whether or not the inputs are shared.
+TEST(PLangTest, PLangTest_beginEnd)
+{
+    for (bool share : { false, true })
+    {
+        {
+            PointTable table;
+            testBeginEnd(table, false, share);
+        }
+        {
+            PointTable table;
+            testBeginEnd(table, true, share);
+        }
+        {
+            ColumnPointTable table;
+            testBeginEnd(table, false, share);
+        }
+        {
+            ColumnPointTable table;
+            testBeginEnd(table, true, share);
+        }
+    }
+}
+
+// Changing an input array in place only changes the points when the inputs
+// are shared.
+TEST(PLangTest, PLangTest_shareInputs)
+{
+    const char* source =
+        "import numpy as np\n"
+        "def yow(ins,outs):\n"
+        "  Z = ins['Z']\n"
+        "  Z -= 5\n"
+        "  return True\n"
+        ;
+
+    using namespace Dimension;
+
+    for (bool share : { false, true })
+    {
+        PointTable table;
+        table.layout()->registerDim(Id::Z);
+        table.finalize();
+        PointViewPtr view(new PointView(table));
+        for (PointId i = 0; i < 10; ++i)
+            view->setField(Id::Z, i, i * 10);
+
+        Script script(source, "MyTest", "yow");
+        Invocation meth(script);
+        meth.setShareInputs(share);
+        meth.compile();
+        meth.begin(*view, MetadataNode());
+        meth.execute();
+        meth.end(*view, MetadataNode());
+
+        for (PointId i = 0; i < view->size(); ++i)
+            EXPECT_EQ(view->getFieldAs<double>(Id::Z, i),
+                share ? i * 10 - 5.0 : i * 10);
+    }
+}
+
+// Positions written by a script, whether through 'outs' or in place in a
+// shared input, discard the view's cached neighbors.
+TEST(PLangTest, PLangTest_invalidateNeighbors)
+{
+    const char* outSource =
+        "import numpy as np\n"
+        "def yow(ins,outs):\n"
+        "  outs['X'] = ins['X'] * 10\n"
+        "  return True\n"
+        ;
+    const char* inPlaceSource =
+        "import numpy as np\n"
+        "def yow(ins,outs):\n"
+        "  X = ins['X']\n"
+        "  X *= 10\n"
+        "  return True\n"
+        ;
+
+    using namespace Dimension;
+
+    for (bool share : { false, true })
+        for (const char *source : { outSource, inPlaceSource })
+        {
+            if (source == inPlaceSource && !share)
+                continue;
+
+            PointTable table;
+            table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+            table.finalize();
+            PointViewPtr view(new PointView(table));
+            for (PointId i = 0; i < 10; ++i)
+            {
+                view->setField(Id::X, i, i);
+                view->setField(Id::Y, i, 0);
+                view->setField(Id::Z, i, 0);
+            }
+            EXPECT_EQ(view->radiusTable(1.5)->count(5), 3u);
+
+            Script script(source, "MyTest", "yow");
+            Invocation meth(script);
+            meth.setShareInputs(share);
+            meth.compile();
+            meth.begin(*view, MetadataNode());
+            meth.execute();
+            meth.end(*view, MetadataNode());
+
+            EXPECT_EQ(view->getFieldAs<double>(Id::X, 5), 50.0);
+            EXPECT_EQ(view->radiusTable(1.5)->count(5), 1u);
+        }
+}
+
+
 TEST(PLangTest, log)
 {
     // verify we can redirect the stdout inside the python script
@@ -39,6 +39,7 @@
 
 #include <Eigen/Dense>
 
+#include <cmath>
 #include <limits>
 
 using namespace pdal;
@@ -259,3 +260,55 @@ TEST(EigenTest, RoundtripString)
     ASSERT_EQ(identity.size(), target.size());
     EXPECT_EQ(identity, target);
 }
+
+TEST(EigenTest, Spline)
+{
+    using namespace Eigen;
+
+    // Control points on a plane, with some missing, and points to be
+    // interpolated at twice the resolution.
+    const int n = 12;
+    auto plane = [](double x, double y) { return 2.0 + 0.5 * x - 0.25 * y; };
+    MatrixXd x(n, n), y(n, n), z(n, n);
+    for (int c = 0; c < n; ++c)
+        for (int r = 0; r < n; ++r)
+        {
+            x(r, c) = 2.0 * c + 0.3 * ((r + c) % 3);
+            y(r, c) = 2.0 * r + 0.2 * ((r * c) % 4);
+            z(r, c) = plane(x(r, c), y(r, c));
+            if ((r * 7 + c * 3) % 11 == 0)
+                x(r, c) = y(r, c) = z(r, c) =
+                    std::numeric_limits<double>::quiet_NaN();
+        }
+    MatrixXd xx(2 * n, 2 * n), yy(2 * n, 2 * n);
+    for (int c = 0; c < 2 * n; ++c)
+        for (int r = 0; r < 2 * n; ++r)
+        {
+            xx(r, c) = c + 0.5;
+            yy(r, c) = r + 0.5;
+        }
+
+    // Both splines reproduce a plane.
+    MatrixXd S = eigen::computeSpline(x, y, z, xx, yy);
+    MatrixXd C = eigen::computeCompactSpline(x, y, z, xx, yy, 8.0);
+    for (int i = 0; i < S.size(); ++i)
+    {
+        EXPECT_NEAR(plane(xx(i), yy(i)), S(i), 1e-6);
+        EXPECT_NEAR(plane(xx(i), yy(i)), C(i), 1e-6);
+    }
+
+    // Results don't depend on the number of threads.
+    for (int i = 0; i < z.size(); ++i)
+        if (!std::isnan(z(i)))
+            z(i) += std::sin(x(i)) * std::cos(y(i));
+    S = eigen::computeSpline(x, y, z, xx, yy);
+    EXPECT_EQ(S, eigen::computeSpline(x, y, z, xx, yy, 4));
+    C = eigen::computeCompactSpline(x, y, z, xx, yy, 8.0);
+    EXPECT_EQ(C, eigen::computeCompactSpline(x, y, z, xx, yy, 8.0, 4));
+
+    // The compact spline interpolates the control points.
+    MatrixXd I = eigen::computeCompactSpline(x, y, z, x, y, 8.0);
+    for (int i = 0; i < z.size(); ++i)
+        if (!std::isnan(z(i)))
+            EXPECT_NEAR(z(i), I(i), 1e-6);
+}
@@ -247,3 +247,42 @@ TEST(FileUtilsTest, glob)
     EXPECT_EQ(FileUtils::glob("temp.glob").size(), 1u);
     FileUtils::deleteFile("temp.glob");
 }
+
+TEST(FileUtilsTest, map)
+{
+    std::string filename(Support::temppath("map.tmp"));
+    FileUtils::deleteFile(filename);
+
+    std::ostream *out = FileUtils::createFile(filename);
+    for (uint32_t i = 0; i < 10000; ++i)
+        out->write((const char *)&i, sizeof(i));
+    FileUtils::closeFile(out);
+
+    // An offset that isn't a multiple of the page size.
+    FileUtils::MapContext ctx = FileUtils::mapFile(filename, true,
+        5001 * sizeof(uint32_t), 100 * sizeof(uint32_t));
+    ASSERT_TRUE(ctx.addr());
+    EXPECT_EQ(ctx.size(), 100 * sizeof(uint32_t));
+    const uint32_t *vals = (const uint32_t *)ctx.addr();
+    EXPECT_EQ(vals[0], 5001u);
+    EXPECT_EQ(vals[99], 5100u);
+    ctx = FileUtils::unmapFile(ctx);
+    EXPECT_FALSE(ctx.addr());
+    EXPECT_EQ(ctx.what(), "");
+
+    // Zero size maps to the end of the file.
+    ctx = FileUtils::mapFile(filename);
+    ASSERT_TRUE(ctx.addr());
+    EXPECT_EQ(ctx.size(), 10000 * sizeof(uint32_t));
+    ctx = FileUtils::unmapFile(ctx);
+
+    ctx = FileUtils::mapFile(filename, true, 9999 * sizeof(uint32_t),
+        2 * sizeof(uint32_t));
+    EXPECT_FALSE(ctx.addr());
+    EXPECT_NE(ctx.what(), "");
+
+    ctx = FileUtils::mapFile(Support::temppath("nonexistent.tmp"));
+    EXPECT_FALSE(ctx.addr());
+
+    FileUtils::deleteFile(filename);
+}
@@ -356,3 +356,136 @@ TEST(KDIndex, radius3D)
     EXPECT_EQ(ids[2], 2u);
 }
 
+
+TEST(KDIndex, leafSize)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    const point_count_t count = 1000;
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, Utils::random(0, 100));
+        view.setField(Dimension::Id::Y, i, Utils::random(0, 100));
+        view.setField(Dimension::Id::Z, i, Utils::random(0, 100));
+    }
+
+    KD3Index small(view);
+    small.build(1);
+    KD3Index large(view);
+    large.build(500);
+
+    const point_count_t k = 8;
+    std::vector<PointId> smallIds(k);
+    std::vector<double> smallDists(k);
+    std::vector<PointId> largeIds(k);
+    std::vector<double> largeDists(k);
+    for (PointId i = 0; i < count; ++i)
+    {
+        small.knnSearch(i, k, &smallIds, &smallDists);
+        large.knnSearch(i, k, &largeIds, &largeDists);
+        EXPECT_EQ(smallIds[0], i);
+        for (point_count_t j = 0; j < k; ++j)
+            EXPECT_DOUBLE_EQ(smallDists[j], largeDists[j]);
+    }
+
+    // Positions are copied when the index is built.
+    double x = view.getFieldAs<double>(Dimension::Id::X, 0);
+    double y = view.getFieldAs<double>(Dimension::Id::Y, 0);
+    double z = view.getFieldAs<double>(Dimension::Id::Z, 0);
+    view.setField(Dimension::Id::X, 0, 1000);
+    EXPECT_EQ(small.neighbor(x, y, z), 0u);
+}
+
+TEST(KDIndex, searchAll)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    const point_count_t count = 5000;
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, Utils::random(0, 100));
+        view.setField(Dimension::Id::Y, i, Utils::random(0, 100));
+        view.setField(Dimension::Id::Z, i, Utils::random(0, 100));
+    }
+
+    KD3Index index(view);
+    index.build();
+
+    const point_count_t k = 6;
+    std::vector<PointId> ids(k);
+    std::vector<double> dists(k);
+    for (std::size_t threads : { 1, 4 })
+    {
+        NeighborTable knn = index.knnSearchAll(k, threads);
+        ASSERT_EQ(knn.size(), count);
+        for (PointId i = 0; i < count; ++i)
+        {
+            index.knnSearch(i, k, &ids, &dists);
+            ASSERT_EQ(knn.count(i), k);
+            EXPECT_EQ(knn.neighbors(i), ids);
+            for (point_count_t j = 0; j < k; ++j)
+                EXPECT_DOUBLE_EQ(knn.sqrDists(i)[j], dists[j]);
+        }
+
+        NeighborTable rad = index.radiusSearchAll(5.0, threads);
+        ASSERT_EQ(rad.size(), count);
+        for (PointId i = 0; i < count; ++i)
+        {
+            std::vector<PointId> expected = index.radius(i, 5.0);
+            EXPECT_EQ(rad.neighbors(i), expected);
+            for (std::size_t j = 0; j < rad.count(i); ++j)
+                EXPECT_LE(rad.sqrDists(i)[j], 25.0);
+        }
+    }
+}
+
+TEST(KDIndex, idOutOfRange)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    for (PointId i = 0; i < 10; ++i)
+    {
+        view.setField(Dimension::Id::X, i, i);
+        view.setField(Dimension::Id::Y, i, i);
+        view.setField(Dimension::Id::Z, i, i);
+    }
+
+    KD2Index index2(view);
+    index2.build();
+    KD3Index index3(view);
+    index3.build();
+
+    // Points added after the index is built can't be queried by ID.
+    view.setField(Dimension::Id::X, 10, 10);
+    view.setField(Dimension::Id::Y, 10, 10);
+    view.setField(Dimension::Id::Z, 10, 10);
+
+    std::vector<PointId> ids(2);
+    std::vector<double> dists(2);
+    EXPECT_EQ(index2.neighbors(9, 2).size(), 2u);
+    EXPECT_THROW(index2.neighbors(10, 2), pdal_error);
+    EXPECT_THROW(index2.knnSearch(10, 2, &ids, &dists), pdal_error);
+    EXPECT_THROW(index2.radius(10, 1.0), pdal_error);
+    EXPECT_EQ(index3.neighbors(9, 2).size(), 2u);
+    EXPECT_THROW(index3.neighbors(10, 2), pdal_error);
+    EXPECT_THROW(index3.knnSearch(10, 2, &ids, &dists), pdal_error);
+    EXPECT_THROW(index3.radius(10, 1.0), pdal_error);
+}
@@ -37,6 +37,9 @@
 #include <pdal/util/FileUtils.hpp>
 #include "Support.hpp"
 
+#include <sstream>
+#include <thread>
+
 namespace pdal
 {
 
@@ -86,4 +89,58 @@ TEST(Log, t2)
     FileUtils::deleteFile(out);
 }
 
+
+// Make sure that leaders pushed on one thread don't affect another.
+TEST(Log, threadLeaders)
+{
+    std::ostringstream out;
+    Log l("base", &out);
+
+    l.pushLeader("main");
+    std::string before;
+    std::string during;
+    std::string after;
+    std::thread t([&l, &before, &during, &after]()
+    {
+        before = l.leader();
+        l.pushLeader("worker");
+        during = l.leader();
+        l.popLeader();
+        after = l.leader();
+    });
+    t.join();
+
+    EXPECT_EQ(before, "base");
+    EXPECT_EQ(during, "worker");
+    EXPECT_EQ(after, "base");
+    EXPECT_EQ(l.leader(), "main");
+    l.popLeader();
+    EXPECT_EQ(l.leader(), "base");
+}
+
+TEST(Log, capture)
+{
+    std::ostringstream out;
+    Log l("base", &out);
+    l.setLevel(LogLevel::Debug);
+
+    std::string captured;
+    std::thread t([&l, &captured]()
+    {
+        l.startCapture();
+        l.get(LogLevel::Info) << "from worker" << std::endl;
+        captured = l.endCapture();
+        l.get(LogLevel::Info) << "uncaptured" << std::endl;
+    });
+    t.join();
+
+    EXPECT_EQ(captured, "(base Info) from worker\n");
+    EXPECT_EQ(out.str(), "(base Info) uncaptured\n");
+
+    l.write(captured);
+    EXPECT_EQ(out.str(),
+        "(base Info) uncaptured\n(base Info) from worker\n");
+    EXPECT_EQ(l.endCapture(), "");
+}
+
 }
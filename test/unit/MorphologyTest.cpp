@@ -0,0 +1,153 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include <pdal/Morphology.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+bool inElement(Morphology::Shape shape, int dr, int dc, int r)
+{
+    switch (shape)
+    {
+    case Morphology::Shape::Diamond:
+        return std::abs(dr) + std::abs(dc) <= r;
+    case Morphology::Shape::Square:
+        return true;
+    case Morphology::Shape::Disk:
+        return dr * dr + dc * dc <= r * r;
+    }
+    return false;
+}
+
+// Erode or dilate by examining every cell of the structuring element.
+std::vector<double> bruteForce(const std::vector<double>& data, int rows,
+    int cols, Morphology::Shape shape, int r, bool erode)
+{
+    std::vector<double> out(data.size());
+    for (int c = 0; c < cols; ++c)
+        for (int row = 0; row < rows; ++row)
+        {
+            double v = erode ? (std::numeric_limits<double>::max)() :
+                std::numeric_limits<double>::lowest();
+            for (int dc = -r; dc <= r; ++dc)
+                for (int dr = -r; dr <= r; ++dr)
+                {
+                    int cc = c + dc;
+                    int rr = row + dr;
+                    if (!inElement(shape, dr, dc, r) || cc < 0 || rr < 0 ||
+                            cc >= cols || rr >= rows)
+                        continue;
+                    double d = data[cc * rows + rr];
+                    v = erode ? (std::min)(v, d) : (std::max)(v, d);
+                }
+            out[c * rows + row] = v;
+        }
+    return out;
+}
+
+void checkShape(Morphology::Shape shape)
+{
+    for (int rows : { 1, 6, 31 })
+        for (int cols : { 1, 9, 20 })
+        {
+            std::vector<double> data(rows * cols);
+            for (size_t i = 0; i < data.size(); ++i)
+                data[i] = (double)((i * 7919) % 113);
+
+            for (int r = 0; r < 10; ++r)
+                for (size_t threads : { 1, 3 })
+                {
+                    std::vector<double> e(data);
+                    Morphology::erode(e, rows, cols, shape, r, threads);
+                    EXPECT_EQ(e, bruteForce(data, rows, cols, shape, r, true))
+                        << rows << "x" << cols << " radius " << r;
+
+                    std::vector<double> d(data);
+                    Morphology::dilate(d, rows, cols, shape, r, threads);
+                    EXPECT_EQ(d, bruteForce(data, rows, cols, shape, r, false))
+                        << rows << "x" << cols << " radius " << r;
+                }
+        }
+}
+
+} // unnamed namespace
+
+TEST(MorphologyTest, diamond)
+{
+    checkShape(Morphology::Shape::Diamond);
+}
+
+TEST(MorphologyTest, square)
+{
+    checkShape(Morphology::Shape::Square);
+}
+
+TEST(MorphologyTest, disk)
+{
+    checkShape(Morphology::Shape::Disk);
+}
+
+TEST(MorphologyTest, threads)
+{
+    // Large enough to be split among threads.
+    const size_t rows = 300;
+    const size_t cols = 400;
+
+    std::vector<double> data(rows * cols);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (double)((i * 104729) % 1009);
+
+    for (auto shape : { Morphology::Shape::Diamond, Morphology::Shape::Square,
+        Morphology::Shape::Disk })
+    {
+        std::vector<double> serial(data);
+        std::vector<double> parallel(data);
+        Morphology::open(serial, rows, cols, shape, 6, 1);
+        Morphology::open(parallel, rows, cols, shape, 6, 4);
+        EXPECT_EQ(serial, parallel);
+
+        Morphology::close(serial, rows, cols, shape, 6, 1);
+        Morphology::close(parallel, rows, cols, shape, 6, 0);
+        EXPECT_EQ(serial, parallel);
+    }
+}
@@ -36,10 +36,15 @@
 
 #include "Support.hpp"
 
+#include <pdal/Filter.hpp>
 #include <pdal/Stage.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/PipelineManager.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <io/FauxReader.hpp>
+#include <filters/SplitterFilter.hpp>
+
+#include <mutex>
 
 using namespace pdal;
 
@@ -198,3 +203,108 @@ TEST(PipelineManagerTest, replace)
     EXPECT_EQ(w2->getInputs().size(), 1U);
     EXPECT_EQ(w2->getInputs().front(), f2);
 }
+
+// Make sure that running views on multiple threads produces the same views,
+// in the same order, as running them one after another.
+TEST(PipelineManagerTest, threads)
+{
+    auto run = [](std::size_t threads)
+    {
+        PipelineManager mgr;
+
+        Stage& r = mgr.makeReader(
+            Support::datapath("las/1.2-with-color.las"), "readers.las");
+
+        Options splitOpts;
+        splitOpts.add("length", 200);
+        Stage& s = mgr.makeFilter("filters.splitter", r, splitOpts);
+
+        Options outlierOpts;
+        outlierOpts.add("mean_k", 4);
+        Stage& o = mgr.makeFilter("filters.outlier", s, outlierOpts);
+        mgr.makeFilter("filters.normal", o);
+
+        mgr.setThreads(threads);
+        mgr.execute();
+
+        std::vector<std::vector<double>> results;
+        for (PointViewPtr v : mgr.views())
+        {
+            std::vector<double> vals;
+            for (PointId i = 0; i < v->size(); ++i)
+            {
+                vals.push_back(v->getFieldAs<double>(Dimension::Id::X, i));
+                vals.push_back(v->getFieldAs<double>(
+                    Dimension::Id::Classification, i));
+                vals.push_back(v->getFieldAs<double>(
+                    Dimension::Id::NormalZ, i));
+            }
+            results.push_back(vals);
+        }
+        return results;
+    };
+
+    auto serial = run(1);
+    auto parallel = run(4);
+    EXPECT_GT(serial.size(), 1U);
+    EXPECT_EQ(serial, parallel);
+}
+
+// Make sure that a stage whose views run concurrently divides its threads
+// among the runs, so that pools started by run() don't multiply the
+// number of threads.
+TEST(PipelineManagerTest, nestedThreads)
+{
+    class Counter : public Filter
+    {
+    public:
+        std::string getName() const
+            { return "counter"; }
+        std::size_t threadCount() const
+            { return numThreads(); }
+
+        std::vector<std::size_t> m_counts;
+
+    private:
+        std::mutex m_mutex;
+
+        bool parallelRunnable() const
+            { return true; }
+        void filter(PointView&)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_counts.push_back(numThreads());
+        }
+    };
+
+    // The ramp runs along the diagonal, so tiles of 50 make two views and
+    // tiles of 25 make four.
+    for (double length : { 50.0, 25.0 })
+    {
+        Options ro;
+        ro.add("bounds", BOX3D(0, 0, 0, 99, 99, 99));
+        ro.add("mode", "ramp");
+        ro.add("count", 100);
+        FauxReader r;
+        r.setOptions(ro);
+
+        Options so;
+        so.add("length", length);
+        SplitterFilter s;
+        s.setOptions(so);
+        s.setInput(r);
+
+        Counter c;
+        c.setInput(s);
+        c.setThreads(4);
+
+        PointTable t;
+        c.prepare(t);
+        PointViewSet views = c.execute(t);
+        ASSERT_GT(views.size(), 1U);
+        ASSERT_EQ(c.m_counts.size(), views.size());
+        for (std::size_t count : c.m_counts)
+            EXPECT_EQ(count, 4 / views.size());
+        EXPECT_EQ(c.threadCount(), 4U);
+    }
+}
@@ -34,6 +34,9 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <atomic>
+#include <thread>
+
 #include <pdal/PointTable.hpp>
 #include <io/LasReader.hpp>
 #include "Support.hpp"
@@ -179,6 +182,143 @@ TEST(PointTable, userView)
     EXPECT_TRUE(called);
 }
 
+TEST(PointTable, columns)
+{
+    using namespace Dimension;
+
+    LasReader reader;
+
+    Options opts;
+    opts.add("filename", Support::datapath("las/simple.las"));
+    reader.setOptions(opts);
+
+    PointTable rowTable;
+    reader.prepare(rowTable);
+    PointViewPtr rowView = *reader.execute(rowTable).begin();
+
+    ColumnPointTable table;
+    EXPECT_FALSE(table.supportsConcurrentAdd());
+    reader.prepare(table);
+    PointViewPtr view = *reader.execute(table).begin();
+
+    ASSERT_EQ(view->size(), rowView->size());
+    EXPECT_EQ(table.numPoints(), view->size());
+
+    double *x = view->column<double>(Id::X);
+    uint16_t *intensity = view->column<uint16_t>(Id::Intensity);
+    ASSERT_TRUE(x);
+    ASSERT_TRUE(intensity);
+    EXPECT_EQ(x, (double *)table.column(Id::X));
+    for (PointId idx = 0; idx < view->size(); ++idx)
+    {
+        EXPECT_EQ(x[idx], rowView->getFieldAs<double>(Id::X, idx));
+        EXPECT_EQ(intensity[idx],
+            rowView->getFieldAs<uint16_t>(Id::Intensity, idx));
+        EXPECT_EQ(view->getFieldAs<double>(Id::Y, idx),
+            rowView->getFieldAs<double>(Id::Y, idx));
+    }
+
+    // Wrong type or a dimension not in the layout.
+    EXPECT_FALSE(view->column<float>(Id::X));
+    EXPECT_FALSE(view->column<double>(Id::NormalX));
+
+    // Points that aren't consecutive in the table.
+    PointViewPtr odd = view->makeNew();
+    for (PointId idx = 1; idx < view->size(); idx += 2)
+        odd->appendPoint(*view, idx);
+    EXPECT_FALSE(odd->column<double>(Id::X));
+
+    // Consecutive points that don't start at the beginning of the table.
+    PointViewPtr tail = view->makeNew();
+    for (PointId idx = 10; idx < view->size(); ++idx)
+        tail->appendPoint(*view, idx);
+    EXPECT_EQ(tail->column<double>(Id::X), x + 10);
+
+    // Row-oriented tables don't provide columns.
+    EXPECT_FALSE(rowView->column<double>(Id::X));
+    EXPECT_FALSE(view->supportsPointAccess());
+    EXPECT_THROW(view->getPoint(0), pdal_error);
+
+    // A failed attempt to add a point leaves the view unchanged.
+    point_count_t size = view->size();
+    EXPECT_THROW(view->getOrAddPoint(size), pdal_error);
+    EXPECT_EQ(view->size(), size);
+    EXPECT_EQ(table.numPoints(), size);
+}
+
+TEST(PointTable, columnGrowth)
+{
+    using namespace Dimension;
+
+    ColumnPointTable table;
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Classification);
+    table.finalize();
+
+    PointView view(table);
+    const point_count_t count = 200000;
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        view.setField(Id::X, idx, idx * 2.5);
+        if (idx % 3 == 0)
+            view.setField(Id::Classification, idx, (uint8_t)(idx % 32));
+    }
+
+    double *x = view.column<double>(Id::X);
+    uint8_t *c = view.column<uint8_t>(Id::Classification);
+    ASSERT_TRUE(x);
+    ASSERT_TRUE(c);
+    EXPECT_EQ((std::uintptr_t)x % 64, 0u);
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        EXPECT_EQ(x[idx], idx * 2.5);
+        EXPECT_EQ(c[idx], idx % 3 == 0 ? idx % 32 : 0u);
+    }
+}
+
+// Views of a table add points from separate threads while reading the
+// points they added earlier.
+TEST(PointTable, concurrentAdd)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDim(Id::X);
+    table.finalize();
+    EXPECT_TRUE(table.supportsConcurrentAdd());
+
+    const point_count_t count = 300000;
+    std::vector<PointViewPtr> views;
+    std::vector<std::thread> threads;
+    std::atomic<int> bad(0);
+    for (int t = 0; t < 4; ++t)
+    {
+        PointViewPtr view(new PointView(table));
+        views.push_back(view);
+        threads.push_back(std::thread([view, t, count, &bad]()
+        {
+            for (PointId idx = 0; idx < count; ++idx)
+            {
+                view->setField(Id::X, idx, t * count + idx);
+                PointId check = idx / 2;
+                if (view->getFieldAs<double>(Id::X, check) != t * count + check)
+                    bad++;
+            }
+        }));
+    }
+    for (auto& t : threads)
+        t.join();
+
+    EXPECT_EQ(bad, 0);
+    for (int t = 0; t < 4; ++t)
+    {
+        ASSERT_EQ(views[t]->size(), count);
+        for (PointId idx = 0; idx < count; ++idx)
+            ASSERT_EQ(views[t]->getFieldAs<double>(Id::X, idx),
+                t * count + idx);
+    }
+}
+
 TEST(PointTable, srs)
 {
    SpatialReference srs1("GEOGCS[\"WGS 84\",DATUM[\"WGS_1984\",SPHEROID[\"WGS 84\",6378137,298.257223563,AUTHORITY[\"EPSG\",\"7030\"]],AUTHORITY[\"EPSG\",\"6326\"]],PRIMEM[\"Greenwich\",0,AUTHORITY[\"EPSG\",\"8901\"]],UNIT[\"degree\",0.0174532925199433,AUTHORITY[\"EPSG\",\"9122\"]],AUTHORITY[\"EPSG\",\"4326\"]]");
@@ -35,8 +35,10 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <array>
+#include <cstring>
 #include <random>
 
+#include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/PointViewIter.hpp>
 #include <pdal/PDALUtils.hpp>
@@ -343,6 +345,136 @@ TEST(PointViewTest, issue1264)
     EXPECT_THROW(v.setField(foo, 0, d), pdal_error);
 }
 
+TEST(PointViewTest, neighborCache)
+{
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+    layout->registerDim(Dimension::Id::Intensity);
+    layout->finalize();
+
+    PointView view(table);
+    for (PointId i = 0; i < 100; ++i)
+    {
+        view.setField(Dimension::Id::X, i, (double)i);
+        view.setField(Dimension::Id::Y, i, 0.0);
+        view.setField(Dimension::Id::Z, i, 0.0);
+    }
+
+    NeighborTablePtr knn4 = view.knnTable(4);
+    EXPECT_EQ(knn4, view.knnTable(4));
+    EXPECT_EQ(view.knnTable(4, 2)->neighbors(0),
+        std::vector<PointId>({ 0, 1, 2, 3 }));
+
+    // A table with fewer neighbors comes from the table with more, which
+    // stays cached.
+    NeighborTablePtr knn2 = view.knnTable(2);
+    EXPECT_EQ(knn2->count(50), 2u);
+    EXPECT_EQ(knn2->ids(50)[0], knn4->ids(50)[0]);
+    EXPECT_EQ(knn2->ids(50)[1], knn4->ids(50)[1]);
+    EXPECT_EQ(knn4, view.knnTable(4));
+
+    // Only the table for the largest k and the last radius are kept.
+    NeighborTablePtr knn6 = view.knnTable(6);
+    EXPECT_NE(knn4, view.knnTable(4));
+    EXPECT_EQ(knn6, view.knnTable(6));
+    knn4.reset();
+    knn2.reset();
+
+    NeighborTablePtr rad = view.radiusTable(1.5);
+    EXPECT_EQ(rad, view.radiusTable(1.5));
+    EXPECT_EQ(rad->count(0), 2u);
+    EXPECT_EQ(rad->count(50), 3u);
+    EXPECT_EQ(view.radiusTable(2.5)->count(50), 5u);
+    EXPECT_NE(rad, view.radiusTable(1.5));
+
+    // Changing other dimensions doesn't invalidate the tables.
+    rad = view.radiusTable(1.5);
+    view.setField(Dimension::Id::Intensity, 0, 5);
+    EXPECT_EQ(rad, view.radiusTable(1.5));
+
+    // Moving a point does, though tables held by callers remain valid.
+    KD3Index& index = view.build3dIndex();
+    view.setField(Dimension::Id::X, 0, 50.5);
+    EXPECT_EQ(view.radiusTable(1.5)->count(50), 4u);
+    EXPECT_EQ(rad->count(50), 3u);
+    EXPECT_EQ(&index, &view.build3dIndex());
+    EXPECT_EQ(index.neighbor(50.4, 0, 0), 0u);
+
+    // As does adding one.
+    view.setField(Dimension::Id::X, 100, 50.6);
+    EXPECT_EQ(view.radiusTable(1.5)->count(50), 5u);
+    EXPECT_EQ(view.knnTable(4)->size(), 101u);
+}
+
+// Moving points through another view of the table invalidates the
+// neighbors cached by a view.
+TEST(PointViewTest, neighborCacheTable)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+    table.finalize();
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 10; ++i)
+    {
+        view->setField(Id::X, i, (double)i);
+        view->setField(Id::Y, i, 0.0);
+        view->setField(Id::Z, i, 0.0);
+    }
+    PointViewPtr sibling = view->makeNew();
+    sibling->append(*view);
+
+    // Appending to or reordering another view keeps the tables.
+    NeighborTablePtr rad = view->radiusTable(1.5);
+    EXPECT_EQ(rad->count(5), 3u);
+    sibling->appendPoint(*view, 0);
+    EXPECT_EQ(rad, view->radiusTable(1.5));
+
+    sibling->setField(Id::X, 5, 100.0);
+    EXPECT_EQ(view->radiusTable(1.5)->count(5), 1u);
+
+    rad = view->radiusTable(1.5);
+    double x = 5.0;
+    std::memcpy(sibling->getPoint(5) +
+        table.layout()->dimOffset(Id::X), &x, sizeof(x));
+    EXPECT_EQ(view->radiusTable(1.5)->count(5), 3u);
+}
+
+TEST(PointViewTest, neighborCacheColumn)
+{
+    using namespace Dimension;
+
+    ColumnPointTable table;
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+    table.finalize();
+
+    PointView view(table);
+    for (PointId i = 0; i < 10; ++i)
+    {
+        view.setField(Id::X, i, (double)i);
+        view.setField(Id::Y, i, 0.0);
+        view.setField(Id::Z, i, 0.0);
+    }
+    NeighborTablePtr rad = view.radiusTable(1.5);
+    EXPECT_EQ(rad->count(5), 3u);
+
+    // Reading a column keeps the tables.
+    const PointView& constView(view);
+    ASSERT_TRUE(constView.column<double>(Id::X));
+    EXPECT_EQ(rad, view.radiusTable(1.5));
+
+    // A writable column of positions discards them.
+    double *x = view.column<double>(Id::X);
+    ASSERT_TRUE(x);
+    x[5] = 100;
+    EXPECT_EQ(view.radiusTable(1.5)->count(5), 1u);
+}
+
 // Per discussions with @abellgithub (https://github.com/gadomski/PDAL/commit/c1d54e56e2de841d37f2a1b1c218ed723053f6a9#commitcomment-14415138)
 // we only do bounds checking on `PointView`s when in debug mode.
 #ifndef NDEBUG
@@ -94,3 +94,80 @@ TEST(SegmentationTest, BasicClustering)
     EXPECT_EQ(1u, clusters.size());
     EXPECT_EQ(1u, clusters[0].size());
 }
+
+TEST(SegmentationTest, ClusteringThreads)
+{
+    using namespace Segmentation;
+
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    PointViewPtr src(new PointView(table));
+
+    // A chain of points just under the tolerance apart, spanning many
+    // grid cells, followed by a chain just over the tolerance apart.
+    PointId id = 0;
+    for (int i = 0; i < 100; ++i, ++id)
+    {
+        src->setField(Dimension::Id::X, id, i * 0.99);
+        src->setField(Dimension::Id::Y, id, i * 0.01);
+        src->setField(Dimension::Id::Z, id, 0.0);
+    }
+    for (int i = 0; i < 100; ++i, ++id)
+    {
+        src->setField(Dimension::Id::X, id, 0.0);
+        src->setField(Dimension::Id::Y, id, 10.0);
+        src->setField(Dimension::Id::Z, id, i * 1.01);
+    }
+
+    // A dense block of points, all connected.
+    for (int i = 0; i < 20; ++i)
+        for (int j = 0; j < 20; ++j)
+            for (int k = 0; k < 20; ++k, ++id)
+            {
+                src->setField(Dimension::Id::X, id, 200 + i * 0.25);
+                src->setField(Dimension::Id::Y, id, 200 + j * 0.25);
+                src->setField(Dimension::Id::Z, id, 200 + k * 0.25);
+            }
+
+    // Two lattices of 50,000 points, each point about a cell apart, so
+    // that the cells are split among many blocks that are connected and
+    // merged concurrently.
+    for (int i = 0; i < 50; ++i)
+        for (int j = 0; j < 50; ++j)
+            for (int k = 0; k < 40; ++k, ++id)
+            {
+                double gap = (i < 25) ? 0.0 : 1.5;
+                src->setField(Dimension::Id::X, id, 400 + i * 0.6 + gap);
+                src->setField(Dimension::Id::Y, id, 400 + j * 0.6);
+                src->setField(Dimension::Id::Z, id, 400 + k * 0.6);
+            }
+
+    std::vector<std::vector<PointId>> clusters =
+        extractClusters(*src, 1, 100000, 1.0);
+    ASSERT_EQ(104u, clusters.size());
+    EXPECT_EQ(100u, clusters[0].size());
+    for (PointId i = 0; i < 100; ++i)
+        EXPECT_EQ(i, clusters[0][i]);
+    for (size_t i = 1; i < 101; ++i)
+    {
+        ASSERT_EQ(1u, clusters[i].size());
+        EXPECT_EQ(99 + i, clusters[i][0]);
+    }
+    EXPECT_EQ(8000u, clusters[101].size());
+    EXPECT_EQ(50000u, clusters[102].size());
+    EXPECT_EQ(8200u, clusters[102][0]);
+    EXPECT_EQ(50000u, clusters[103].size());
+    EXPECT_EQ(58200u, clusters[103][0]);
+
+    for (size_t threads : { 0, 2, 4 })
+        EXPECT_EQ(clusters, extractClusters(*src, 1, 100000, 1.0, threads));
+
+    // No point is closer than a zero tolerance.
+    clusters = extractClusters(*src, 1, 100000, 0.0);
+    EXPECT_EQ(src->size(), clusters.size());
+}
@@ -37,7 +37,10 @@
 #include <pdal/Filter.hpp>
 #include <pdal/PointTable.hpp>
 #include <io/FauxReader.hpp>
+#include <filters/AssignFilter.hpp>
 #include <filters/MergeFilter.hpp>
+#include <filters/RangeFilter.hpp>
+#include <filters/TransformationFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
@@ -106,3 +109,187 @@ TEST(Streaming, filter)
     f.execute(t);
     EXPECT_EQ(cnt, 400);
 }
+
+// Make sure that running groups of stages on separate threads processes
+// every point, in order, exactly once.
+TEST(Streaming, threaded)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options rangeOps;
+    rangeOps.add("limits", "X[0:499]");
+    RangeFilter range;
+    range.setOptions(rangeOps);
+    range.setInput(r);
+
+    StreamCallbackFilter f;
+    int cnt = 0;
+    auto cb = [&cnt](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), cnt);
+        cnt++;
+        return true;
+    };
+    f.setCallback(cb);
+    f.setInput(range);
+
+    for (std::size_t threads : { 2, 3, 8 })
+    {
+        cnt = 0;
+        r.setThreads(threads);
+        range.setThreads(threads);
+        f.setThreads(threads);
+
+        // A capacity that doesn't divide the point count makes for a
+        // partial last chunk.
+        FixedPointTable t(7);
+        f.prepare(t);
+        f.execute(t);
+        EXPECT_EQ(cnt, 500);
+    }
+}
+
+namespace
+{
+
+// Table that consumes points when it's reset, as tables that hand points
+// to a caller do.
+class ConsumingTable : public FixedPointTable
+{
+public:
+    ConsumingTable(point_count_t capacity) : FixedPointTable(capacity)
+    {}
+
+    std::vector<int> m_xs;
+
+    virtual void reset()
+    {
+        for (PointId idx = 0; idx < capacity(); ++idx)
+        {
+            PointRef point(*this, idx);
+            m_xs.push_back(point.getFieldAs<int>(Dimension::Id::X));
+        }
+        FixedPointTable::reset();
+    }
+};
+
+} // unnamed namespace
+
+// The caller's table must be reset once for each chunk, in order and with
+// the chunk's points, whether or not stages run on separate threads.
+TEST(Streaming, threadedReset)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options xformOps;
+    xformOps.add("matrix", "1 0 0 1  0 1 0 0  0 0 1 0  0 0 0 1");
+    TransformationFilter xform;
+    xform.setOptions(xformOps);
+    xform.setInput(r);
+
+    std::vector<int> serial;
+    for (std::size_t threads : { 1, 2, 3 })
+    {
+        r.setThreads(threads);
+        xform.setThreads(threads);
+
+        ConsumingTable t(7);
+        xform.prepare(t);
+        xform.execute(t);
+        ASSERT_GE(t.m_xs.size(), 1000u);
+        for (int i = 0; i < 1000; ++i)
+            EXPECT_EQ(t.m_xs[i], i + 1);
+        if (threads == 1)
+            serial = t.m_xs;
+        else
+            EXPECT_EQ(t.m_xs, serial);
+    }
+}
+
+TEST(Streaming, skipMask)
+{
+    SkipMask skips(130);
+    EXPECT_EQ(skips.size(), 130u);
+    for (PointId idx = 0; idx < 130; idx++)
+        EXPECT_FALSE(skips.skipped(idx));
+
+    skips.skip(0);
+    skips.skip(63);
+    skips.skip(64);
+    skips.skip(129);
+    for (PointId idx = 0; idx < 130; idx++)
+        EXPECT_EQ(skips.skipped(idx),
+            idx == 0 || idx == 63 || idx == 64 || idx == 129);
+
+    skips.reset();
+    for (PointId idx = 0; idx < 130; idx++)
+        EXPECT_FALSE(skips.skipped(idx));
+}
+
+// Run filters that process points in batches and make sure points that
+// are filtered out aren't touched by later stages.
+TEST(Streaming, batch)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options rangeOps;
+    rangeOps.add("limits", "X[0:99]");
+    rangeOps.add("limits", "Y[0:249]");
+    rangeOps.add("limits", "X[200:299]");
+    RangeFilter range;
+    range.setOptions(rangeOps);
+    range.setInput(r);
+
+    Options assignOps;
+    assignOps.add("assignment", "Z[:]=5");
+    AssignFilter assign;
+    assign.setOptions(assignOps);
+    assign.setInput(range);
+
+    Options xformOps;
+    xformOps.add("matrix", "1 0 0 1000  0 1 0 0  0 0 1 0  0 0 0 1");
+    TransformationFilter xform;
+    xform.setOptions(xformOps);
+    xform.setInput(assign);
+
+    StreamCallbackFilter f;
+    std::vector<int> xs;
+    auto cb = [&xs](PointRef& point)
+    {
+        int x = point.getFieldAs<int>(Dimension::Id::X);
+        EXPECT_EQ(x - 1000, point.getFieldAs<int>(Dimension::Id::Y));
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::Z), 5);
+        xs.push_back(x);
+        return true;
+    };
+    f.setCallback(cb);
+    f.setInput(xform);
+
+    for (point_count_t capacity : { 7, 64, 1000 })
+    {
+        xs.clear();
+        FixedPointTable t(capacity);
+        f.prepare(t);
+        f.execute(t);
+        ASSERT_EQ(xs.size(), 150u);
+        for (int i = 0; i < 100; ++i)
+            EXPECT_EQ(xs[i], i + 1000);
+        for (int i = 100; i < 150; ++i)
+            EXPECT_EQ(xs[i], i + 1100);
+    }
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+#include <pdal/util/ThreadPool.hpp>
+
+using namespace pdal;
+
+TEST(ThreadPoolTest, run)
+{
+    std::atomic<int> sum(0);
+
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.numThreads(), 4u);
+    for (int i = 1; i <= 1000; ++i)
+        pool.add([&sum, i](){ sum += i; });
+    pool.await();
+    EXPECT_EQ(sum, 500500);
+
+    // The pool is still usable after await().
+    pool.add([&sum](){ sum = 0; });
+    pool.join();
+    EXPECT_EQ(sum, 0);
+
+    // Adding to a joined pool restarts it.
+    pool.add([&sum](){ sum = 10; });
+    pool.await();
+    EXPECT_EQ(sum, 10);
+}
+
+TEST(ThreadPoolTest, bounded)
+{
+    std::atomic<int> count(0);
+
+    ThreadPool pool(2, 1);
+    for (int i = 0; i < 100; ++i)
+        pool.add([&count](){ count++; });
+    pool.join();
+    EXPECT_EQ(count, 100);
+}
+
+TEST(ThreadPoolTest, error)
+{
+    std::atomic<int> count(0);
+
+    ThreadPool pool(3);
+    for (int i = 0; i < 10; ++i)
+        pool.add([&count, i]()
+        {
+            if (i == 5)
+                throw std::runtime_error("Task failed");
+            count++;
+        });
+    EXPECT_THROW(pool.await(), std::runtime_error);
+    EXPECT_EQ(count, 9);
+
+    // The error is cleared once it has been reported.
+    pool.add([&count](){ count++; });
+    EXPECT_NO_THROW(pool.await());
+    EXPECT_EQ(count, 10);
+}
@@ -36,6 +36,7 @@
 
 #include <sstream>
 
+#include <pdal/util/RadixSort.hpp>
 #include <pdal/util/Utils.hpp>
 
 #include <vector>
@@ -431,3 +432,43 @@ TEST(UtilsTest, naninf)
     d = -d;
     EXPECT_EQ(Utils::toString(d), "-Infinity");
 }
+
+TEST(UtilsTest, radixSort)
+{
+    std::vector<double> special { 0.0, -0.0, 1.0, -1.0, 1e-300, -1e-300,
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::lowest(),
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity() };
+
+    Utils::random_seed(17);
+    for (size_t count : { 0, 1, 1000, 300000 })
+    {
+        // Pairs of a value and its original position, to check stability.
+        std::vector<std::pair<double, size_t>> items;
+        for (size_t i = 0; i < count; ++i)
+        {
+            double d = (i < special.size()) ? special[i] :
+                std::round(Utils::random(-1000.0, 1000.0));
+            items.push_back(std::make_pair(d, i));
+        }
+
+        auto expected(items);
+        std::stable_sort(expected.begin(), expected.end(),
+            [](const std::pair<double, size_t>& a,
+                const std::pair<double, size_t>& b)
+            { return a.first < b.first; });
+
+        for (size_t threads : { 1, 4 })
+        {
+            auto sorted(items);
+            Utils::radixSort(sorted, [](const std::pair<double, size_t>& p)
+                { return Utils::radixKey(p.first); }, threads);
+            EXPECT_EQ(sorted, expected);
+        }
+    }
+
+    std::vector<int16_t> ints { 5, -3, 0, -32768, 32767, -1, 1 };
+    Utils::radixSort(ints, [](int16_t i){ return Utils::radixKey(i); });
+    EXPECT_TRUE(std::is_sorted(ints.begin(), ints.end()));
+}
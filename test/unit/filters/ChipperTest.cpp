@@ -39,6 +39,7 @@
 #include <filters/ChipperFilter.hpp>
 #include <io/LasWriter.hpp>
 #include <io/LasReader.hpp>
+#include <pdal/util/Utils.hpp>
 
 #include "Support.hpp"
 
@@ -120,6 +121,58 @@ TEST(ChipperTest, empty_buffer)
     EXPECT_EQ(viewSet.size(), 0u);
 }
 
+// Make sure that chipping on several threads gives the same chips.
+TEST(ChipperTest, threads)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+    table.finalize();
+
+    PointViewPtr view(new PointView(table));
+    Utils::random_seed(17);
+    for (PointId i = 0; i < 200000; ++i)
+    {
+        // Round positions so that there are many duplicate values.
+        view->setField(Dimension::Id::X, i,
+            std::round(Utils::random(0.0, 1000.0)));
+        view->setField(Dimension::Id::Y, i,
+            std::round(Utils::random(-500.0, 500.0) * 10) / 10);
+        view->setField(Dimension::Id::Z, i, (double)i);
+    }
+
+    auto chip = [&table, &view](int threads)
+    {
+        Options ops;
+        ops.add("capacity", 1000);
+        ops.add("threads", threads);
+
+        ChipperFilter chipper;
+        chipper.setOptions(ops);
+        chipper.prepare(table);
+        StageWrapper::ready(chipper, table);
+        PointViewSet viewSet = StageWrapper::run(chipper, view);
+        StageWrapper::done(chipper, table);
+
+        std::vector<std::vector<double>> chips;
+        for (auto& v : viewSet)
+        {
+            std::vector<double> ids;
+            for (PointId i = 0; i < v->size(); ++i)
+                ids.push_back(v->getFieldAs<double>(Dimension::Id::Z, i));
+            chips.push_back(ids);
+        }
+        return chips;
+    };
+
+    std::vector<std::vector<double>> chips = chip(1);
+    EXPECT_EQ(chips.size(), 200u);
+    for (auto& c : chips)
+        EXPECT_EQ(c.size(), 1000u);
+    EXPECT_EQ(chips, chip(4));
+}
+
 //ABELL
 /**
 TEST(ChipperTest, test_ordering)
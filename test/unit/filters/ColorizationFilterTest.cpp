@@ -34,10 +34,13 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <cmath>
+
 #include <pdal/PointView.hpp>
 #include <io/LasReader.hpp>
 #include <filters/ColorizationFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
+#include <pdal/GDALUtils.hpp>
 
 #include "Support.hpp"
 
@@ -124,6 +127,34 @@ void testFileStreamed(const Options& filterOps, StringList dimNames,
     f2.execute(table);
 }
 
+// Read the value of each band at a position with GDAL, one pixel at a
+// time and without the raster block cache.
+bool uncachedRead(GDALDatasetH ds, double x, double y,
+    std::vector<double>& data)
+{
+    double xform[6];
+    double inverse[6];
+    if (GDALGetGeoTransform(ds, xform) != CE_None ||
+        !GDALInvGeoTransform(xform, inverse))
+        return false;
+
+    int pixel = (int)std::floor(inverse[0] + inverse[1] * x + inverse[2] * y);
+    int line = (int)std::floor(inverse[3] + inverse[4] * x + inverse[5] * y);
+    if (pixel < 0 || pixel >= GDALGetRasterXSize(ds) ||
+        line < 0 || line >= GDALGetRasterYSize(ds))
+        return false;
+
+    data.resize(GDALGetRasterCount(ds));
+    for (int i = 0; i < GDALGetRasterCount(ds); ++i)
+    {
+        GDALRasterBandH b = GDALGetRasterBand(ds, i + 1);
+        if (GDALRasterIO(b, GF_Read, pixel, line, 1, 1, &data[i], 1, 1,
+            GDT_Float64, 0, 0) != CE_None)
+            return false;
+    }
+    return true;
+}
+
 } // unnamed namespace
 
 // Test using the standard dimensions.
@@ -187,4 +218,90 @@ TEST(ColorizationFilterTest, test4)
     EXPECT_THROW(testFile(options, dims, 210, 205, 47175), pdal_error);
 }
 
+// Check that bands can be assigned in any order.
+TEST(ColorizationFilterTest, bandOrder)
+{
+    Options options;
+
+    options.add("dimensions", "Blue:3:255,Red:1,Green:2");
+    options.add("raster", Support::datapath("autzen/autzen.jpg"));
+
+    StringList dims;
+    dims.push_back("Red");
+    dims.push_back("Green");
+    dims.push_back("Blue");
+    testFile(options, dims, 210, 205, 47175);
+    testFileStreamed(options, dims, 210, 205, 47175);
 
+    Options badOptions;
+    badOptions.add("dimensions", "Red:4");
+    badOptions.add("raster", Support::datapath("autzen/autzen.jpg"));
+    EXPECT_THROW(testFile(badOptions, dims, 210, 205, 47175), pdal_error);
+}
+
+// Check that cached and bulk raster reads match regardless of cache size,
+// and that they match values read without the cache.
+TEST(ColorizationFilterTest, blockCache)
+{
+    gdal::registerDrivers();
+
+    gdal::Raster raster(Support::datapath("autzen/autzen.jpg"));
+    ASSERT_EQ(raster.open(), gdal::GDALError::None);
+
+    std::array<double, 2> origin;
+    std::array<double, 2> corner;
+    raster.pixelToCoord(0, 0, origin);
+    raster.pixelToCoord(raster.width() - 1, raster.height() - 1, corner);
+
+    // Sample a grid of positions, some outside the raster.
+    std::vector<double> xs;
+    std::vector<double> ys;
+    for (int i = -2; i < 50; ++i)
+        for (int j = -2; j < 50; ++j)
+        {
+            xs.push_back(origin[0] + (corner[0] - origin[0]) * i / 47.0);
+            ys.push_back(origin[1] + (corner[1] - origin[1]) * j / 47.0);
+        }
+
+    std::vector<double> expected;
+    std::vector<bool> expectedValid;
+    EXPECT_EQ(raster.read(xs, ys, expected, expectedValid),
+        gdal::GDALError::None);
+
+    std::vector<double> data;
+    std::vector<bool> valid;
+    raster.setBlockCacheSize(1);
+    EXPECT_EQ(raster.read(xs, ys, data, valid), gdal::GDALError::None);
+    EXPECT_EQ(valid, expectedValid);
+    EXPECT_EQ(data.size(), expected.size());
+
+    GDALDatasetH ds = GDALOpen(Support::datapath("autzen/autzen.jpg").c_str(),
+        GA_ReadOnly);
+    ASSERT_TRUE(ds != nullptr);
+
+    const size_t numBands = raster.bandCount();
+    size_t numValid = 0;
+    std::vector<double> point;
+    std::vector<double> uncached;
+    for (size_t i = 0; i < xs.size(); ++i)
+    {
+        gdal::GDALError error = raster.read(xs[i], ys[i], point);
+        bool uncachedValid = uncachedRead(ds, xs[i], ys[i], uncached);
+        EXPECT_EQ(valid[i], uncachedValid);
+        if (!valid[i])
+        {
+            EXPECT_EQ(error, gdal::GDALError::NoData);
+            continue;
+        }
+        numValid++;
+        EXPECT_EQ(error, gdal::GDALError::None);
+        for (size_t b = 0; b < numBands; ++b)
+        {
+            EXPECT_EQ(point[b], uncached[b]);
+            EXPECT_EQ(data[i * numBands + b], uncached[b]);
+            EXPECT_EQ(expected[i * numBands + b], uncached[b]);
+        }
+    }
+    EXPECT_EQ(numValid, 48u * 48u);
+    GDALClose(ds);
+}
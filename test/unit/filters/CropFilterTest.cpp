@@ -461,3 +461,77 @@ TEST(CropFilterTest, sphere)
     }
 }
 
+TEST(CropFilterTest, polygons)
+{
+    auto square = [](double x, double y, double size)
+    {
+        std::ostringstream oss;
+        oss << "((" << x << " " << y << ", " << x + size << " " << y <<
+            ", " << x + size << " " << y + size << ", " << x << " " <<
+            y + size << ", " << x << " " << y << "))";
+        return oss.str();
+    };
+
+    // Each polygon contains 9 x 9 points of the grid.  The multipolygon
+    // contains 2 x 2 points in each of its parts.
+    std::string multi = "MULTIPOLYGON (" + square(0.5, 0.5, 2) + ", " +
+        square(50.5, 50.5, 2) + ")";
+    auto crop = [&](size_t threads, bool outside)
+    {
+        Options opts;
+        opts.add("bounds", BOX3D(0.0, 0.0, 0.0, 100.0, 100.0, 0.0));
+        opts.add("mode", "grid");
+        FauxReader reader;
+        reader.setOptions(opts);
+
+        Options cropOpts;
+        for (int i = 0; i < 10; ++i)
+            for (int j = 0; j < 10; ++j)
+                cropOpts.add("polygon",
+                    "POLYGON " + square(i * 10 + 0.5, j * 10 + 0.5, 9));
+        cropOpts.add("polygon", multi);
+        cropOpts.add("threads", threads);
+        cropOpts.add("outside", outside);
+
+        CropFilter filter;
+        filter.setOptions(cropOpts);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet s = filter.execute(table);
+        return std::vector<PointViewPtr>(s.begin(), s.end());
+    };
+
+    std::vector<PointViewPtr> views = crop(1, false);
+    ASSERT_EQ(views.size(), 101u);
+    for (size_t i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(views[i]->size(), 81u);
+        BOX2D bounds;
+        views[i]->calculateBounds(bounds);
+        EXPECT_EQ(bounds.minx, (double)((i / 10) * 10 + 1));
+        EXPECT_EQ(bounds.miny, (double)((i % 10) * 10 + 1));
+    }
+    EXPECT_EQ(views[100]->size(), 8u);
+
+    // Threading doesn't change the points or their order.
+    std::vector<PointViewPtr> threaded = crop(4, false);
+    ASSERT_EQ(threaded.size(), 101u);
+    for (size_t i = 0; i < views.size(); ++i)
+    {
+        ASSERT_EQ(views[i]->size(), threaded[i]->size());
+        for (PointId idx = 0; idx < views[i]->size(); ++idx)
+        {
+            EXPECT_EQ(views[i]->getFieldAs<double>(Dimension::Id::X, idx),
+                threaded[i]->getFieldAs<double>(Dimension::Id::X, idx));
+            EXPECT_EQ(views[i]->getFieldAs<double>(Dimension::Id::Y, idx),
+                threaded[i]->getFieldAs<double>(Dimension::Id::Y, idx));
+        }
+    }
+
+    views = crop(4, true);
+    ASSERT_EQ(views.size(), 101u);
+    EXPECT_EQ(views[0]->size(), 10000u - 81u);
+    EXPECT_EQ(views[100]->size(), 10000u - 8u);
+}
@@ -0,0 +1,260 @@
+/******************************************************************************
+* Copyright (c) 2017, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <io/BufferReader.hpp>
+#include <filters/PMFFilter.hpp>
+#include <filters/SMRFilter.hpp>
+#include <filters/private/GroundTiles.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace pdal;
+
+namespace
+{
+
+// Make a dense cloud over a slope with a few boxes standing on it.  Points
+// inside the hole, if any, are left out.
+PointViewPtr makeCloud(PointTableRef table, double size,
+    BOX2D hole = BOX2D())
+{
+    using namespace Dimension;
+
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z, Id::Classification});
+
+    PointViewPtr view(new PointView(table));
+    PointId id = 0;
+    for (double x = 0; x < size; x += 0.5)
+        for (double y = 0; y < size; y += 0.5)
+        {
+            if (hole.contains(x, y))
+                continue;
+            double z = 0.05 * x + 2 * std::sin(y / 10);
+            if (std::fmod(x, 25) > 15 && std::fmod(y, 20) > 12)
+                z += 8;
+            view->setField(Id::X, id, x);
+            view->setField(Id::Y, id, y);
+            view->setField(Id::Z, id, z);
+            view->setField(Id::Classification, id, 0);
+            id++;
+        }
+    return view;
+}
+
+// Make a classifier that marks points as ground when they're no higher
+// than the lowest point in the cells within 'reach' cells of their own.
+GroundClassifier lowestClassifier(int reach, std::atomic<int>& tiles)
+{
+    return [reach, &tiles](PointViewPtr view, const GroundGrid& grid)
+    {
+        using namespace Dimension;
+
+        if (grid.m_tile)
+            tiles++;
+        std::vector<double> low(grid.m_cols * grid.m_rows,
+            (std::numeric_limits<double>::max)());
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            int c = grid.col(view->getFieldAs<double>(Id::X, i));
+            int r = grid.row(view->getFieldAs<double>(Id::Y, i));
+            double& l = low[c * grid.m_rows + r];
+            l = (std::min)(l, view->getFieldAs<double>(Id::Z, i));
+        }
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            int c = grid.col(view->getFieldAs<double>(Id::X, i));
+            int r = grid.row(view->getFieldAs<double>(Id::Y, i));
+            double l = (std::numeric_limits<double>::max)();
+            for (int cc = (std::max)(0, c - reach);
+                    cc <= (std::min)(grid.m_cols - 1, c + reach); ++cc)
+                for (int rr = (std::max)(0, r - reach);
+                        rr <= (std::min)(grid.m_rows - 1, r + reach); ++rr)
+                    l = (std::min)(l, low[cc * grid.m_rows + rr]);
+            bool ground = view->getFieldAs<double>(Id::Z, i) <= l + 0.5;
+            view->setField(Id::Classification, i, ground ? 2 : 1);
+        }
+    };
+}
+
+std::vector<uint8_t> classes(PointViewPtr view)
+{
+    std::vector<uint8_t> out;
+    for (PointId i = 0; i < view->size(); ++i)
+        out.push_back(
+            view->getFieldAs<uint8_t>(Dimension::Id::Classification, i));
+    return out;
+}
+
+// Classify a cloud with a filter and return the classes in point order.
+std::vector<uint8_t> runFilter(Stage& filter, Options opts,
+    double tileSize, size_t threads)
+{
+    PointTable table;
+    PointViewPtr view = makeCloud(table, 100);
+
+    BufferReader reader;
+    reader.addView(view);
+
+    opts.add("last", false);
+    opts.add("tile_size", tileSize);
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.setThreads(threads);
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    PointViewPtr out = *viewSet.begin();
+    EXPECT_EQ(out->size(), view->size());
+
+    // The filter may reorder points, so sort the classes by position.
+    std::vector<uint8_t> c(out->size());
+    for (PointId i = 0; i < out->size(); ++i)
+    {
+        size_t x = (size_t)(out->getFieldAs<double>(Dimension::Id::X, i) * 2);
+        size_t y = (size_t)(out->getFieldAs<double>(Dimension::Id::Y, i) * 2);
+        c[x * 200 + y] =
+            out->getFieldAs<uint8_t>(Dimension::Id::Classification, i);
+    }
+    return c;
+}
+
+} // unnamed namespace
+
+// Check that classifying in tiles with a buffer that covers the reach of
+// the classifier gives the same result as a single raster, regardless of
+// the number of threads.
+TEST(GroundTilesTest, tiled)
+{
+    std::atomic<int> tiles(0);
+
+    PointTable t1;
+    PointViewPtr v1 = makeCloud(t1, 60);
+    classifyTiles(v1, 1.0, 0, 2, 1, lowestClassifier(2, tiles));
+    std::vector<uint8_t> untiled = classes(v1);
+    EXPECT_EQ(tiles, 0);
+    EXPECT_NE(std::count(untiled.begin(), untiled.end(), 2), 0);
+    EXPECT_NE(std::count(untiled.begin(), untiled.end(), 1), 0);
+
+    for (size_t threads : { 1, 4 })
+    {
+        tiles = 0;
+        PointTable t2;
+        PointViewPtr v2 = makeCloud(t2, 60);
+        classifyTiles(v2, 1.0, 16, 2, threads, lowestClassifier(2, tiles));
+        EXPECT_EQ(tiles, 16);
+        EXPECT_EQ(classes(v2), untiled);
+    }
+}
+
+// Check tiles without points of their own, with and without a buffer.
+TEST(GroundTilesTest, emptyTile)
+{
+    std::atomic<int> tiles(0);
+    BOX2D hole(19.9, 19.9, 39.9, 39.9);
+
+    PointTable t1;
+    PointViewPtr v1 = makeCloud(t1, 60, hole);
+    classifyTiles(v1, 1.0, 0, 1, 1, lowestClassifier(1, tiles));
+    std::vector<uint8_t> untiled1 = classes(v1);
+
+    // The tile in the hole is only classified for its buffer.
+    PointTable t2;
+    PointViewPtr v2 = makeCloud(t2, 60, hole);
+    classifyTiles(v2, 1.0, 20, 1, 4, lowestClassifier(1, tiles));
+    EXPECT_EQ(tiles, 9);
+    EXPECT_EQ(classes(v2), untiled1);
+
+    PointTable t3;
+    PointViewPtr v3 = makeCloud(t3, 60, hole);
+    classifyTiles(v3, 1.0, 0, 0, 1, lowestClassifier(0, tiles));
+    std::vector<uint8_t> untiled0 = classes(v3);
+
+    // Without a buffer the tile in the hole has no points and is skipped.
+    tiles = 0;
+    PointTable t4;
+    PointViewPtr v4 = makeCloud(t4, 60, hole);
+    classifyTiles(v4, 1.0, 20, 0, 4, lowestClassifier(0, tiles));
+    EXPECT_EQ(tiles, 8);
+    EXPECT_EQ(classes(v4), untiled0);
+}
+
+// SMRF fills voids in a fixed order when tiling, so tiled results match
+// a single tile covering all points.  Ties between neighbors of a void are
+// resolved differently without tiling, which changes a few points.
+TEST(GroundTilesTest, smrf)
+{
+    Options opts;
+    opts.add("window", 6.0);
+
+    SMRFilter f1;
+    std::vector<uint8_t> untiled = runFilter(f1, opts, 0, 1);
+    EXPECT_NE(std::count(untiled.begin(), untiled.end(), 2), 0);
+    EXPECT_NE(std::count(untiled.begin(), untiled.end(), 1), 0);
+
+    SMRFilter f2;
+    std::vector<uint8_t> single = runFilter(f2, opts, 1000, 1);
+    size_t diffs = 0;
+    for (size_t i = 0; i < single.size(); ++i)
+        if (single[i] != untiled[i])
+            diffs++;
+    EXPECT_LT(diffs, single.size() / 1000);
+
+    SMRFilter f3;
+    EXPECT_EQ(runFilter(f3, opts, 30, 1), single);
+    SMRFilter f4;
+    EXPECT_EQ(runFilter(f4, opts, 30, 4), single);
+}
+
+TEST(GroundTilesTest, pmf)
+{
+    Options opts;
+    opts.add("max_window_size", 9.0);
+
+    PMFFilter f1;
+    std::vector<uint8_t> untiled = runFilter(f1, opts, 0, 1);
+    EXPECT_NE(std::count(untiled.begin(), untiled.end(), 2), 0);
+    EXPECT_NE(std::count(untiled.begin(), untiled.end(), 1), 0);
+
+    PMFFilter f2;
+    EXPECT_EQ(runFilter(f2, opts, 30, 1), untiled);
+    PMFFilter f3;
+    EXPECT_EQ(runFilter(f3, opts, 30, 4), untiled);
+}
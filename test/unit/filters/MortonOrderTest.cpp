@@ -34,6 +34,10 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
 #include <io/BufferReader.hpp>
 #include <filters/MortonOrderFilter.hpp>
 
@@ -113,3 +117,163 @@ TEST(MortonOrderTest, test_code)
     EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::X, 5), 3);
     EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::Y, 5), 2);
 }
+
+namespace
+{
+
+PointViewPtr order(PointTableRef table, PointViewPtr view,
+    const Options& opts)
+{
+    BufferReader r;
+    r.addView(view);
+
+    MortonOrderFilter filter;
+    filter.setInput(r);
+    filter.setOptions(opts);
+
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(MortonOrderTest, morton)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    PointViewPtr view(new PointView(table));
+    PointId n = 0;
+    for (int x = 1; x >= 0; x--)
+        for (int y = 1; y >= 0; y--)
+            for (int z = 1; z >= 0; z--)
+            {
+                view->setField(Dimension::Id::X, n, x);
+                view->setField(Dimension::Id::Y, n, y);
+                view->setField(Dimension::Id::Z, n, z);
+                n++;
+            }
+
+    // In 2D, points in the same XY cell keep their order.
+    Options o;
+    PointViewPtr outView = order(table, view, o);
+    int expected2d[][3] = { {0, 0, 1}, {0, 0, 0}, {0, 1, 1}, {0, 1, 0},
+        {1, 0, 1}, {1, 0, 0}, {1, 1, 1}, {1, 1, 0} };
+    for (PointId i = 0; i < outView->size(); ++i)
+    {
+        EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::X, i),
+            expected2d[i][0]);
+        EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::Y, i),
+            expected2d[i][1]);
+        EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::Z, i),
+            expected2d[i][2]);
+    }
+
+    // In 3D, the corners of a cube are ordered X, then Y, then Z.
+    o.add("use_z", true);
+    outView = order(table, view, o);
+    for (PointId i = 0; i < outView->size(); ++i)
+    {
+        EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::X, i), (i >> 2) & 1);
+        EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::Y, i), (i >> 1) & 1);
+        EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::Z, i), i & 1);
+    }
+}
+
+TEST(MortonOrderTest, hilbert)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    // A Hilbert curve steps between neighboring cells of a grid.
+    for (bool useZ : { false, true })
+    {
+        PointViewPtr view(new PointView(table));
+        PointId n = 0;
+        for (int x = 0; x < 8; x++)
+            for (int y = 0; y < 8; y++)
+                for (int z = 0; z < (useZ ? 8 : 1); z++)
+                {
+                    view->setField(Dimension::Id::X, n, x);
+                    view->setField(Dimension::Id::Y, n, y);
+                    view->setField(Dimension::Id::Z, n, z);
+                    n++;
+                }
+
+        Options o;
+        o.add("curve", "hilbert");
+        o.add("use_z", useZ);
+        PointViewPtr outView = order(table, view, o);
+        EXPECT_EQ(outView->size(), n);
+        for (PointId i = 1; i < outView->size(); ++i)
+        {
+            int dist = 0;
+            for (auto dim : { Dimension::Id::X, Dimension::Id::Y,
+                    Dimension::Id::Z })
+                dist += std::abs(outView->getFieldAs<int>(dim, i) -
+                    outView->getFieldAs<int>(dim, i - 1));
+            EXPECT_EQ(dist, 1);
+        }
+    }
+
+    Options o;
+    o.add("curve", "peano");
+    MortonOrderFilter filter;
+    filter.setOptions(o);
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
+
+TEST(MortonOrderTest, nan)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+
+    // Points with NaN coordinates are kept and ordered as if at the
+    // minimum of the bounds.
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double xs[] = { 1, nan, 0, nan, 1, 0 };
+    const double ys[] = { 1, 1, 0, nan, 0, 1 };
+    for (bool reverse : { false, true })
+        for (std::string curve : { "morton", "hilbert" })
+        {
+            PointViewPtr view(new PointView(table));
+            for (PointId i = 0; i < 6; ++i)
+            {
+                view->setField(Dimension::Id::X, i, xs[i]);
+                view->setField(Dimension::Id::Y, i, ys[i]);
+            }
+
+            Options o;
+            o.add("curve", curve);
+            o.add("reverse", reverse);
+            PointViewPtr outView = order(table, view, o);
+            ASSERT_EQ(outView->size(), 6u);
+            int nans = 0;
+            for (PointId i = 0; i < outView->size(); ++i)
+                if (std::isnan(outView->getFieldAs<double>(Dimension::Id::X,
+                        i)))
+                    nans++;
+            EXPECT_EQ(nans, 2);
+        }
+
+    // The point with NaN coordinates has the same code as the point at the
+    // minimum of the bounds and stays after it.
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 6; ++i)
+    {
+        view->setField(Dimension::Id::X, i, xs[i]);
+        view->setField(Dimension::Id::Y, i, ys[i]);
+    }
+    Options o;
+    PointViewPtr outView = order(table, view, o);
+    EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::X, 0), 0);
+    EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::Y, 0), 0);
+    EXPECT_TRUE(std::isnan(outView->getFieldAs<double>(Dimension::Id::X, 1)));
+    EXPECT_TRUE(std::isnan(outView->getFieldAs<double>(Dimension::Id::Y, 1)));
+}
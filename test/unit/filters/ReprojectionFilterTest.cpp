@@ -34,8 +34,11 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/KDIndex.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PointView.hpp>
+#include <io/BufferReader.hpp>
+#include <io/FauxReader.hpp>
 #include <io/LasReader.hpp>
 #include <filters/ReprojectionFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
@@ -142,3 +145,98 @@ TEST(ReprojectionFilterTest, stream_test_1)
     stream.execute(table);
 }
 
+
+// Check that transforming on multiple threads gives the same result as a
+// single thread.
+TEST(ReprojectionFilterTest, threads)
+{
+    auto run = [](size_t threads)
+    {
+        Options ro;
+        ro.add("mode", "ramp");
+        ro.add("count", 20000);
+        ro.add("bounds", BOX3D(500000, 4500000, 0, 510000, 4510000, 100));
+
+        FauxReader reader;
+        reader.setOptions(ro);
+
+        Options fo;
+        fo.add("in_srs", "EPSG:26915");
+        fo.add("out_srs", "EPSG:4326");
+        fo.add("threads", threads);
+
+        ReprojectionFilter filter;
+        filter.setOptions(fo);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        PointViewPtr view = *viewSet.begin();
+        EXPECT_EQ(view->size(), 20000u);
+
+        std::vector<double> coords;
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            coords.push_back(view->getFieldAs<double>(Dimension::Id::X, i));
+            coords.push_back(view->getFieldAs<double>(Dimension::Id::Y, i));
+            coords.push_back(view->getFieldAs<double>(Dimension::Id::Z, i));
+        }
+        return coords;
+    };
+
+    std::vector<double> serial = run(1);
+    std::vector<double> parallel = run(4);
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i)
+        EXPECT_DOUBLE_EQ(serial[i], parallel[i]);
+    EXPECT_NEAR(serial[0], -93.0, 1.0);
+}
+
+
+// Check that reprojecting on several threads discards neighbors cached
+// with the view before the points moved.
+TEST(ReprojectionFilterTest, threadsNeighbors)
+{
+    Options ro;
+    ro.add("mode", "random");
+    ro.add("count", 5000);
+    ro.add("bounds", BOX3D(500000, 4500000, 0, 510000, 4510000, 100));
+
+    FauxReader reader;
+    reader.setOptions(ro);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+    view->knnTable(8);
+
+    BufferReader buf;
+    buf.addView(view);
+
+    Options fo;
+    fo.add("in_srs", "EPSG:26915");
+    fo.add("out_srs", "EPSG:4326");
+    fo.add("threads", 4);
+
+    ReprojectionFilter filter;
+    filter.setOptions(fo);
+    filter.setInput(buf);
+    filter.prepare(table);
+    viewSet = filter.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    view = *viewSet.begin();
+    EXPECT_EQ(view->size(), 5000u);
+
+    // Neighbors of the moved points must match those of a fresh view.
+    PointViewPtr fresh = view->makeNew();
+    for (PointId i = 0; i < view->size(); ++i)
+        fresh->appendPoint(*view, i);
+    NeighborTablePtr moved = view->knnTable(8);
+    NeighborTablePtr expected = fresh->knnTable(8);
+    ASSERT_EQ(moved->size(), expected->size());
+    for (PointId i = 0; i < moved->size(); ++i)
+        EXPECT_EQ(moved->neighbors(i), expected->neighbors(i));
+}
@@ -100,9 +100,18 @@ TEST(SortFilterTest, simple)
 TEST(SortFilterTest, testUnknownOptions)
 {
     EXPECT_THROW( doSort(1, "not a dimension"), std::exception );
+    EXPECT_THROW( doSort(1, ""), std::exception );
     EXPECT_THROW( doSort(1, "X", "not an order"), std::exception );
 }
 
+TEST(SortFilterTest, noDimension)
+{
+    SortFilter filter;
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
+
 TEST(SortFilterTest, pipelineJSON)
 {
     PipelineManager mgr;
@@ -169,3 +178,87 @@ TEST(SortFilterTest, issue1121_simpleSortOrderDesc)
     }
 }
 
+
+namespace
+{
+
+PointViewPtr sortKeys(PointTableRef table, PointViewPtr input,
+    const Options& opts)
+{
+    SortFilter filter;
+    filter.setOptions(opts);
+
+    PointViewPtr view = input->makeNew();
+    for (PointId i = 0; i < input->size(); ++i)
+        view->appendPoint(*input, i);
+
+    filter.prepare(table);
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view.get());
+    FilterWrapper::done(filter, table);
+    return view;
+}
+
+} // unnamed namespace
+
+TEST(SortFilterTest, multipleDimensions)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Classification);
+    table.layout()->registerDim(Id::PointSourceId);
+    PointViewPtr input(new PointView(table));
+
+    // PointSourceId records the original position of each point so that
+    // stability can be checked.
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> classDist(0, 5);
+    std::uniform_int_distribution<int> xDist(-50, 50);
+    const point_count_t count = 50000;
+    for (PointId i = 0; i < count; ++i)
+    {
+        input->setField(Id::X, i, xDist(generator) / 4.0);
+        input->setField(Id::Classification, i, classDist(generator));
+        input->setField(Id::PointSourceId, i, i);
+    }
+
+    for (std::string order : { "ASC", "DESC" })
+    {
+        Options opts;
+        opts.add("dimension", "Classification,X");
+        opts.add("order", order);
+        PointViewPtr view = sortKeys(table, input, opts);
+
+        EXPECT_EQ(count, view->size());
+        for (PointId i = 1; i < view->size(); ++i)
+        {
+            int c1 = view->getFieldAs<int>(Id::Classification, i - 1);
+            int c2 = view->getFieldAs<int>(Id::Classification, i);
+            double x1 = view->getFieldAs<double>(Id::X, i - 1);
+            double x2 = view->getFieldAs<double>(Id::X, i);
+            int p1 = view->getFieldAs<int>(Id::PointSourceId, i - 1);
+            int p2 = view->getFieldAs<int>(Id::PointSourceId, i);
+            if (order == "DESC")
+            {
+                std::swap(c1, c2);
+                std::swap(x1, x2);
+            }
+            ASSERT_LE(c1, c2);
+            if (c1 == c2)
+            {
+                ASSERT_LE(x1, x2);
+                if (x1 == x2)
+                    ASSERT_LT(p1, p2);
+            }
+        }
+
+        // Sorting with several threads gives the same order.
+        opts.add("threads", 4);
+        PointViewPtr threaded = sortKeys(table, input, opts);
+        for (PointId i = 0; i < view->size(); ++i)
+            ASSERT_EQ(view->getFieldAs<int>(Id::PointSourceId, i),
+                threaded->getFieldAs<int>(Id::PointSourceId, i));
+    }
+}
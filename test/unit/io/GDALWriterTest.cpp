@@ -546,3 +546,140 @@ TEST(GDALWriterTest, btint)
         EXPECT_NEAR(arr[i], data[i], .001);
 }
 
+
+TEST(GDALWriterTest, tiles)
+{
+    std::string outfile = Support::temppath("tmp.tif");
+
+    Options wo;
+    wo.add("gdaldriver", "GTiff");
+    wo.add("output_type", "min");
+    wo.add("resolution", 1);
+    wo.add("radius", .7071);
+    wo.add("filename", outfile);
+    wo.add("window_size", 2);
+    wo.add("tile_size", 2);
+    wo.add("threads", 3);
+
+    const std::string output =
+        "5.000     5.457     7.000     8.000     8.900 "
+        "4.000     4.848     6.000     7.000     8.000 "
+        "3.000     4.000     5.000     5.400     6.400 "
+        "2.000     3.000     4.000     4.400     5.400 "
+        "1.000     2.000     3.000     4.000     5.000 ";
+
+    runGdalWriter(wo, outfile, output);
+
+    Options wo2;
+    wo2.add("gdaldriver", "GTiff");
+    wo2.add("output_type", "min");
+    wo2.add("resolution", 1);
+    wo2.add("radius", .7071);
+    wo2.add("filename", outfile);
+    wo2.add("tile_size", 3);
+    wo2.add("threads", 2);
+
+    const std::string output2 =
+        "-9999.000 -9999.00 -9999.00 -9999.00 -9999.00 -9999.00    -1.00"
+        "-9999.000 -9999.00 -9999.00 -9999.00 -9999.00 -9999.00 -9999.00 "
+        "-9999.000 -9999.00     5.00 -9999.00     7.00     8.00     8.90 "
+        "-9999.000 -9999.00     4.00 -9999.00     6.00     7.00     8.00 "
+        "-9999.000 -9999.00     3.00     4.00     5.00     5.40     6.40 "
+        "-9999.000 -9999.00     2.00     3.00     4.00     4.40     5.40 "
+        "-9999.000 -9999.00     1.00     2.00     3.00     4.00     5.00 "
+        "   -1.000    -1.00 -9999.00 -9999.00 -9999.00 -9999.00 -9999.00 "
+        "   -1.000    -1.00 -9999.00 -9999.00 -9999.00 -9999.00 -9999.00";
+
+    runGdalWriter2(wo2, outfile, output2, false);
+}
+
+// Check that a grid that spills tiles to disk and processes them on
+// multiple threads matches one held in a single tile.
+TEST(GDALWriterTest, gridSpill)
+{
+    const size_t width = 40;
+    const size_t height = 30;
+
+    GDALGrid ref(width, height, 1, 2.5, ~0, 3);
+    GDALGrid tiled(width, height, 1, 2.5, ~0, 3, 4, 3,
+        4 * 4 * sizeof(double) * 7 * 3);
+
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        double x = (i * 7919 % 4000) / 100.0;
+        double y = (i * 104729 % 3000) / 100.0;
+        double z = (i * 31 % 97) / 3.0;
+        // Leave a hole so that the window fill has something to do.
+        if (x > 10 && x < 20 && y > 10 && y < 15)
+            continue;
+        ref.addPoint(x, y, z);
+        tiled.addPoint(x, y, z);
+    }
+    ref.finalize();
+    tiled.finalize();
+    EXPECT_GT(tiled.spilledTiles(), 0u);
+
+    for (const std::string name :
+        { "min", "max", "mean", "idw", "count", "stdev" })
+    {
+        GDALGrid::CellIterator ri = ref.cells(name);
+        GDALGrid::CellIterator ti = tiled.cells(name);
+        for (size_t i = 0; i < width * height; ++i, ++ri, ++ti)
+        {
+            if (std::isnan(*ri))
+                EXPECT_TRUE(std::isnan(*ti));
+            else
+                EXPECT_DOUBLE_EQ(*ri, *ti);
+        }
+    }
+}
+
+// Check that points whose cell is past the edge of the grid, and that are
+// too far from any cell of the grid, don't change it.
+TEST(GDALWriterTest, gridEdges)
+{
+    const size_t width = 10;
+    const size_t height = 8;
+
+    for (size_t tileSize : { 256, 3 })
+    {
+        GDALGrid ref(width, height, 1, 1, ~0, 0, tileSize);
+        GDALGrid grid(width, height, 1, 1, ~0, 0, tileSize);
+
+        for (size_t i = 0; i < width; ++i)
+            for (size_t j = 0; j < height; ++j)
+            {
+                double x = i + 0.25;
+                double y = j + 0.75;
+                double z = (double)(i * height + j);
+                ref.addPoint(x, y, z);
+                grid.addPoint(x, y, z);
+            }
+
+        // Points a row or column past each edge.
+        for (size_t i = 0; i < width; ++i)
+        {
+            grid.addPoint(i + 0.5, -1.5, 1000);
+            grid.addPoint(i + 0.5, height + 1.5, 1000);
+        }
+        for (size_t j = 0; j < height; ++j)
+            grid.addPoint(width + 1.5, j + 0.5, 1000);
+
+        ref.finalize();
+        grid.finalize();
+
+        for (const std::string name :
+            { "min", "max", "mean", "idw", "count", "stdev" })
+        {
+            GDALGrid::CellIterator ri = ref.cells(name);
+            GDALGrid::CellIterator gi = grid.cells(name);
+            for (size_t i = 0; i < width * height; ++i, ++ri, ++gi)
+            {
+                if (std::isnan(*ri))
+                    EXPECT_TRUE(std::isnan(*gi));
+                else
+                    EXPECT_DOUBLE_EQ(*ri, *gi);
+            }
+        }
+    }
+}
@@ -34,11 +34,14 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <fstream>
+
 #include <pdal/pdal_features.hpp>
 #include <pdal/Filter.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <io/LasReader.hpp>
 #include "Support.hpp"
 
@@ -471,6 +474,285 @@ TEST(LasReaderTest, stream)
 }
 
 
+namespace
+{
+
+// Read points starting at 'start' and check them against the same points
+// of a full read of the uncompressed file.
+void startTest(const std::string& filename, const std::string& compression,
+    PointId start)
+{
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader reader1;
+    reader1.setOptions(ops1);
+
+    PointTable t1;
+    reader1.prepare(t1);
+    PointViewSet s1 = reader1.execute(t1);
+    PointViewPtr v1 = *s1.begin();
+
+    Options ops2;
+    ops2.add("filename", filename);
+    ops2.add("compression", compression);
+    ops2.add("start", start);
+    ops2.add("count", 1000);
+
+    LasReader reader2;
+    reader2.setOptions(ops2);
+
+    PointTable t2;
+    reader2.prepare(t2);
+    PointViewSet s2 = reader2.execute(t2);
+    PointViewPtr v2 = *s2.begin();
+
+    EXPECT_EQ(v2->size(), 1000u);
+
+    DimTypeList dims = v1->dimTypes();
+    std::vector<char> buf1(v1->pointSize());
+    std::vector<char> buf2(v1->pointSize());
+    for (PointId i = 0; i < v2->size(); ++i)
+    {
+        v1->getPackedPoint(dims, start + i, buf1.data());
+        v2->getPackedPoint(dims, i, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), v1->pointSize()), 0);
+    }
+}
+
+} // unnamed namespace
+
+TEST(LasReaderTest, start)
+{
+    // Compression option is ignored for non-compressed file.
+    startTest(Support::datapath("las/autzen_trim.las"), "laszip", 75000);
+#ifdef PDAL_HAVE_LASZIP
+    startTest(Support::datapath("laz/autzen_trim.laz"), "laszip", 75000);
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+    startTest(Support::datapath("laz/autzen_trim.laz"), "lazperf", 75000);
+#endif
+}
+
+// A file that holds fewer points than its header claims is read up to its
+// last complete point.
+TEST(LasReaderTest, truncated)
+{
+    std::string infile(Support::datapath("las/autzen_trim.las"));
+    std::string outfile(Support::temppath("truncated.las"));
+
+    Options ops1;
+    ops1.add("filename", infile);
+
+    LasReader reader1;
+    reader1.setOptions(ops1);
+
+    PointTable t1;
+    reader1.prepare(t1);
+    PointViewSet s1 = reader1.execute(t1);
+    PointViewPtr v1 = *s1.begin();
+
+    const LasHeader& h = reader1.header();
+    const point_count_t numPoints = 1000;
+    {
+        std::vector<char> buf(h.pointOffset() + numPoints * h.pointLen() +
+            h.pointLen() / 2);
+        std::ifstream in(infile, std::ios::binary);
+        in.read(buf.data(), buf.size());
+        std::ofstream out(outfile, std::ios::binary);
+        out.write(buf.data(), buf.size());
+    }
+
+    Options ops2;
+    ops2.add("filename", outfile);
+
+    LasReader reader2;
+    reader2.setOptions(ops2);
+
+    PointTable t2;
+    reader2.prepare(t2);
+    PointViewSet s2 = reader2.execute(t2);
+    PointViewPtr v2 = *s2.begin();
+
+    EXPECT_EQ(reader2.header().pointCount(), h.pointCount());
+    EXPECT_EQ(reader2.getNumPoints(), numPoints);
+    ASSERT_EQ(v2->size(), numPoints);
+
+    DimTypeList dims = v1->dimTypes();
+    std::vector<char> buf1(v1->pointSize());
+    std::vector<char> buf2(v1->pointSize());
+    for (PointId i = 0; i < v2->size(); ++i)
+    {
+        v1->getPackedPoint(dims, i, buf1.data());
+        v2->getPackedPoint(dims, i, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), v1->pointSize()), 0);
+    }
+
+    class Counter : public Filter, public Streamable
+    {
+    public:
+        Counter() : m_cnt(0)
+            {}
+        std::string getName() const
+            { return "counter"; }
+
+        point_count_t m_cnt;
+
+    private:
+        bool processOne(PointRef&)
+        {
+            m_cnt++;
+            return true;
+        }
+    };
+
+    LasReader reader3;
+    reader3.setOptions(ops2);
+
+    Counter c;
+    c.setInput(reader3);
+
+    FixedPointTable fixed(100);
+    c.prepare(fixed);
+    c.execute(fixed);
+    EXPECT_EQ(c.m_cnt, numPoints);
+
+    FileUtils::deleteFile(outfile);
+}
+
+// Points decoded from a column table go through the generic path.
+TEST(LasReaderTest, columnTable)
+{
+    Options ops;
+    ops.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader reader1;
+    reader1.setOptions(ops);
+
+    PointTable t1;
+    reader1.prepare(t1);
+    PointViewSet s1 = reader1.execute(t1);
+    PointViewPtr v1 = *s1.begin();
+
+    LasReader reader2;
+    reader2.setOptions(ops);
+
+    ColumnPointTable t2;
+    reader2.prepare(t2);
+    PointViewSet s2 = reader2.execute(t2);
+    PointViewPtr v2 = *s2.begin();
+
+    ASSERT_EQ(v1->size(), v2->size());
+    for (PointId i = 0; i < v1->size(); i += 100)
+        for (Dimension::Id dim : v1->dims())
+            EXPECT_EQ(v1->getFieldAs<double>(dim, i),
+                v2->getFieldAs<double>(dim, i));
+}
+
+#if defined(PDAL_HAVE_LASZIP) || defined(PDAL_HAVE_LAZPERF)
+namespace
+{
+
+void threadedTest(const std::string& compression,
+    const std::string& filename = Support::datapath("laz/autzen_trim.laz"))
+{
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader lasReader;
+    lasReader.setOptions(ops1);
+
+    PointTable t1;
+    lasReader.prepare(t1);
+    PointViewSet s1 = lasReader.execute(t1);
+    PointViewPtr v1 = *s1.begin();
+
+    Options ops2;
+    ops2.add("filename", filename);
+    ops2.add("compression", compression);
+    ops2.add("threads", 4);
+
+    // The callback must see each point, in order, once it's decoded.
+    DimTypeList dims = v1->dimTypes();
+    std::vector<char> buf1(v1->pointSize());
+    std::vector<char> buf2(v1->pointSize());
+    PointId cbCount = 0;
+    LasReader lazReader;
+    lazReader.setOptions(ops2);
+    lazReader.setReadCb([&](PointView& v, PointId id)
+    {
+        EXPECT_EQ(id, cbCount++);
+        v1->getPackedPoint(dims, id, buf1.data());
+        v.getPackedPoint(dims, id, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), v1->pointSize()), 0);
+    });
+
+    PointTable t2;
+    lazReader.prepare(t2);
+    PointViewSet s2 = lazReader.execute(t2);
+    PointViewPtr v2 = *s2.begin();
+
+    EXPECT_EQ(v1->size(), v2->size());
+    EXPECT_EQ(cbCount, v2->size());
+
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        v1->getPackedPoint(dims, i, buf1.data());
+        v2->getPackedPoint(dims, i, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), v1->pointSize()), 0);
+    }
+}
+
+} // unnamed namespace
+
+// The compressed file has three chunks, which are decompressed in parallel.
+TEST(LasReaderTest, threaded)
+{
+#ifdef PDAL_HAVE_LASZIP
+    threadedTest("laszip");
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+    threadedTest("lazperf");
+#endif
+}
+
+#ifdef PDAL_HAVE_LAZPERF
+// When the position of the chunk table shows that the writer didn't
+// finish it, points are decompressed serially and can still be read from
+// any starting point.
+TEST(LasReaderTest, unfinishedChunkTable)
+{
+    std::string infile(Support::datapath("laz/autzen_trim.laz"));
+    std::string outfile(Support::temppath("unfinished.laz"));
+
+    Options ops;
+    ops.add("filename", infile);
+    LasReader reader;
+    reader.setOptions(ops);
+    PointTable t;
+    reader.prepare(t);
+    const uint32_t pointOffset = reader.header().pointOffset();
+
+    for (int64_t pos : { (int64_t)-1, (int64_t)0 })
+    {
+        FileUtils::deleteFile(outfile);
+        {
+            std::ifstream in(infile, std::ios::binary);
+            std::ofstream out(outfile, std::ios::binary);
+            out << in.rdbuf();
+            out.seekp(pointOffset);
+            out.write((const char *)&pos, sizeof(pos));
+        }
+
+        threadedTest("lazperf", outfile);
+        startTest(outfile, "lazperf", 75000);
+    }
+    FileUtils::deleteFile(outfile);
+}
+#endif
+#endif
+
+
 // The header of 1.2-with-color-clipped says that it has 1065 points,
 // but it really only has 1064.
 TEST(LasReaderTest, LasHeaderIncorrentPointcount)
@@ -0,0 +1,168 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+
+#include "Support.hpp"
+
+#include <io/TIndexReader.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Build a tile index of the three overlapping text files in tindex/.
+std::string makeIndex()
+{
+    std::string inSpec(Support::datapath("tindex/*.txt"));
+    std::string outSpec(Support::temppath("tindexreader.out"));
+
+    FileUtils::deleteDirectory(outSpec);
+    std::string cmd = Support::binpath("pdal") + " tindex --lyr_name=pdal " +
+        outSpec + " \"" + inSpec + "\"";
+    std::string output;
+    Utils::run_shell_command(cmd, output);
+    return outSpec;
+}
+
+// Read the index and return the positions of the points of each view.
+std::vector<std::vector<double>> readIndex(const std::string& filename,
+    Options opts)
+{
+    opts.add("filename", filename);
+    TIndexReader reader;
+    reader.setOptions(opts);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet views = reader.execute(table);
+
+    std::vector<std::vector<double>> points;
+    for (PointViewPtr v : views)
+    {
+        std::vector<double> pos;
+        for (PointId i = 0; i < v->size(); ++i)
+        {
+            pos.push_back(v->getFieldAs<double>(Dimension::Id::X, i));
+            pos.push_back(v->getFieldAs<double>(Dimension::Id::Y, i));
+            pos.push_back(v->getFieldAs<double>(Dimension::Id::Z, i));
+        }
+        points.push_back(pos);
+    }
+    return points;
+}
+
+// Read the index on one thread and on several, with the given options,
+// and make sure that the results match.
+std::vector<std::vector<double>> compareThreads(const std::string& filename,
+    const Options& opts)
+{
+    Options serialOpts(opts);
+    serialOpts.add("threads", 1);
+    std::vector<std::vector<double>> serial = readIndex(filename, serialOpts);
+
+    Options threadedOpts(opts);
+    threadedOpts.add("threads", 4);
+    EXPECT_EQ(serial, readIndex(filename, threadedOpts));
+    return serial;
+}
+
+} // unnamed namespace
+
+TEST(TIndexReaderTest, threads)
+{
+    std::string filename = makeIndex();
+
+    Options merged;
+    std::vector<std::vector<double>> points =
+        compareThreads(filename, merged);
+    ASSERT_EQ(points.size(), 1U);
+    EXPECT_EQ(points[0].size(), 12U * 3);
+
+    Options separate;
+    separate.add("merge", false);
+    points = compareThreads(filename, separate);
+    ASSERT_EQ(points.size(), 3U);
+    for (auto& p : points)
+        EXPECT_EQ(p.size(), 4U * 3);
+}
+
+// A budget smaller than any tile still reads every tile, one at a time.
+TEST(TIndexReaderTest, memoryBudget)
+{
+    std::string filename = makeIndex();
+
+    for (bool merge : { true, false })
+    {
+        Options opts;
+        opts.add("merge", merge);
+        std::vector<std::vector<double>> points =
+            compareThreads(filename, opts);
+
+        opts.add("memory_budget", 0);
+        EXPECT_EQ(points, compareThreads(filename, opts));
+    }
+}
+
+// The polygon covers one point of the first and last tiles and all of the
+// middle tile.
+TEST(TIndexReaderTest, partialPolygon)
+{
+    std::string filename = makeIndex();
+
+    for (bool merge : { true, false })
+    {
+        Options opts;
+        opts.add("merge", merge);
+        opts.add("filter_srs", "EPSG:4326");
+        opts.add("wkt", "POLYGON ((1.5 1.5, 1.5 3.5, 3.5 3.5, 3.5 1.5, "
+            "1.5 1.5))");
+        std::vector<std::vector<double>> points =
+            compareThreads(filename, opts);
+
+        std::vector<size_t> counts;
+        for (auto& p : points)
+            counts.push_back(p.size() / 3);
+        std::sort(counts.begin(), counts.end());
+        if (merge)
+            EXPECT_EQ(counts, std::vector<size_t>({ 6 }));
+        else
+            EXPECT_EQ(counts, std::vector<size_t>({ 1, 1, 4 }));
+    }
+}
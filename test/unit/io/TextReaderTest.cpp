@@ -34,6 +34,8 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <fstream>
+
 #include "Support.hpp"
 
 #include <io/LasReader.hpp>
@@ -266,3 +268,147 @@ TEST(TextReaderTest, insertHeader)
     EXPECT_TRUE(layout->findDim("C") != Dimension::Id::Unknown);
     EXPECT_TRUE(layout->findDim("G") != Dimension::Id::Unknown);
 }
+
+TEST(TextReaderTest, numbers)
+{
+    // Values are converted exactly as by a stream, whether or not the
+    // fast conversion handles them.
+    StringList values { "1.5", " -0", "+.5", "1.e5", "289814.15",
+        "4320978.61", "0.30000000000000004", "1e-5", "-2.5E+3",
+        "12345678901234567890", "1.7976931348623157e308", "4.9e-324",
+        "9007199254740993", "0.000000000000000000001", "1.5abc", "0x10" };
+
+    std::string filename(Support::temppath("numbers.txt"));
+    {
+        std::ofstream out(filename);
+        out << "X,Y\n";
+        for (size_t i = 0; i < values.size(); ++i)
+            out << values[i] << "," << values[values.size() - i - 1] <<
+                "\n";
+        out << "\n1,2";
+    }
+
+    for (int threads : { 1, 4 })
+    {
+        TextReader reader;
+        Options options;
+        options.add("filename", filename);
+        options.add("threads", threads);
+        reader.setOptions(options);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        PointViewPtr v = *s.begin();
+
+        ASSERT_EQ(v->size(), values.size() + 1);
+        for (PointId i = 0; i < values.size(); ++i)
+        {
+            double x, y;
+            EXPECT_TRUE(Utils::fromString(values[i], x));
+            EXPECT_TRUE(Utils::fromString(values[values.size() - i - 1], y));
+            EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::X, i), x);
+            EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::Y, i), y);
+        }
+        EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::X, values.size()), 1);
+        EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::Y, values.size()), 2);
+    }
+    FileUtils::deleteFile(filename);
+}
+
+// Read a file large enough to be parsed in parallel, with lines that
+// cross the boundary of a read block and a line that's longer than a
+// block, and check that points and messages match a serial read.
+TEST(TextReaderTest, blocks)
+{
+    const size_t numLines = 200000;
+    const size_t longLine = 100000;
+
+    // Lines of three fields are skipped and "bad" is read as zero.
+    std::string filename(Support::temppath("blocks.txt"));
+    std::vector<double> expected;
+    {
+        std::ofstream out(filename);
+        out << "X,Y\n";
+        for (size_t i = 0; i < numLines; ++i)
+        {
+            if (i == longLine)
+            {
+                out << i << ",1." << std::string(1500000, '0') << "\n";
+                expected.push_back(1);
+            }
+            else if (i % 9973 == 0)
+            {
+                out << i << ",bad\n";
+                expected.push_back(0);
+            }
+            else if (i % 7919 == 0)
+            {
+                out << i << "," << i << "," << i << "\n";
+                expected.push_back(-1);
+            }
+            else
+            {
+                out << i << "," << i / 4 << "." << i % 4 * 25 << "\n";
+                expected.push_back(i * .25);
+            }
+        }
+    }
+
+    auto read = [&filename](PointTable& table, int threads,
+        std::string& messages)
+    {
+        std::ostringstream oss;
+        LogPtr log(new Log("readers.text", &oss));
+
+        TextReader reader;
+        Options options;
+        options.add("filename", filename);
+        options.add("threads", threads);
+        reader.setOptions(options);
+        reader.setLog(log);
+
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        messages = oss.str();
+        return *s.begin();
+    };
+
+    PointTable serialTable;
+    std::string serialMessages;
+    PointViewPtr serial = read(serialTable, 1, serialMessages);
+
+    PointId idx = 0;
+    for (size_t i = 0; i < numLines; ++i)
+    {
+        if (expected[i] == -1)
+            continue;
+        ASSERT_LT(idx, serial->size());
+        EXPECT_EQ(serial->getFieldAs<double>(Dimension::Id::X, idx), i);
+        EXPECT_EQ(serial->getFieldAs<double>(Dimension::Id::Y, idx),
+            expected[i]);
+        idx++;
+    }
+    EXPECT_EQ(serial->size(), idx);
+
+    // The header is line 1.
+    EXPECT_NE(serialMessages.find("Line 7921 in"), std::string::npos);
+    EXPECT_NE(serialMessages.find("on line 9975 in"), std::string::npos);
+    EXPECT_LT(serialMessages.find("Line 7921 in"),
+        serialMessages.find("on line 9975 in"));
+
+    PointTable parallelTable;
+    std::string parallelMessages;
+    PointViewPtr parallel = read(parallelTable, 4, parallelMessages);
+
+    ASSERT_EQ(parallel->size(), serial->size());
+    for (PointId idx = 0; idx < serial->size(); ++idx)
+    {
+        EXPECT_EQ(parallel->getFieldAs<double>(Dimension::Id::X, idx),
+            serial->getFieldAs<double>(Dimension::Id::X, idx));
+        EXPECT_EQ(parallel->getFieldAs<double>(Dimension::Id::Y, idx),
+            serial->getFieldAs<double>(Dimension::Id::Y, idx));
+    }
+    EXPECT_EQ(parallelMessages, serialMessages);
+    FileUtils::deleteFile(filename);
+}
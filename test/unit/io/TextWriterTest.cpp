@@ -37,9 +37,13 @@
 #include "Support.hpp"
 
 #include <pdal/util/FileUtils.hpp>
+#include <io/BufferReader.hpp>
 #include <io/TextReader.hpp>
 #include <io/TextWriter.hpp>
 
+#include <fstream>
+#include <limits>
+
 using namespace pdal;
 
 TEST(TextWriterTest, t1)
@@ -104,3 +108,75 @@ TEST(TextWriterTest, t2)
 
     EXPECT_EQ(Support::compare_text_files(infile, outfile), true);
 }
+
+// Check that values are written exactly as printf() would format them
+// with per-dimension precision, with and without threads.
+TEST(TextWriterTest, precision)
+{
+    std::string outfile(Support::temppath("precision.txt"));
+
+    const double values[] = { 2.675, 0.0005, -0.0001, -0.0, 1.5, 2.5,
+        123456.78901, -98765.4321, 1e300, -1e-300, 4503599627370495.5,
+        std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::infinity() };
+    const size_t numValues = sizeof(values) / sizeof(values[0]);
+    const point_count_t count = 40000;
+
+    auto format = [](double d, int precision)
+    {
+        char buf[400];
+        snprintf(buf, sizeof(buf), "%.*f", precision, d);
+        return std::string(buf);
+    };
+
+    for (size_t threads : { 1, 3 })
+    {
+        FileUtils::deleteFile(outfile);
+
+        PointTable table;
+        table.layout()->registerDims({ Dimension::Id::X, Dimension::Id::Y,
+            Dimension::Id::Z });
+        PointViewPtr view(new PointView(table));
+        for (PointId i = 0; i < count; ++i)
+        {
+            view->setField(Dimension::Id::X, i, values[i % numValues]);
+            view->setField(Dimension::Id::Y, i,
+                values[i % numValues] * (i + 1) / 7);
+            view->setField(Dimension::Id::Z, i, values[(i / 3) % numValues]);
+        }
+
+        BufferReader r;
+        r.addView(view);
+
+        TextWriter w;
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("order", "X:2,Y,Z:0");
+        wo.add("precision", 5);
+        wo.add("threads", threads);
+        w.setOptions(wo);
+        w.setInput(r);
+
+        w.prepare(table);
+        w.execute(table);
+
+        std::ifstream in(outfile);
+        std::string line;
+        std::getline(in, line);
+        EXPECT_EQ(line, "\"X\",\"Y\",\"Z\"");
+        for (PointId i = 0; i < count; ++i)
+        {
+            std::getline(in, line);
+            std::string expected =
+                format(view->getFieldAs<double>(Dimension::Id::X, i), 2) +
+                "," +
+                format(view->getFieldAs<double>(Dimension::Id::Y, i), 5) +
+                "," +
+                format(view->getFieldAs<double>(Dimension::Id::Z, i), 0);
+            EXPECT_EQ(line, expected);
+            if (line != expected)
+                break;
+        }
+        EXPECT_FALSE(std::getline(in, line));
+    }
+}